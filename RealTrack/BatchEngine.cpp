@@ -0,0 +1,202 @@
+//--------------------------------------------------
+// Implementation code for the BatchEngine
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "BatchEngine.h"
+using namespace NVL_App;
+
+//--------------------------------------------------
+// Constructor and Terminator
+//--------------------------------------------------
+
+/**
+ * Main Constructor
+ * @param logger The logger that we are using for the system
+ * @param parameters The input parameters
+ * @param configPath The path to the configuration (reloaded for each sequence, so that every engine owns its own copy)
+ */
+BatchEngine::BatchEngine(NVLib::Logger * logger, NVLib::Parameters * parameters, const string& configPath) : _logger(logger), _parameters(parameters), _configPath(configPath), _inFlight(0)
+{
+    _manifestPath = ArgUtils::GetString(parameters, "batch_manifest");
+    _outputFolder = ArgUtils::GetString(parameters, "output_folder");
+    _sourceType = ArgUtils::GetString(parameters, "frame_source");
+    _threadCount = ArgUtils::GetInteger(parameters, "batch_threads");
+    _memoryCap = (size_t)ArgUtils::GetInteger(parameters, "batch_memory_mb") * 1024 * 1024;
+}
+
+/**
+ * Main Terminator 
+ */
+BatchEngine::~BatchEngine() 
+{
+    delete _parameters;
+}
+
+//--------------------------------------------------
+// Execution Entry Point
+//--------------------------------------------------
+
+/**
+ * Entry point function
+ */
+void BatchEngine::Run()
+{
+    _logger->Log(1, "Loading the batch manifest: %s", _manifestPath.c_str());
+    auto sequences = vector<BatchSequence>(); LoadManifest(sequences);
+    _logger->Log(1, "Found %i sequences", (int)sequences.size());
+
+    // Parallelism comes from running sequences side by side, so keep OpenCV from oversubscribing the cores
+    setNumThreads(1);
+
+    auto pool = ThreadPool(_threadCount);
+    _logger->Log(1, "Processing with %i workers", pool.GetThreadCount());
+
+    for (auto& sequence : sequences) 
+    {
+        auto memory = size_t(0);
+        try { memory = EstimateMemory(sequence); }
+        catch (runtime_error& exception) { sequence.GetStatus() = "failed"; sequence.GetMessage() = exception.what(); continue; }
+
+        Reserve(memory);
+        pool.Submit([this, &sequence, memory] { RunSequence(sequence); Release(memory); });
+    }
+
+    pool.Wait();
+
+    _logger->Log(1, "Writing the batch report to disk");
+    SaveReport(sequences);
+}
+
+//--------------------------------------------------
+// Sequence Processing
+//--------------------------------------------------
+
+/**
+ * @brief Process a single sequence, isolating any failure from the rest of the batch
+ * @param sequence The sequence that we are processing
+ */
+void BatchEngine::RunSequence(BatchSequence& sequence)
+{
+    auto start = chrono::steady_clock::now();
+    _logger->Log(1, "Starting sequence: %s", sequence.GetName().c_str());
+
+    try
+    {
+        auto outputFolder = NVLib::FileUtils::PathCombine(_outputFolder, sequence.GetName());
+        filesystem::create_directories(outputFolder);
+
+        auto parameters = NVLib::ParameterLoader::Load(_configPath);
+        Engine(_logger, parameters, sequence.GetInputFolder(), sequence.GetSource(), outputFolder, sequence.GetImageCount(), false).Run();
+        sequence.GetStatus() = "success";
+    }
+    catch (runtime_error& exception) { sequence.GetStatus() = "failed"; sequence.GetMessage() = exception.what(); }
+    catch (string& exception) { sequence.GetStatus() = "failed"; sequence.GetMessage() = exception; }
+    catch (exception& exception) { sequence.GetStatus() = "failed"; sequence.GetMessage() = exception.what(); }
+
+    sequence.GetSeconds() = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    _logger->Log(1, "Finished sequence: %s (%s)", sequence.GetName().c_str(), sequence.GetStatus().c_str());
+}
+
+/**
+ * @brief Estimate the memory a sequence needs from the resolution of its frames (read from the header of a packed 
+ * file, and otherwise from the first color image within the input folder)
+ * @param sequence The sequence that we are estimating
+ * @return size_t The estimate in bytes
+ */
+size_t BatchEngine::EstimateMemory(BatchSequence& sequence)
+{
+    if (_sourceType == "packed")
+    {
+        auto reader = ifstream(sequence.GetSource(), ios::binary); auto header = PackedHeader();
+        if (!reader.is_open()) throw runtime_error("Unable to open file: " + sequence.GetSource());
+        reader.read((char *)&header, sizeof(PackedHeader));
+        if (!reader || !PackedFormat::IsValid(header)) throw runtime_error("The file is not a valid packed sequence: " + sequence.GetSource());
+        return Engine::EstimateMemory(_parameters, Size(header.Width, header.Height), sequence.GetImageCount());
+    }
+
+    auto path = NVLib::FileUtils::PathCombine(sequence.GetInputFolder(), "color_0000.png");
+    Mat image = imread(path); if (image.empty()) throw runtime_error("Unable to open file: " + path);
+    return Engine::EstimateMemory(_parameters, image.size(), sequence.GetImageCount());
+}
+
+//--------------------------------------------------
+// Memory Cap
+//--------------------------------------------------
+
+/**
+ * @brief Block until the memory for a sequence fits under the cap (a sequence is always admitted if nothing else is running)
+ * @param memory The memory that the sequence needs
+ */
+void BatchEngine::Reserve(size_t memory)
+{
+    unique_lock<mutex> lock(_lock);
+    _released.wait(lock, [this, memory] { return _inFlight == 0 || _inFlight + memory <= _memoryCap; });
+    _inFlight += memory;
+}
+
+/**
+ * @brief Hand back the memory of a sequence that has finished
+ * @param memory The memory that the sequence was using
+ */
+void BatchEngine::Release(size_t memory)
+{
+    lock_guard<mutex> guard(_lock);
+    _inFlight -= memory;
+    _released.notify_all();
+}
+
+//--------------------------------------------------
+// Manifest and Report
+//--------------------------------------------------
+
+/**
+ * @brief Load the manifest, where each line is: <input_folder> <image_count> [<output_name>] [<source>]. The source 
+ * is the packed file or shared ring of the sequence, and is required when the frames do not come from the folder
+ * @param sequences The sequences that were loaded
+ */
+void BatchEngine::LoadManifest(vector<BatchSequence>& sequences)
+{
+    auto reader = ifstream(_manifestPath);
+    if (!reader.is_open()) throw runtime_error("Unable to open file: " + _manifestPath);
+
+    auto line = string();
+    while (getline(reader, line)) 
+    {
+        if (line.empty() || line[0] == '#') continue;
+
+        auto parts = stringstream(line); auto folder = string(); auto count = 0; auto name = string(); auto source = string();
+        if (!(parts >> folder >> count)) throw runtime_error("Invalid manifest line: " + line);
+        if (!(parts >> name)) name = filesystem::path(folder).filename().string();
+        if (!(parts >> source)) source = folder;
+        if (_sourceType != "folder" && source == folder) throw runtime_error("The manifest line does not give the " + _sourceType + " source of the sequence: " + line);
+
+        sequences.push_back(BatchSequence(folder, source, name, count));
+    }
+
+    reader.close();
+}
+
+/**
+ * @brief Write a summary of every sequence to the output folder
+ * @param sequences The sequences that were processed
+ */
+void BatchEngine::SaveReport(vector<BatchSequence>& sequences)
+{
+    auto path = NVLib::FileUtils::PathCombine(_outputFolder, "batch_report.txt");
+    auto writer = ofstream(path);
+    if (!writer.is_open()) throw runtime_error("Unable to open file: " + path);
+
+    auto failures = 0;
+    for (auto& sequence : sequences) 
+    {
+        writer << sequence.GetName() << "\t" << sequence.GetStatus() << "\t" << sequence.GetSeconds() << "\t" << sequence.GetMessage() << endl;
+        if (sequence.GetStatus() != "success") failures++;
+    }
+
+    writer.close();
+    _logger->Log(1, "Batch complete: %i of %i sequences failed", failures, (int)sequences.size());
+}
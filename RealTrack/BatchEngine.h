@@ -0,0 +1,82 @@
+//--------------------------------------------------
+// Processes a manifest of sequences concurrently on a shared thread pool
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <mutex>
+#include <fstream>
+#include <filesystem>
+#include <condition_variable>
+#include <iostream>
+using namespace std;
+
+#include <NVLib/Logger.h>
+#include <NVLib/FileUtils.h>
+#include <NVLib/Parameters/ParameterLoader.h>
+
+#include <RealTrackLib/ArgUtils.h>
+#include <RealTrackLib/ThreadPool.h>
+#include <RealTrackLib/PackedFormat.h>
+
+#include "Engine.h"
+
+namespace NVL_App
+{
+	class BatchSequence
+	{
+	private:
+		string _inputFolder;
+		string _source;
+		string _name;
+		int _imageCount;
+		string _status;
+		string _message;
+		double _seconds;
+	public:
+		BatchSequence(const string& inputFolder, const string& source, const string& name, int imageCount) :
+			_inputFolder(inputFolder), _source(source), _name(name), _imageCount(imageCount), _status("pending"), _seconds(0) {}
+
+		inline string& GetInputFolder() { return _inputFolder; }
+		inline string& GetSource() { return _source; }
+		inline string& GetName() { return _name; }
+		inline int& GetImageCount() { return _imageCount; }
+		inline string& GetStatus() { return _status; }
+		inline string& GetMessage() { return _message; }
+		inline double& GetSeconds() { return _seconds; }
+	};
+
+	class BatchEngine
+	{
+	private:
+		NVLib::Logger * _logger;
+		NVLib::Parameters * _parameters;
+		string _configPath;
+
+		string _manifestPath;
+		string _outputFolder;
+		string _sourceType;
+		int _threadCount;
+		size_t _memoryCap;
+
+		mutex _lock;
+		condition_variable _released;
+		size_t _inFlight;
+	public:
+		BatchEngine(NVLib::Logger * logger, NVLib::Parameters * parameters, const string& configPath);
+		~BatchEngine();
+
+		void Run();
+	private:
+		void LoadManifest(vector<BatchSequence>& sequences);
+		size_t EstimateMemory(BatchSequence& sequence);
+		void RunSequence(BatchSequence& sequence);
+		void Reserve(size_t memory);
+		void Release(size_t memory);
+		void SaveReport(vector<BatchSequence>& sequences);
+	};
+}
@@ -9,6 +9,11 @@
 #include "Engine.h"
 using namespace NVL_App;
 
+// The number of features that the memory estimate assumes are tracked in each frame, and the size of the binary 
+// descriptors that place recognition keeps for each keyframe
+#define FEATURE_ESTIMATE 2000
+#define DESCRIPTOR_BYTES 32
+
 //--------------------------------------------------
 // Constructor and Terminator
 //--------------------------------------------------
@@ -24,20 +29,109 @@ Engine::Engine(NVLib::Logger* logger, NVLib::Parameters* parameters) : _logger(l
     _inputFolder = ArgUtils::GetString(parameters, "input_folder");
     _outputFolder = ArgUtils::GetString(parameters, "output_folder");
 
+    // The packed and shared sources name their frames separately from the input folder (which holds the calibration)
+    auto sourceType = ArgUtils::GetString(parameters, "frame_source");
+    if (sourceType == "packed") _sourcePath = ArgUtils::GetString(parameters, "packed_file");
+    else if (sourceType == "shared") _sourcePath = ArgUtils::GetString(parameters, "shared_name");
+    else _sourcePath = _inputFolder;
+
     // Retrieve the image count
     _imageCount = ArgUtils::GetInteger(parameters, "image_count");
+    _showDisplay = ArgUtils::GetBoolean(parameters, "show_display");
+
+    // Setup the remaining details
+    Initialize();
+}
+
+/**
+ * Sequence Constructor (used by batch processing, where the sequence details come from the manifest)
+ * @param logger The logger that we are using for the system
+ * @param parameters The input parameters (shared settings for all sequences)
+ * @param inputFolder The folder that holds the sequence
+ * @param sourcePath The packed file or shared ring that provides the frames (the input folder for folder sources)
+ * @param outputFolder The folder that the results are written to
+ * @param imageCount The number of images within the sequence
+ * @param showDisplay Indicates whether we want to show the depth preview
+ */
+Engine::Engine(NVLib::Logger* logger, NVLib::Parameters* parameters, const string& inputFolder, const string& sourcePath, const string& outputFolder, int imageCount, bool showDisplay) : 
+    _logger(logger), _parameters(parameters), _inputFolder(inputFolder), _sourcePath(sourcePath), _outputFolder(outputFolder), _imageCount(imageCount), _showDisplay(showDisplay)
+{
+    Initialize();
+}
 
+/**
+ * Main Terminator 
+ */
+Engine::~Engine() 
+{
+    delete _source; delete _parameters; delete _calibration;
+}
+
+/**
+ * @brief Load the calibration and setup the frame source
+ */
+void Engine::Initialize() 
+{
     // Load Calibration
     auto calibrationPath = NVLib::FileUtils::PathCombine(_inputFolder, "calibration.xml");
     _calibration = LoadUtils::LoadCalibration(calibrationPath);
+
+    // Setup the frame source
+    _source = CreateSource();
 }
 
 /**
- * Main Terminator 
+ * @brief Create the frame source described by the configuration (wrapped so that the frames are undistorted as they 
+ * are loaded, if the calibration has a distortion model or a separate depth camera)
+ * @return FrameSource * The source that provides the frames
  */
-Engine::~Engine() 
+FrameSource * Engine::CreateSource() 
 {
-    delete _parameters; delete _calibration;
+    FrameSource * source = nullptr;
+
+    auto sourceType = ArgUtils::GetString(_parameters, "frame_source");
+    auto queueSize = ArgUtils::GetInteger(_parameters, "queue_size");
+    auto depthType = LoadUtils::GetDepthType(ArgUtils::GetString(_parameters, "depth_format"));
+    if (sourceType == "folder") source = new FolderSource(_inputFolder, _imageCount, ArgUtils::GetDouble(_parameters, "frame_rate"), queueSize + 2, depthType);
+    else if (sourceType == "packed") source = new PackedSource(_sourcePath, queueSize + 2, depthType);
+    else if (sourceType == "shared") source = new SharedSource(_sourcePath, queueSize + 2, depthType);
+    else throw runtime_error("Unknown frame source: " + sourceType);
+
+    if (FrameRectifier::IsNeeded(_calibration)) source = new RectifiedSource(source, _calibration);
+
+    return source;
+}
+
+/**
+ * @brief Wrap the source if we want to replay at a real-time cadence (the replay starts releasing frames straight
+ * away, so this happens just before the first frame is pulled)
+ * @param source The source that provides the frames
+ * @return FrameSource * The source that the engine will pull frames from
+ */
+FrameSource * Engine::CreateReplay(FrameSource * source) 
+{
+    if (!ArgUtils::GetBoolean(_parameters, "replay")) return source;
+    auto policy = ReplaySource::ParsePolicy(ArgUtils::GetString(_parameters, "drop_policy"));
+    return new ReplaySource(source, ArgUtils::GetDouble(_parameters, "replay_fps"), policy, ArgUtils::GetInteger(_parameters, "queue_size"));
+}
+
+/**
+ * @brief Detect the features of the whole sequence up front if a feature file has been configured. The detection
+ * reads the sequence through a second source, so the source that the engine pulls from is left untouched
+ * @param odometry The session that will use the features
+ */
+void Engine::PrecomputeFeatures(Odometry& odometry) 
+{
+    auto featureFile = ArgUtils::GetString(_parameters, "feature_file");
+    if (featureFile.empty()) return;
+    if (ArgUtils::GetString(_parameters, "frame_source") == "shared") throw runtime_error("Features can only be precomputed for folder or packed sources");
+
+    // Relative paths are kept with the results, so that the sequences of a batch each get their own file
+    if (filesystem::path(featureFile).is_relative()) featureFile = NVLib::FileUtils::PathCombine(_outputFolder, featureFile);
+
+    auto source = CreateSource();
+    odometry.PrecomputeFeatures(source, GetSequence(), featureFile, ArgUtils::GetInteger(_parameters, "feature_threads"));
+    delete source;
 }
 
 //--------------------------------------------------
@@ -49,62 +143,163 @@ Engine::~Engine()
  */
 void Engine::Run()
 {
+    // The counters of this run (and of the threads that it starts) are kept apart from any other engine that is running
+    auto perfScope = PerfSessionScope(&_perf, "main");
+
+    _logger->Log(1, "Setting up the odometry session");
+    auto odometry = Odometry(_logger, _parameters, _calibration, _source->GetSize());
+    odometry.SetRelease([this](NVLib::DepthFrame * frame) { _source->Release(frame); });
+    auto report = RunReport(_source->GetFrameCount());
+
+    auto counters = ArgUtils::GetBoolean(_parameters, "perf_counters");
+    if (counters) 
+    {
+        PerfCounters::Enable();
+        _logger->Log(1, PerfCounters::IsAvailable() ? "Hardware counters enabled" : "Hardware counters are not available on this host");
+    }
+
+    auto cacheFolder = ArgUtils::GetString(_parameters, "stage_cache");
+    if (!cacheFolder.empty()) odometry.EnableCache(cacheFolder, GetSequence());
+
+    PrecomputeFeatures(odometry);
+    _source = CreateReplay(_source);
+
     _logger->Log(1, "Loading the first frame");
-    auto firstFrame = LoadUtils::LoadFrame(_inputFolder, 0);
-    auto tracker = FastTracker(_calibration, firstFrame);
-    Mat camera = _calibration->GetMatrix();
-    Mat counter = Mat_<int>(firstFrame->GetColor().size()); counter.setTo(1);
+    auto current = SourceFrame(); if (!_source->Next(current)) throw runtime_error("The frame source did not provide any frames");
+    odometry.Push(current);
 
     _logger->Log(1, "Saving the first frame details to disk");
     Mat initialPose = Mat_<double>::eye(4,4); SaveUtils::SavePose(_outputFolder, initialPose, 0);
-    SaveUtils::SaveFrame(_outputFolder, firstFrame, 0);
+    SaveUtils::SaveFrame(_outputFolder, odometry.GetFrame(), 0);
 
-    auto index = 1; auto trajectory = Trajectory();
+    auto index = 1;
 
-    for (auto i = 1; i < _imageCount; i++) 
+    while (_source->Next(current)) 
     {
-        _logger->Log(1, "Processing frame: %i", i);
-
-        auto frame = LoadUtils::LoadFrame(_inputFolder, i); auto error = Vec2d();
-        auto keypoints = vector<KeyPoint>(); Mat pose = tracker.GetPose(frame, keypoints, error);
+        auto& result = odometry.Push(current);
+        AddStages(odometry.GetController(), report);
 
-        cout << endl << "----------------- Results: POSE extraction" << endl;
-        cout << pose << endl;
-        cout << "Reprojection Error: " << error[0] << " ± " << error[1] << endl;
-        cout << "----------------- End POSE extraction" << endl << endl;
-
-        if (error[0] > 3) 
+        if (!result.GetTracked()) 
         {
-            _logger->Log(1, "Tracking Failed");
-            delete frame;
+            report.AddFailed(GetLatency(current));
             continue;
         }
-
-        _logger->Log(1, "Creating a pose image");
-        auto poseImage = PoseImage(camera, tracker.GetFrame());
-
-        _logger->Log(1, "Refining pose");
-        auto refiner = PhotoMatcher(&poseImage);
-        pose = refiner.Refine(pose, frame->GetColor());
-        trajectory.AddPose(pose);
-
-        _logger->Log(1, "Setting the new frame");
-        counter = poseImage.WarpCounter(pose, counter);
-        Mat previousDepth = poseImage.GetDepth(pose);
-        frame->GetDepth() = MapMerger::Merge(previousDepth, frame->GetDepth(), counter);
-        tracker.UpdateNextFrame(frame, keypoints, true);
+        if (result.GetRelocalized()) report.AddRelocalized();
+        report.AddTracked(GetLatency(current));
 
         _logger->Log(1, "Save the frame to disk");
-        SaveUtils::SavePose(_outputFolder, pose, index);
-        SaveUtils::SaveFrame(_outputFolder, frame, index);
+        SaveUtils::SavePose(_outputFolder, result.GetPose().ToMat(), index);
+        SaveUtils::SaveFrame(_outputFolder, odometry.GetFrame(), index);
         index++;
 
-        NVLib::DisplayUtils::ShowFloatMap("Depth", frame->GetDepth(), 1000);
+        if (!_showDisplay) continue;
+        Mat displayDepth; odometry.GetFusedDepth().convertTo(displayDepth, CV_32F);
+        NVLib::DisplayUtils::ShowFloatMap("Depth", displayDepth, 1000);
         auto key = waitKey(30);
         if (key == 27) break;
     }
 
+    odometry.Finish();
+
     _logger->Log(1, "Writing the trajectory to disk");
     auto trajectoryPath = NVLib::FileUtils::PathCombine(_outputFolder, "path.ply");
-    trajectory.Save(trajectoryPath);
+    odometry.GetTrajectory().Save(trajectoryPath);
+
+    _logger->Log(1, "Writing the run report to disk");
+    report.SetDropped(_source->GetDropped());
+    if (counters) report.SetCounters(PerfCounters::IsAvailable(), _perf.GetTotals());
+    report.Save(NVLib::FileUtils::PathCombine(_outputFolder, "report.xml"));
+}
+
+//--------------------------------------------------
+// Helpers
+//--------------------------------------------------
+
+/**
+ * @brief Estimate the peak memory that a sequence needs (used to cap how many run at once). Along with the frames, 
+ * this covers the working sets of the optional stages that the configuration turns on: the ICP pyramids, the bundle
+ * adjustment window, the place recognition entries (which grow with the sequence) and the landmark map
+ * @param parameters The configuration that the sequence runs with
+ * @param size The resolution of the sequence
+ * @param imageCount The number of images within the sequence
+ * @return size_t The estimate in bytes
+ */
+size_t Engine::EstimateMemory(NVLib::Parameters * parameters, const Size& size, int imageCount) 
+{
+    auto queueSize = (size_t)ArgUtils::GetInteger(parameters, "queue_size");
+    auto depthBytes = (size_t)CV_ELEM_SIZE(LoadUtils::GetDepthType(ArgUtils::GetString(parameters, "depth_format")));
+    auto scale = (size_t)max(ArgUtils::GetInteger(parameters, "process_scale"), 1);
+
+    auto pixels = (size_t)size.width * size.height; auto workPixels = pixels / (scale * scale);
+    auto frames = (queueSize + 2) * pixels * (3 + depthBytes);
+    auto poseImage = workPixels * (depthBytes + 1);
+    auto fusion = pixels * (2 + 2 * depthBytes);
+    auto total = frames + poseImage + fusion;
+
+    // The reference and current pyramids, each with six float maps per level (the levels add up to a third more)
+    if (ArgUtils::GetString(parameters, "tracker_mode") != "feature") total += workPixels * 2 * 6 * sizeof(float) * 4 / 3;
+
+    auto window = (size_t)max(ArgUtils::GetInteger(parameters, "ba_window"), 0);
+    total += window * FEATURE_ESTIMATE * (sizeof(Observation) + sizeof(Point3d)) + (6 * window) * (6 * window) * sizeof(double);
+
+    if (ArgUtils::GetBoolean(parameters, "loop_closure")) 
+    {
+        auto keyframes = (size_t)(imageCount / max(ArgUtils::GetInteger(parameters, "keyframe_interval"), 1) + 1);
+        auto features = (size_t)ArgUtils::GetInteger(parameters, "place_features");
+        total += keyframes * features * (DESCRIPTOR_BYTES + sizeof(Point3f) + sizeof(Point2f)) + workPixels * 3;
+    }
+
+    if (ArgUtils::GetBoolean(parameters, "landmark_map")) 
+    {
+        auto age = (size_t)ArgUtils::GetInteger(parameters, "landmark_max_age");
+        total += age * FEATURE_ESTIMATE * (sizeof(Landmark) + 2 * sizeof(void *));
+    }
+
+    return total;
+}
+
+/**
+ * @brief Describe the frames that the source provides: where they come from, and a digest of the calibration (since
+ * the frames are corrected with it as they are loaded, see RectifiedSource)
+ * @return string The description of the sequence
+ */
+string Engine::GetSequence() 
+{
+    auto sourceType = ArgUtils::GetString(_parameters, "frame_source");
+
+    auto key = StageCache::Hash(&_calibration->GetFocals(), sizeof(Vec2d));
+    key = StageCache::Hash(&_calibration->GetCenter(), sizeof(Point2d), key);
+    for (auto matrix : { &_calibration->GetDistortion(), &_calibration->GetDepthCamera(), &_calibration->GetDepthDistortion(), &_calibration->GetDepthPose() })
+    {
+        if (!matrix->empty()) key = StageCache::Hash(matrix->data, matrix->total() * matrix->elemSize(), key);
+    }
+
+    auto result = stringstream(); result << sourceType << ":" << _sourcePath << ":" << hex << key;
+    return result.str();
+}
+
+/**
+ * @brief Determine how long (in milliseconds) it has been since the frame arrived
+ * @param frame The frame that we are measuring
+ * @return double The latency in milliseconds
+ */
+double Engine::GetLatency(SourceFrame& frame) 
+{
+    auto elapsed = chrono::steady_clock::now() - frame.GetArrival();
+    return chrono::duration<double, milli>(elapsed).count();
+}
+
+/**
+ * @brief Copy the stage timings of the frame that has just finished into the run report
+ * @param controller The controller that measured the stages
+ * @param report The report that we are adding to
+ */
+void Engine::AddStages(LatencyController& controller, RunReport& report) 
+{
+    for (auto i = 0; i < (int)PipelineStage::COUNT; i++) 
+    {
+        auto stage = (PipelineStage)i;
+        report.AddStage(LatencyController::GetStageName(stage), controller.GetStageTime(stage));
+    }
+    report.AddQuality(controller.GetQuality());
 }
\ No newline at end of file
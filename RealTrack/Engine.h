@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <filesystem>
 #include <iostream>
 using namespace std;
 
@@ -16,12 +17,16 @@ using namespace std;
 
 #include <RealTrackLib/ArgUtils.h>
 #include <RealTrackLib/LoadUtils.h>
-#include <RealTrackLib/FastTracker.h>
-#include <RealTrackLib/PoseImage.h>
-#include <RealTrackLib/PhotoMatcher.h>
-#include <RealTrackLib/MapMerger.h>
 #include <RealTrackLib/SaveUtils.h>
-#include <RealTrackLib/Trajectory.h>
+#include <RealTrackLib/FrameSource.h>
+#include <RealTrackLib/FolderSource.h>
+#include <RealTrackLib/PackedSource.h>
+#include <RealTrackLib/SharedSource.h>
+#include <RealTrackLib/ReplaySource.h>
+#include <RealTrackLib/RectifiedSource.h>
+#include <RealTrackLib/RunReport.h>
+#include <RealTrackLib/LatencyController.h>
+#include <RealTrackLib/Odometry.h>
 
 namespace NVL_App
 {
@@ -32,14 +37,29 @@ namespace NVL_App
 		NVLib::Logger* _logger;
 
 		string _inputFolder;
+		string _sourcePath;
 		string _outputFolder;
 		int _imageCount;
+		bool _showDisplay;
 		Calibration * _calibration;
+		FrameSource * _source;
+		PerfSession _perf;
 
 	public:
 		Engine(NVLib::Logger* logger, NVLib::Parameters * parameters);
+		Engine(NVLib::Logger* logger, NVLib::Parameters * parameters, const string& inputFolder, const string& sourcePath, const string& outputFolder, int imageCount, bool showDisplay);
 		~Engine();
 
 		void Run();
+
+		static size_t EstimateMemory(NVLib::Parameters * parameters, const Size& size, int imageCount);
+	private:
+		void Initialize();
+		FrameSource * CreateSource();
+		FrameSource * CreateReplay(FrameSource * source);
+		void PrecomputeFeatures(Odometry& odometry);
+		string GetSequence();
+		double GetLatency(SourceFrame& frame);
+		void AddStages(LatencyController& controller, RunReport& report);
 	};
 }
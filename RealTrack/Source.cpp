@@ -7,6 +7,7 @@
 //--------------------------------------------------
 
 #include "Engine.h"
+#include "BatchEngine.h"
 
 //--------------------------------------------------
 // Execution entry point
@@ -25,7 +26,10 @@ int main(int argc, char ** argv)
     try
     {
         auto parameters = NVL_App::ArgUtils::Load("RealTrack", argc, argv);
-        NVL_App::Engine(&logger, parameters).Run();
+        auto manifest = NVL_App::ArgUtils::GetString(parameters, "batch_manifest");
+
+        if (manifest.empty()) NVL_App::Engine(&logger, parameters).Run();
+        else NVL_App::BatchEngine(&logger, parameters, NVL_App::ArgUtils::GetConfigPath("RealTrack", argc, argv)).Run();
     }
     catch (runtime_error exception)
     {
@@ -0,0 +1,78 @@
+//--------------------------------------------------
+// Startup code module: Replays a folder of frames into a shared memory ring, standing in for a capture process
+//
+// In "drop" mode the frames are released at the frame rate and dropped when the ring is full (as a live camera
+// would), while in "block" mode they are written as fast as the tracker takes them
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include <chrono>
+#include <thread>
+#include <iostream>
+using namespace std;
+
+#include <NVLib/Logger.h>
+#include <NVLib/Formatter.h>
+#include <NVLib/StringUtils.h>
+
+#include <RealTrackLib/LoadUtils.h>
+#include <RealTrackLib/FolderSource.h>
+#include <RealTrackLib/SharedWriter.h>
+
+//--------------------------------------------------
+// Execution entry point
+//--------------------------------------------------
+
+/**
+ * Main Method
+ * @param argc The count of the incomming arguments
+ * @param argv The number of incomming arguments
+ */
+int main(int argc, char ** argv)
+{
+    auto logger = NVLib::Logger(2);
+    logger.StartApplication();
+
+    try
+    {
+        if (argc < 5 || argc > 8) throw runtime_error(NVLib::Formatter() << "Usage: RealTrackFeed <input_folder> <image_count> <frame_rate> <shared_name> [slot_count] [block|drop] [float|mm16]");
+
+        auto imageCount = NVLib::StringUtils::String2Int(argv[2]);
+        auto frameRate = NVLib::StringUtils::String2Double(argv[3]);
+        auto slotCount = argc >= 6 ? NVLib::StringUtils::String2Int(argv[5]) : 8;
+        auto policy = string(argc >= 7 ? argv[6] : "block");
+        auto depthType = NVL_App::LoadUtils::GetDepthType(argc == 8 ? argv[7] : "float");
+        if (policy != "block" && policy != "drop") throw runtime_error("Unknown feed policy: " + policy);
+
+        auto source = NVL_App::FolderSource(argv[1], imageCount, frameRate, 1, depthType);
+        auto frame = NVL_App::SourceFrame(); source.Next(frame);
+        auto writer = NVL_App::SharedWriter(argv[4], source.GetSize(), frame.GetFrame()->GetDepth().type(), frameRate, slotCount, imageCount, policy == "block");
+
+        logger.Log(1, "Feeding %i frames into: %s", imageCount, argv[4]);
+        auto start = chrono::steady_clock::now();
+
+        do
+        {
+            if (policy == "drop") this_thread::sleep_until(start + chrono::duration<double>(frame.GetTimestamp()));
+            if (!writer.Write(frame.GetFrame(), frame.GetIndex(), frame.GetTimestamp())) logger.Log(1, "Dropped frame: %i", frame.GetIndex());
+            source.Release(frame.GetFrame());
+        }
+        while (source.Next(frame));
+
+        logger.Log(1, "Waiting for the consumer to finish");
+        writer.Close();
+        logger.Log(1, "Fed %i frames (%i dropped)", writer.GetFrameCount(), writer.GetDropped());
+    }
+    catch (runtime_error exception)
+    {
+        logger.Log(1, "Error: %s", exception.what());
+        exit(EXIT_FAILURE);
+    }
+
+    logger.StopApplication();
+
+    return EXIT_SUCCESS;
+}
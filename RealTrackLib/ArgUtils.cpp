@@ -22,11 +22,23 @@ using namespace NVL_App;
  */
 NVLib::Parameters * ArgUtils::Load(const string& appName, int argc, char ** argv)
 {
-	if (argc > 2) throw runtime_error(NVLib::Formatter() << "Usage: " << appName << " <config.xml>");
-	auto configPath = argc == 1 ? string("config.xml") : string(argv[1]);
+	auto configPath = GetConfigPath(appName, argc, argv);
 	return NVLib::ParameterLoader::Load(configPath);
 }
 
+/**
+ * @brief Retrieve the path to the configuration file
+ * @param appName The name of the application
+ * @param argc The number of incomming parameter arguments
+ * @param argv The incomming variables
+ * @return string The path to the configuration file
+ */
+string ArgUtils::GetConfigPath(const string& appName, int argc, char ** argv)
+{
+	if (argc > 2) throw runtime_error(NVLib::Formatter() << "Usage: " << appName << " <config.xml>");
+	return argc == 1 ? string("config.xml") : string(argv[1]);
+}
+
 //--------------------------------------------------
 // Extract Parameter Values
 //--------------------------------------------------
@@ -21,6 +21,7 @@ namespace NVL_App
 	{
 	public:
 		static NVLib::Parameters * Load(const string& appName, int argc, char ** argv);
+		static string GetConfigPath(const string& appName, int argc, char ** argv);
 
 		static string GetString(NVLib::Parameters * parameters, const string& key);
 		static int GetInteger(NVLib::Parameters * parameters, const string& key);
@@ -0,0 +1,208 @@
+//--------------------------------------------------
+// Implementation of class BinaryVocabulary
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "BinaryVocabulary.h"
+using namespace NVL_App;
+
+#define DESCRIPTOR_BYTES 32
+#define CLUSTER_ITERATIONS 8
+
+//--------------------------------------------------
+// Training
+//--------------------------------------------------
+
+/**
+ * @brief Train the vocabulary tree (each node is split into "branching" clusters, down to "levels" levels)
+ * @param descriptors The training descriptors (one 32 byte row per descriptor)
+ * @param branching The number of children of each node
+ * @param levels The depth of the tree (so there are at most branching^levels words)
+ */
+void BinaryVocabulary::Train(Mat& descriptors, int branching, int levels)
+{
+	if (descriptors.cols != DESCRIPTOR_BYTES || descriptors.type() != CV_8UC1) throw runtime_error("The vocabulary expects 256-bit binary descriptors");
+	if (branching < 2 || levels < 1) throw runtime_error("The vocabulary needs a branching of at least 2 and at least one level");
+
+	_branching = branching; _wordCount = 0; _children.clear(); _words.clear();
+
+	auto random = mt19937(42);
+	auto centers = vector<Mat>(); centers.push_back(Mat::zeros(1, DESCRIPTOR_BYTES, CV_8UC1));
+	_children.push_back(-1); _words.push_back(-1);
+
+	auto members = vector<int>(descriptors.rows);
+	for (auto i = 0; i < descriptors.rows; i++) members[i] = i;
+	Split(descriptors, members, 0, 0, levels, random, centers);
+
+	_centers.create((int)centers.size(), DESCRIPTOR_BYTES, CV_8UC1);
+	for (auto i = 0; i < (int)centers.size(); i++) memcpy(_centers.data + i * DESCRIPTOR_BYTES, centers[i].data, DESCRIPTOR_BYTES);
+}
+
+/**
+ * @brief Recursively split a node of the tree
+ * @param descriptors The training descriptors
+ * @param members The descriptors that belong to the node
+ * @param node The node that we are splitting
+ * @param level The level of the node
+ * @param levels The depth of the tree
+ * @param random The random generator used to seed the clusters
+ * @param centers The centers of the nodes (added to as the tree grows)
+ */
+void BinaryVocabulary::Split(Mat& descriptors, vector<int>& members, int node, int level, int levels, mt19937& random, vector<Mat>& centers)
+{
+	// Nodes that are deep enough (or too small to split) become words
+	if (level == levels || (int)members.size() < _branching) { _words[node] = _wordCount++; return; }
+
+	Mat childCenters; auto labels = vector<int>();
+	Cluster(descriptors, members, _branching, random, childCenters, labels);
+
+	auto first = (int)centers.size(); _children[node] = first;
+	for (auto i = 0; i < _branching; i++)
+	{
+		centers.push_back(childCenters.row(i).clone()); _children.push_back(-1); _words.push_back(-1);
+	}
+
+	for (auto i = 0; i < _branching; i++)
+	{
+		auto childMembers = vector<int>();
+		for (auto j = 0; j < (int)members.size(); j++) if (labels[j] == i) childMembers.push_back(members[j]);
+		Split(descriptors, childMembers, first + i, level + 1, levels, random, centers);
+	}
+}
+
+/**
+ * @brief Cluster a set of binary descriptors with k-majority (k-means with Hamming distance and bitwise majority centers)
+ * @param descriptors The training descriptors
+ * @param members The descriptors that we are clustering
+ * @param count The number of clusters
+ * @param random The random generator used to seed the clusters
+ * @param centers The resultant centers
+ * @param labels The cluster of each member
+ */
+void BinaryVocabulary::Cluster(Mat& descriptors, vector<int>& members, int count, mt19937& random, Mat& centers, vector<int>& labels)
+{
+	// Seed with distinct random members
+	auto seeds = members; shuffle(seeds.begin(), seeds.end(), random);
+	centers.create(count, DESCRIPTOR_BYTES, CV_8UC1);
+	for (auto i = 0; i < count; i++) memcpy(centers.data + i * DESCRIPTOR_BYTES, descriptors.data + seeds[i] * DESCRIPTOR_BYTES, DESCRIPTOR_BYTES);
+
+	labels.assign(members.size(), 0);
+	auto bitCounts = vector<int>(count * DESCRIPTOR_BYTES * 8); auto sizes = vector<int>(count);
+
+	for (auto iteration = 0; iteration < CLUSTER_ITERATIONS; iteration++)
+	{
+		// Assign each member to the closest center
+		auto changed = false;
+		for (auto j = 0; j < (int)members.size(); j++)
+		{
+			auto descriptor = descriptors.data + members[j] * DESCRIPTOR_BYTES;
+			auto best = 0; auto bestDistance = INT_MAX;
+			for (auto i = 0; i < count; i++)
+			{
+				auto distance = Distance(descriptor, centers.data + i * DESCRIPTOR_BYTES);
+				if (distance < bestDistance) { bestDistance = distance; best = i; }
+			}
+			changed |= labels[j] != best; labels[j] = best;
+		}
+		if (!changed && iteration > 0) break;
+
+		// Update each center to the bitwise majority of its members
+		fill(bitCounts.begin(), bitCounts.end(), 0); fill(sizes.begin(), sizes.end(), 0);
+		for (auto j = 0; j < (int)members.size(); j++)
+		{
+			auto descriptor = descriptors.data + members[j] * DESCRIPTOR_BYTES; auto counts = &bitCounts[labels[j] * DESCRIPTOR_BYTES * 8];
+			for (auto bit = 0; bit < DESCRIPTOR_BYTES * 8; bit++) counts[bit] += (descriptor[bit >> 3] >> (bit & 7)) & 1;
+			sizes[labels[j]]++;
+		}
+
+		for (auto i = 0; i < count; i++)
+		{
+			if (sizes[i] == 0) continue;
+			auto center = centers.data + i * DESCRIPTOR_BYTES; auto counts = &bitCounts[i * DESCRIPTOR_BYTES * 8];
+			memset(center, 0, DESCRIPTOR_BYTES);
+			for (auto bit = 0; bit < DESCRIPTOR_BYTES * 8; bit++) if (counts[bit] * 2 > sizes[i]) center[bit >> 3] |= (uchar)(1 << (bit & 7));
+		}
+	}
+}
+
+//--------------------------------------------------
+// Quantize
+//--------------------------------------------------
+
+/**
+ * @brief Find the word of a descriptor by descending the tree (branching x levels comparisons)
+ * @param descriptor The 32 byte descriptor
+ * @return int The word id
+ */
+int BinaryVocabulary::Quantize(const uchar * descriptor)
+{
+	auto node = 0;
+	while (_children[node] >= 0)
+	{
+		auto first = _children[node]; auto best = first; auto bestDistance = INT_MAX;
+		for (auto i = first; i < first + _branching; i++)
+		{
+			auto distance = Distance(descriptor, _centers.data + i * DESCRIPTOR_BYTES);
+			if (distance < bestDistance) { bestDistance = distance; best = i; }
+		}
+		node = best;
+	}
+	return _words[node];
+}
+
+/**
+ * @brief Find the words of a set of descriptors
+ * @param descriptors The descriptors (one 32 byte row each)
+ * @param output The word of each descriptor
+ */
+void BinaryVocabulary::Quantize(Mat& descriptors, vector<int>& output)
+{
+	output.resize(descriptors.rows);
+	for (auto i = 0; i < descriptors.rows; i++) output[i] = Quantize(descriptors.data + i * DESCRIPTOR_BYTES);
+}
+
+//--------------------------------------------------
+// Persistence
+//--------------------------------------------------
+
+/**
+ * @brief Save the vocabulary to disk
+ * @param path The path that we are saving to
+ */
+void BinaryVocabulary::Save(const string& path)
+{
+	auto writer = FileStorage(path, FileStorage::FORMAT_XML | FileStorage::WRITE);
+	if (!writer.isOpened()) throw runtime_error("Unable to open file: " + path);
+
+	writer << "branching" << _branching;
+	writer << "word_count" << _wordCount;
+	writer << "centers" << _centers;
+	writer << "children" << _children;
+	writer << "words" << _words;
+	writer.release();
+}
+
+/**
+ * @brief Load the vocabulary from disk
+ * @param path The path that we are loading from
+ * @return true If a vocabulary was loaded
+ * @return false If there was no vocabulary at the given path
+ */
+bool BinaryVocabulary::Load(const string& path)
+{
+	auto reader = FileStorage(path, FileStorage::FORMAT_XML | FileStorage::READ);
+	if (!reader.isOpened()) return false;
+
+	reader["branching"] >> _branching;
+	reader["word_count"] >> _wordCount;
+	reader["centers"] >> _centers;
+	reader["children"] >> _children;
+	reader["words"] >> _words;
+	reader.release();
+
+	if (_centers.rows != (int)_children.size() || _children.size() != _words.size()) throw runtime_error("The vocabulary file is corrupt: " + path);
+	return true;
+}
@@ -0,0 +1,54 @@
+//--------------------------------------------------
+// A vocabulary tree over 256-bit binary (ORB) descriptors, trained with k-majority clustering
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <random>
+#include <climits>
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+namespace NVL_App
+{
+	class BinaryVocabulary
+	{
+	private:
+		int _branching;
+		Mat _centers;
+		vector<int> _children;
+		vector<int> _words;
+		int _wordCount;
+	public:
+		BinaryVocabulary() : _branching(0), _wordCount(0) {}
+
+		void Train(Mat& descriptors, int branching, int levels);
+		int Quantize(const uchar * descriptor);
+		void Quantize(Mat& descriptors, vector<int>& output);
+
+		void Save(const string& path);
+		bool Load(const string& path);
+
+		inline bool IsTrained() { return _wordCount > 0; }
+		inline int GetWordCount() { return _wordCount; }
+
+		/**
+		 * @brief The Hamming distance between two 256-bit descriptors
+		 */
+		static inline int Distance(const uchar * a, const uchar * b)
+		{
+			auto x = (const uint64_t *)a; auto y = (const uint64_t *)b;
+			return __builtin_popcountll(x[0] ^ y[0]) + __builtin_popcountll(x[1] ^ y[1]) + __builtin_popcountll(x[2] ^ y[2]) + __builtin_popcountll(x[3] ^ y[3]);
+		}
+	private:
+		void Split(Mat& descriptors, vector<int>& members, int node, int level, int levels, mt19937& random, vector<Mat>& centers);
+		void Cluster(Mat& descriptors, vector<int>& members, int count, mt19937& random, Mat& centers, vector<int>& labels);
+	};
+}
@@ -0,0 +1,502 @@
+//--------------------------------------------------
+// Implementation of class BundleAdjuster
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "BundleAdjuster.h"
+using namespace NVL_App;
+
+// The relative noise of a depth measurement (1% of the range) and the Huber threshold (in pixels)
+#define DEPTH_SIGMA 0.01
+#define HUBER_THRESHOLD 2.0
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor (starts the background worker straight away)
+ * @param calibration The calibration of the camera
+ * @param windowSize The number of keyframes that are optimized together
+ * @param iterations The maximum number of Levenberg-Marquardt iterations per optimization
+ */
+BundleAdjuster::BundleAdjuster(Calibration * calibration, int windowSize, int iterations) :
+	_focals(calibration->GetFocals()), _center(calibration->GetCenter()), _windowSize(windowSize), _iterations(iterations), _optimizations(0), _stop(false)
+{
+	if (windowSize < 2) throw runtime_error("The bundle adjustment window must hold at least two keyframes");
+	_worker = thread(&BundleAdjuster::Work, this, PerfCounters::GetSession());
+}
+
+/**
+ * @brief Main Terminator
+ */
+BundleAdjuster::~BundleAdjuster()
+{
+	Finish();
+	for (auto keyframe : _window) delete keyframe;
+	for (auto keyframe : _incoming) delete keyframe;
+}
+
+//--------------------------------------------------
+// Tracking Thread Interface
+//--------------------------------------------------
+
+/**
+ * @brief Queue a keyframe for optimization (only holds the lock long enough to queue it)
+ * @param keyframe The keyframe that we are adding (ownership passes to the adjuster)
+ */
+void BundleAdjuster::AddKeyframe(Keyframe * keyframe)
+{
+	{
+		lock_guard<mutex> guard(_lock);
+		_incoming.push_back(keyframe);
+	}
+	_wake.notify_one();
+}
+
+/**
+ * @brief Retrieve the corrected keyframe poses that have been published since the last call. This never blocks:
+ * if the worker happens to be publishing, we simply pick the corrections up on the next frame
+ * @param output The corrected camera to world poses, by keyframe id
+ * @return true If there were corrections to collect
+ * @return false If there was nothing new (or the results were busy)
+ */
+bool BundleAdjuster::GetCorrections(map<int, SE3>& output)
+{
+	unique_lock<mutex> lock(_resultLock, try_to_lock);
+	if (!lock.owns_lock() || _published.empty()) return false;
+	output.clear(); output.swap(_published);
+	return true;
+}
+
+/**
+ * @brief Move the window onto poses that were corrected elsewhere (e.g. by a loop closure). Anything that was
+ * published but not yet collected is dropped, since it was optimized against the old poses
+ * @param poses The corrected camera to world poses, by keyframe id
+ */
+void BundleAdjuster::Realign(map<int, SE3>& poses)
+{
+	lock_guard<mutex> guard(_resultLock);
+	_realign = poses; _published.clear();
+}
+
+/**
+ * @brief Optimize whatever is still queued and then stop the worker
+ */
+void BundleAdjuster::Finish()
+{
+	{
+		lock_guard<mutex> guard(_lock);
+		_stop = true;
+	}
+	_wake.notify_all();
+	if (_worker.joinable()) _worker.join();
+}
+
+//--------------------------------------------------
+// Worker
+//--------------------------------------------------
+
+/**
+ * @brief The background loop: wait for keyframes, slide the window, optimize and publish
+ * @param session The perf session of the thread that started the worker (see PerfCounters)
+ */
+void BundleAdjuster::Work(PerfSession * session)
+{
+	auto incoming = vector<Keyframe *>(); PerfCounters::SetSession(session); PerfCounters::SetThreadName("bundle");
+
+	while (true)
+	{
+		{
+			unique_lock<mutex> lock(_lock);
+			_wake.wait(lock, [this] { return !_incoming.empty() || _stop; });
+			if (_incoming.empty()) break;
+			incoming.swap(_incoming);
+		}
+
+		{
+			lock_guard<mutex> guard(_resultLock);
+			ApplyRealign();
+		}
+
+		for (auto keyframe : incoming) Insert(keyframe);
+		incoming.clear();
+
+		{
+			auto perf = PerfScope("optimize");
+			Optimize();
+		}
+		Publish();
+	}
+}
+
+/**
+ * @brief Add a keyframe to the window, dropping the oldest one if the window is full. The keyframe starts from its
+ * odometry pose with the latest correction applied, so that it lines up with the optimized keyframes before it
+ * @param keyframe The keyframe that we are inserting
+ */
+void BundleAdjuster::Insert(Keyframe * keyframe)
+{
+	if (!_window.empty())
+	{
+		auto last = _window.back();
+		auto correction = last->GetPose() * last->GetOdometry().Inverse();
+		keyframe->GetPose() = correction * keyframe->GetOdometry();
+	}
+
+	_window.push_back(keyframe);
+	while ((int)_window.size() > _windowSize) { delete _window.front(); _window.pop_front(); }
+}
+
+/**
+ * @brief Publish the current window poses for the tracking thread. A realignment that arrived during the
+ * optimization takes precedence, so that a loop closure is never undone by a stale window
+ */
+void BundleAdjuster::Publish()
+{
+	lock_guard<mutex> guard(_resultLock);
+	ApplyRealign();
+	for (auto keyframe : _window) _published[keyframe->GetId()] = keyframe->GetPose();
+}
+
+/**
+ * @brief Apply a pending realignment to the window (the caller holds the result lock). The landmarks were
+ * expressed against the old poses, so they are dropped and re-initialized from depth
+ */
+void BundleAdjuster::ApplyRealign()
+{
+	if (_realign.empty()) return;
+
+	for (auto keyframe : _window)
+	{
+		auto pose = _realign.find(keyframe->GetId());
+		if (pose != _realign.end()) keyframe->GetPose() = pose->second;
+	}
+	_landmarks.clear(); _realign.clear();
+}
+
+//--------------------------------------------------
+// Optimization
+//--------------------------------------------------
+
+/**
+ * @brief Run Levenberg-Marquardt over the window (the oldest keyframe is held fixed to anchor the gauge)
+ */
+void BundleAdjuster::Optimize()
+{
+	BuildProblem();
+	if (_poses.size() < 2 || _terms.empty()) return;
+
+	auto lambda = 1e-4; auto cost = Evaluate(_poses, _points, true);
+	auto poses = vector<SE3>(); auto points = vector<Point3d>();
+
+	for (auto iteration = 0; iteration < _iterations; iteration++)
+	{
+		if (!Solve(lambda, poses, points)) { lambda *= 10; continue; }
+
+		auto candidateCost = Evaluate(poses, points, false);
+		if (candidateCost >= cost) { lambda *= 10; continue; }
+
+		_poses.swap(poses); _points.swap(points);
+		auto improvement = (cost - candidateCost) / max(cost, 1e-12);
+		cost = Evaluate(_poses, _points, true); lambda = max(lambda / 10, 1e-7);
+		if (improvement < 1e-6) break;
+	}
+
+	// Write the results back (only the landmarks within the window are kept)
+	for (auto i = 0; i < (int)_window.size(); i++) _window[i]->GetPose() = _poses[i].Inverse();
+	_landmarks.clear();
+	for (auto i = 0; i < (int)_points.size(); i++) _landmarks[_trackIds[i]] = _points[i];
+
+	_optimizations++;
+}
+
+/**
+ * @brief Gather the window into the solver layout: world to camera poses, the landmarks seen by at least two
+ * keyframes (initialized from depth if they are new) and one term per observation of those landmarks
+ */
+void BundleAdjuster::BuildProblem()
+{
+	_poses.clear(); _points.clear(); _trackIds.clear(); _terms.clear();
+	for (auto keyframe : _window) _poses.push_back(keyframe->GetPose().Inverse());
+
+	// Count how often each track is seen within the window
+	auto counts = map<long, int>();
+	for (auto keyframe : _window) for (auto& observation : keyframe->GetObservations()) counts[observation.GetTrackId()]++;
+
+	// Select the landmarks
+	auto slots = map<long, int>();
+	for (auto keyframe : _window)
+	{
+		for (auto& observation : keyframe->GetObservations())
+		{
+			auto trackId = observation.GetTrackId();
+			if (counts[trackId] < 2 || slots.find(trackId) != slots.end()) continue;
+
+			auto existing = _landmarks.find(trackId);
+			if (existing == _landmarks.end() && observation.GetDepth() <= 0) continue;
+
+			auto position = Point3d();
+			if (existing != _landmarks.end()) position = existing->second;
+			else
+			{
+				auto& point = observation.GetPoint(); auto Z = observation.GetDepth();
+				auto local = Point3d((point.x - _center.x) * Z / _focals[0], (point.y - _center.y) * Z / _focals[1], Z);
+				position = keyframe->GetPose().Transform(local);
+			}
+
+			slots[trackId] = (int)_points.size(); _points.push_back(position); _trackIds.push_back(trackId);
+		}
+	}
+
+	// Create a term for each observation of a selected landmark
+	for (auto i = 0; i < (int)_window.size(); i++)
+	{
+		for (auto& observation : _window[i]->GetObservations())
+		{
+			auto slot = slots.find(observation.GetTrackId()); if (slot == slots.end()) continue;
+			_terms.push_back(BundleTerm(i, slot->second, observation.GetPoint(), observation.GetDepth()));
+		}
+	}
+
+	_landmarkTerms.resize(_points.size());
+	for (auto& terms : _landmarkTerms) terms.clear();
+	for (auto i = 0; i < (int)_terms.size(); i++) _landmarkTerms[_terms[i].GetLandmark()].push_back(i);
+}
+
+/**
+ * @brief Evaluate the robust cost, optionally building the normal equation blocks. Each term has a reprojection
+ * residual, plus a depth residual when the observation had a valid depth (which fixes the scale)
+ * @param poses The world to camera poses
+ * @param points The landmark positions
+ * @param build Whether we want the blocks of the normal equations
+ * @return double The Huber cost
+ */
+double BundleAdjuster::Evaluate(vector<SE3>& poses, vector<Point3d>& points, bool build)
+{
+	auto freePoses = (int)poses.size() - 1;
+	if (build)
+	{
+		_poseH.assign(freePoses * 36, 0); _poseG.assign(freePoses * 6, 0);
+		_landmarkH.assign(points.size() * 9, 0); _landmarkG.assign(points.size() * 3, 0);
+		_blockW.assign(_terms.size() * 18, 0);
+	}
+
+	auto fx = _focals[0]; auto fy = _focals[1]; auto cx = _center.x; auto cy = _center.y;
+	auto cost = 0.0;
+
+	for (auto t = 0; t < (int)_terms.size(); t++)
+	{
+		auto& term = _terms[t]; auto& pose = poses[term.GetPose()]; auto& point = points[term.GetLandmark()];
+
+		double X, Y, Z; pose.Transform(point.x, point.y, point.z, X, Y, Z);
+		if (Z < 1e-3) continue;
+		auto iz = 1.0 / Z;
+
+		// Residuals and the projection Jacobian
+		double r[3] = { fx * X * iz + cx - term.GetPoint().x, fy * Y * iz + cy - term.GetPoint().y, 0 };
+		double J[3][3] = { { fx * iz, 0, -fx * X * iz * iz }, { 0, fy * iz, -fy * Y * iz * iz }, { 0, 0, 0 } };
+		auto rows = 2;
+		if (term.GetDepth() > 0)
+		{
+			auto scale = 1.0 / (DEPTH_SIGMA * term.GetDepth());
+			r[2] = (Z - term.GetDepth()) * scale; J[2][2] = scale; rows = 3;
+		}
+
+		// Huber cost and weight
+		auto error2 = r[0] * r[0] + r[1] * r[1] + r[2] * r[2]; auto error = sqrt(error2);
+		auto weight = error <= HUBER_THRESHOLD ? 1.0 : HUBER_THRESHOLD / error;
+		cost += error <= HUBER_THRESHOLD ? error2 : 2 * HUBER_THRESHOLD * error - HUBER_THRESHOLD * HUBER_THRESHOLD;
+		if (!build) continue;
+
+		// Jacobians with respect to a left perturbation of the pose (w, v) and to the landmark
+		double Jp[3][6], Jl[3][3];
+		for (auto j = 0; j < rows; j++)
+		{
+			auto a = J[j][0]; auto b = J[j][1]; auto c = J[j][2];
+			Jp[j][0] = -b * Z + c * Y; Jp[j][1] = a * Z - c * X; Jp[j][2] = -a * Y + b * X;
+			Jp[j][3] = a; Jp[j][4] = b; Jp[j][5] = c;
+			for (auto column = 0; column < 3; column++) Jl[j][column] = a * pose.R(0, column) + b * pose.R(1, column) + c * pose.R(2, column);
+		}
+
+		// Accumulate the landmark blocks
+		auto C = &_landmarkH[term.GetLandmark() * 9]; auto gl = &_landmarkG[term.GetLandmark() * 3];
+		for (auto i = 0; i < 3; i++)
+		{
+			for (auto j = 0; j < 3; j++) for (auto k = 0; k < rows; k++) C[i * 3 + j] += weight * Jl[k][i] * Jl[k][j];
+			for (auto k = 0; k < rows; k++) gl[i] += weight * Jl[k][i] * r[k];
+		}
+
+		// Accumulate the pose blocks (the first pose is fixed)
+		if (term.GetPose() == 0) continue;
+		auto A = &_poseH[(term.GetPose() - 1) * 36]; auto gp = &_poseG[(term.GetPose() - 1) * 6]; auto W = &_blockW[t * 18];
+		for (auto i = 0; i < 6; i++)
+		{
+			for (auto j = 0; j < 6; j++) for (auto k = 0; k < rows; k++) A[i * 6 + j] += weight * Jp[k][i] * Jp[k][j];
+			for (auto j = 0; j < 3; j++) for (auto k = 0; k < rows; k++) W[i * 3 + j] += weight * Jp[k][i] * Jl[k][j];
+			for (auto k = 0; k < rows; k++) gp[i] += weight * Jp[k][i] * r[k];
+		}
+	}
+
+	return cost;
+}
+
+/**
+ * @brief Solve the damped normal equations with the Schur complement: the landmarks are eliminated (their blocks
+ * are 3x3 and independent), the small reduced pose system is solved with Cholesky, and the landmark updates are
+ * recovered by back substitution
+ * @param lambda The Levenberg-Marquardt damping
+ * @param poses The candidate poses
+ * @param points The candidate landmarks
+ * @return true If the system could be solved
+ * @return false If the reduced system was not positive definite
+ */
+bool BundleAdjuster::Solve(double lambda, vector<SE3>& poses, vector<Point3d>& points)
+{
+	auto freePoses = (int)_poses.size() - 1; auto n = freePoses * 6;
+	_reduced.assign(n * n, 0); _rhs.assign(n, 0);
+	_landmarkInverse.assign(_points.size() * 9, 0);
+
+	// The damped pose blocks
+	for (auto k = 0; k < freePoses; k++)
+	{
+		auto A = &_poseH[k * 36];
+		for (auto i = 0; i < 6; i++)
+		{
+			for (auto j = 0; j < 6; j++) _reduced[(k * 6 + i) * n + k * 6 + j] = A[i * 6 + j];
+			_reduced[(k * 6 + i) * n + k * 6 + i] += lambda * max(A[i * 6 + i], 1e-6);
+			_rhs[k * 6 + i] = -_poseG[k * 6 + i];
+		}
+	}
+
+	// Eliminate the landmarks
+	double damped[9], WC[18];
+	for (auto l = 0; l < (int)_points.size(); l++)
+	{
+		for (auto i = 0; i < 9; i++) damped[i] = _landmarkH[l * 9 + i];
+		for (auto i = 0; i < 3; i++) damped[i * 4] += lambda * max(damped[i * 4], 1e-6);
+
+		auto Ci = &_landmarkInverse[l * 9];
+		if (!Invert3(damped, Ci)) { for (auto i = 0; i < 9; i++) Ci[i] = 0; continue; }
+		auto gl = &_landmarkG[l * 3];
+
+		for (auto t1 : _landmarkTerms[l])
+		{
+			auto k1 = _terms[t1].GetPose() - 1; if (k1 < 0) continue;
+			auto W1 = &_blockW[t1 * 18];
+
+			for (auto i = 0; i < 6; i++) for (auto j = 0; j < 3; j++)
+				WC[i * 3 + j] = W1[i * 3 + 0] * Ci[0 * 3 + j] + W1[i * 3 + 1] * Ci[1 * 3 + j] + W1[i * 3 + 2] * Ci[2 * 3 + j];
+
+			for (auto i = 0; i < 6; i++) _rhs[k1 * 6 + i] += WC[i * 3 + 0] * gl[0] + WC[i * 3 + 1] * gl[1] + WC[i * 3 + 2] * gl[2];
+
+			for (auto t2 : _landmarkTerms[l])
+			{
+				auto k2 = _terms[t2].GetPose() - 1; if (k2 < 0) continue;
+				auto W2 = &_blockW[t2 * 18];
+				for (auto i = 0; i < 6; i++) for (auto j = 0; j < 6; j++)
+					_reduced[(k1 * 6 + i) * n + k2 * 6 + j] -= WC[i * 3 + 0] * W2[j * 3 + 0] + WC[i * 3 + 1] * W2[j * 3 + 1] + WC[i * 3 + 2] * W2[j * 3 + 2];
+			}
+		}
+	}
+
+	// Solve the reduced pose system
+	if (!Cholesky(_reduced, _rhs, n)) return false;
+
+	poses.resize(_poses.size()); poses[0] = _poses[0];
+	for (auto k = 0; k < freePoses; k++)
+	{
+		auto update = Vec6d(_rhs[k * 6 + 0], _rhs[k * 6 + 1], _rhs[k * 6 + 2], _rhs[k * 6 + 3], _rhs[k * 6 + 4], _rhs[k * 6 + 5]);
+		poses[k + 1] = SE3::Exp(update) * _poses[k + 1];
+	}
+
+	// Back substitute for the landmark updates
+	points.resize(_points.size());
+	for (auto l = 0; l < (int)_points.size(); l++)
+	{
+		auto gl = &_landmarkG[l * 3]; auto Ci = &_landmarkInverse[l * 9];
+		double b[3] = { -gl[0], -gl[1], -gl[2] };
+
+		for (auto t : _landmarkTerms[l])
+		{
+			auto k = _terms[t].GetPose() - 1; if (k < 0) continue;
+			auto W = &_blockW[t * 18]; auto dp = &_rhs[k * 6];
+			for (auto j = 0; j < 3; j++) for (auto i = 0; i < 6; i++) b[j] -= W[i * 3 + j] * dp[i];
+		}
+
+		points[l] = _points[l] + Point3d(
+			Ci[0] * b[0] + Ci[1] * b[1] + Ci[2] * b[2],
+			Ci[3] * b[0] + Ci[4] * b[1] + Ci[5] * b[2],
+			Ci[6] * b[0] + Ci[7] * b[1] + Ci[8] * b[2]);
+	}
+
+	return true;
+}
+
+//--------------------------------------------------
+// Dense Helpers
+//--------------------------------------------------
+
+/**
+ * @brief Invert a 3x3 matrix (by the adjugate)
+ * @param input The row-major matrix
+ * @param output The row-major inverse
+ * @return true If the matrix was invertible
+ */
+bool BundleAdjuster::Invert3(const double * input, double * output)
+{
+	auto& m = input;
+	auto c0 = m[4] * m[8] - m[5] * m[7];
+	auto c1 = m[5] * m[6] - m[3] * m[8];
+	auto c2 = m[3] * m[7] - m[4] * m[6];
+	auto determinant = m[0] * c0 + m[1] * c1 + m[2] * c2;
+	if (fabs(determinant) < 1e-12) return false;
+
+	auto inverse = 1.0 / determinant;
+	output[0] = c0 * inverse; output[1] = (m[2] * m[7] - m[1] * m[8]) * inverse; output[2] = (m[1] * m[5] - m[2] * m[4]) * inverse;
+	output[3] = c1 * inverse; output[4] = (m[0] * m[8] - m[2] * m[6]) * inverse; output[5] = (m[2] * m[3] - m[0] * m[5]) * inverse;
+	output[6] = c2 * inverse; output[7] = (m[1] * m[6] - m[0] * m[7]) * inverse; output[8] = (m[0] * m[4] - m[1] * m[3]) * inverse;
+	return true;
+}
+
+/**
+ * @brief Solve a symmetric positive definite system in place with a Cholesky factorization
+ * @param A The n x n row-major matrix (overwritten by its factor)
+ * @param b The right hand side (overwritten by the solution)
+ * @param n The size of the system
+ * @return true If the matrix was positive definite
+ */
+bool BundleAdjuster::Cholesky(vector<double>& A, vector<double>& b, int n)
+{
+	for (auto j = 0; j < n; j++)
+	{
+		auto diagonal = A[j * n + j];
+		for (auto k = 0; k < j; k++) diagonal -= A[j * n + k] * A[j * n + k];
+		if (diagonal <= 0) return false;
+		A[j * n + j] = sqrt(diagonal);
+
+		for (auto i = j + 1; i < n; i++)
+		{
+			auto value = A[i * n + j];
+			for (auto k = 0; k < j; k++) value -= A[i * n + k] * A[j * n + k];
+			A[i * n + j] = value / A[j * n + j];
+		}
+	}
+
+	for (auto i = 0; i < n; i++)
+	{
+		for (auto k = 0; k < i; k++) b[i] -= A[i * n + k] * b[k];
+		b[i] /= A[i * n + i];
+	}
+
+	for (auto i = n - 1; i >= 0; i--)
+	{
+		for (auto k = i + 1; k < n; k++) b[i] -= A[k * n + i] * b[k];
+		b[i] /= A[i * n + i];
+	}
+
+	return true;
+}
@@ -0,0 +1,100 @@
+//--------------------------------------------------
+// A sliding-window bundle adjuster that refines the recent keyframes (and the landmarks they track) on a
+// background thread, publishing the corrected poses for the tracking thread to pick up when it is ready
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <map>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include "SE3.h"
+#include "Keyframe.h"
+#include "Calibration.h"
+#include "PerfCounters.h"
+
+namespace NVL_App
+{
+	class BundleTerm
+	{
+	private:
+		int _pose;
+		int _landmark;
+		Point2d _point;
+		double _depth;
+	public:
+		BundleTerm(int pose, int landmark, const Point2d& point, double depth) :
+			_pose(pose), _landmark(landmark), _point(point), _depth(depth) {}
+
+		inline int& GetPose() { return _pose; }
+		inline int& GetLandmark() { return _landmark; }
+		inline Point2d& GetPoint() { return _point; }
+		inline double& GetDepth() { return _depth; }
+	};
+
+	class BundleAdjuster
+	{
+	private:
+		Vec2d _focals;
+		Point2d _center;
+		int _windowSize;
+		int _iterations;
+
+		deque<Keyframe *> _window;
+		map<long, Point3d> _landmarks;
+
+		vector<Keyframe *> _incoming;
+		map<int, SE3> _published;
+		map<int, SE3> _realign;
+		atomic<int> _optimizations;
+		bool _stop;
+		thread _worker;
+		mutex _lock;
+		mutex _resultLock;
+		condition_variable _wake;
+
+		vector<BundleTerm> _terms;
+		vector<long> _trackIds;
+		vector< vector<int> > _landmarkTerms;
+		vector<SE3> _poses;
+		vector<Point3d> _points;
+		vector<double> _poseH, _poseG, _landmarkH, _landmarkG, _blockW;
+		vector<double> _reduced, _rhs, _landmarkInverse;
+	public:
+		BundleAdjuster(Calibration * calibration, int windowSize, int iterations);
+		~BundleAdjuster();
+
+		void AddKeyframe(Keyframe * keyframe);
+		bool GetCorrections(map<int, SE3>& output);
+		void Realign(map<int, SE3>& poses);
+		void Finish();
+
+		inline int GetOptimizations() { return _optimizations; }
+	private:
+		void Work(PerfSession * session);
+		void Insert(Keyframe * keyframe);
+		void Optimize();
+		void Publish();
+		void ApplyRealign();
+
+		void BuildProblem();
+		double Evaluate(vector<SE3>& poses, vector<Point3d>& points, bool build);
+		bool Solve(double lambda, vector<SE3>& poses, vector<Point3d>& points);
+
+		static bool Invert3(const double * input, double * output);
+		static bool Cholesky(vector<double>& A, vector<double>& b, int n);
+	};
+}
@@ -21,6 +21,10 @@ namespace NVL_App
 	private:
 		Vec2d _focals;
 		Point2d _center;
+		Mat _distortion;
+		Mat _depthCamera;
+		Mat _depthDistortion;
+		Mat _depthPose;
 	public:
 		Calibration(const Vec2d& focals, const Point2d& center) :
 			_focals(focals), _center(center) {}
@@ -38,5 +42,18 @@ namespace NVL_App
 
 		inline Vec2d& GetFocals() { return _focals; }
 		inline Point2d& GetCenter() { return _center; }
+		inline Mat& GetDistortion() { return _distortion; }
+		inline Mat& GetDepthCamera() { return _depthCamera; }
+		inline Mat& GetDepthDistortion() { return _depthDistortion; }
+		inline Mat& GetDepthPose() { return _depthPose; }
+
+		inline bool HasDistortion() 
+		{
+			auto data = (double *) _distortion.data;
+			for (auto i = 0; i < (int)_distortion.total(); i++) if (data[i] != 0) return true;
+			return false;
+		}
+
+		inline bool HasDepthCamera() { return !_depthCamera.empty(); }
 	};
 }
@@ -20,23 +20,29 @@ using namespace NVL_App;
  */
 void FastDetector::Extract(Mat& image, vector<KeyPoint>& keypoints)
 {
-	Ptr<FeatureDetector> detector = FastFeatureDetector::create();
-    vector<KeyPoint> points; detector->detect(image, points);
+    _points.clear(); _detector->detect(image, _points);
 
-    auto duplicates = unordered_map<int, KeyPoint>();
-    for (const KeyPoint & keypoint : points)
+    // Keep the strongest response within each block (the block table is reused between frames)
+    auto blockCount = (image.cols / _blockSize + 1) * (image.rows / _blockSize + 1);
+    _blocks.assign(blockCount, -1);
+
+    for (auto i = 0; i < _points.size(); i++)
     {
+        auto& keypoint = _points[i];
         auto key = GetIndex(keypoint.pt, _blockSize, image.cols);
-        auto match = duplicates.find(key);
+        auto& match = _blocks[key];
 
-        if (match == duplicates.end()) duplicates[key] = keypoint;
-        else
-        {
-            if (duplicates[key].response < keypoint.response) duplicates[key] = keypoint;
-        }
+        if (match == -1 || _points[match].response < keypoint.response) match = i;
     }
 
-    for (const pair<int, KeyPoint>& pair : duplicates) keypoints.push_back(pair.second);
+    auto start = keypoints.size();
+    for (auto match : _blocks) if (match != -1) keypoints.push_back(_points[match]);
+
+    // Keep only the strongest responses if we have a keypoint target
+    if (_keypointTarget <= 0 || (int)(keypoints.size() - start) <= _keypointTarget) return;
+    auto strongest = [](const KeyPoint& a, const KeyPoint& b) { return a.response > b.response; };
+    nth_element(keypoints.begin() + start, keypoints.begin() + start + _keypointTarget, keypoints.end(), strongest);
+    keypoints.erase(keypoints.begin() + start + _keypointTarget, keypoints.end());
 }
 
 /**
@@ -49,7 +55,7 @@ void FastDetector::Extract(Mat& image, vector<KeyPoint>& keypoints)
 int FastDetector::GetIndex(const Point2d& point, int blockSize, int width)
 {
     int x = (int)floor(point.x / blockSize); int y = (int)floor(point.y / blockSize);
-    return x + y * width;
+    return x + y * (width / blockSize + 1);
 }
 
 //--------------------------------------------------
@@ -62,27 +68,26 @@ int FastDetector::GetIndex(const Point2d& point, int blockSize, int width)
  * @param kp_2 The list of keypoints from the second image
  * @param output The list of resultant feature matches for the system
  */
-void FastDetector::Match(vector<KeyPoint>& kp_1, vector<KeyPoint>& kp_2, vector<FeatureMatch *>& output)
+void FastDetector::Match(vector<KeyPoint>& kp_1, vector<KeyPoint>& kp_2, vector<FeatureMatch>& output)
 {
 	// Validate that the frame is set
 	if (_frame == nullptr) throw runtime_error("Right now we are using a setting stereo frame hack - and it was detected that stereo frame was not set.");
 
 	// Prepare the points
-    auto points_1 = vector<Point2f>(); for (auto point : kp_1) points_1.push_back(point.pt);
-	auto points_2 = vector<Point2f>(); for (auto point : kp_2) points_2.push_back(point.pt);
+    _points_1.clear(); for (auto& point : kp_1) _points_1.push_back(point.pt);
+	_points_2.clear(); for (auto& point : kp_2) _points_2.push_back(point.pt);
 
 	// Find the matches
-    auto matchPoints = vector<Point2f>(); auto status = vector<uchar>(); auto errors = vector<float>();
-    calcOpticalFlowPyrLK(_frame->GetLeft(), _frame->GetRight(), points_1, matchPoints, status, errors, Size(21, 21), 3, TermCriteria(TermCriteria::EPS | TermCriteria::COUNT, 9000, 1e-8));
+    calcOpticalFlowPyrLK(_frame->GetLeft(), _frame->GetRight(), _points_1, _matchPoints, _status, _errors, Size(_lkWindow, _lkWindow), _lkLevels, TermCriteria(TermCriteria::EPS | TermCriteria::COUNT, 9000, 1e-8));
 
 	// Perform radius matching with point 2
-	FindMatches(points_2, matchPoints, output);
+	FindMatches(_points_2, _matchPoints, output);
 
 	// Filter based on optical flow error
-	FilterOnError(status, errors, output);
+	FilterOnError(_status, _errors, output);
 
 	// Filter based on epipolar geometry
-	EpipolarFilter(points_1, points_2, output);
+	EpipolarFilter(_points_1, _points_2, output);
 }
 
 /**
@@ -91,44 +96,42 @@ void FastDetector::Match(vector<KeyPoint>& kp_1, vector<KeyPoint>& kp_2, vector<
  * @param pointSet2 The second point set
  * @param matches The list of associated matches
  */
-void FastDetector::FindMatches(vector<Point2f>& pointSet1, vector<Point2f>& pointSet2, vector<FeatureMatch *>& matches) 
+void FastDetector::FindMatches(vector<Point2f>& pointSet1, vector<Point2f>& pointSet2, vector<FeatureMatch>& matches) 
 {
 	auto matcher = DescriptorMatcher::create(DescriptorMatcher::MatcherType::FLANNBASED);
-	auto matchVector = vector< vector<DMatch> >();
+	_matchVector.clear();
 
-	Mat trainDescriptors = BuildPointDescriptor(pointSet1);
-	Mat queryDescriptors = BuildPointDescriptor(pointSet2);
+	BuildPointDescriptor(pointSet1, _trainDescriptors);
+	BuildPointDescriptor(pointSet2, _queryDescriptors);
 	
-	matcher->radiusMatch(queryDescriptors, trainDescriptors, matchVector, 1);
+	matcher->radiusMatch(_queryDescriptors, _trainDescriptors, _matchVector, 1);
 
-	for (auto i = 0; i < matchVector.size(); i++) 
+	for (auto i = 0; i < _matchVector.size(); i++) 
 	{
-		if (matchVector[i].size() <= 0) continue;
-		auto trainId = matchVector[i][0].queryIdx;
-		auto matchId = matchVector[i][0].trainIdx;
-		auto score = matchVector[i][0].distance;
+		if (_matchVector[i].size() <= 0) continue;
+		auto trainId = _matchVector[i][0].queryIdx;
+		auto matchId = _matchVector[i][0].trainIdx;
+		auto score = _matchVector[i][0].distance;
 
-		matches.push_back(new FeatureMatch(trainId, matchId, score));
+		matches.push_back(FeatureMatch(trainId, matchId, score));
 	}
 }
 
 /**
  * @brief Build a descriptor consisting of points
  * @param points The points that make up the descriptor
- * @return Mat The resultant descriptor matrix
+ * @param output The resultant descriptor matrix (reused between calls)
  */
-Mat FastDetector::BuildPointDescriptor(vector<Point2f>& points) 
+void FastDetector::BuildPointDescriptor(vector<Point2f>& points, Mat& output) 
 {
-	Mat result = Mat_<float>(points.size(), 2);
-	auto data = (float *) result.data;
+	output.create((int)points.size(), 2, CV_32FC1);
+	auto data = (float *) output.data;
 
 	for (auto i = 0; i < points.size(); i++) 
 	{
 		data[i * 2 + 0] = points[i].x;
 		data[i * 2 + 1] = points[i].y;
 	}
-
-	return result;
 }
 
 /**
@@ -137,21 +140,16 @@ Mat FastDetector::BuildPointDescriptor(vector<Point2f>& points)
  * @param errors The errors returned by the feature matcher
  * @param matches The list of matches
  */
-void FastDetector::FilterOnError(vector<uchar>& status, vector<float>& errors, vector<FeatureMatch *>& matches) 
+void FastDetector::FilterOnError(vector<uchar>& status, vector<float>& errors, vector<FeatureMatch>& matches) 
 {
 	auto counter = 0;
-	for (auto i = matches.begin(); i != matches.end(); ) 
+	for (auto i = 0; i < matches.size(); i++) 
 	{
-		auto match = *i;
-		
-		if (status[match->GetFirstId()] == 0 || errors[match->GetFirstId()] > 9) 
-		{
-			i = matches.erase(i);
-			delete match;	
-			if (i == matches.end()) break;
-		}
-		else i++;
+		auto& match = matches[i];
+		if (status[match.GetFirstId()] == 0 || errors[match.GetFirstId()] > 9) continue;
+		matches[counter++] = match;
 	}
+	matches.erase(matches.begin() + counter, matches.end());
 }
 
 /**
@@ -160,34 +158,27 @@ void FastDetector::FilterOnError(vector<uchar>& status, vector<float>& errors, v
  * @param pointSet2 The second set of points that we are working with
  * @param output The output list of matches
  */
-void FastDetector::EpipolarFilter(vector<Point2f>& pointSet1, vector<Point2f>& pointSet2, vector<FeatureMatch *>& output)
+void FastDetector::EpipolarFilter(vector<Point2f>& pointSet1, vector<Point2f>& pointSet2, vector<FeatureMatch>& output)
 {
    	// Extract the matching points 
-   	vector<Point2f> points_1; vector<Point2f> points_2;
-	for (auto match : output) 
+   	_filter_1.clear(); _filter_2.clear();
+	for (auto& match : output) 
 	{ 
-		points_1.push_back(pointSet1[match->GetFirstId()]); 
-		points_2.push_back(pointSet2[match->GetSecondId()]); 
+		_filter_1.push_back(pointSet1[match.GetFirstId()]); 
+		_filter_2.push_back(pointSet2[match.GetSecondId()]); 
 	}
 
 	// Find the fundamental matrix and extract the outliers
-    auto mask = vector<uchar>();
-    auto F = findFundamentalMat(points_1, points_2, FM_LMEDS, 1.0, 0.8, mask);
+	_mask.clear();
+    auto F = findFundamentalMat(_filter_1, _filter_2, FM_LMEDS, 1.0, 0.8, _mask);
 
+	// Compact the inliers to the front of the list
 	auto counter = 0;
-	for (auto i = output.begin(); i != output.end(); i++) 
+	for (auto i = 0; i < output.size(); i++) 
 	{
-		auto match = *i;
-		
-		auto firstId = match->GetFirstId();
-
-		if (mask[counter++] == 0) 
-		{
-			i = output.erase(i);
-			delete match;
-			if (i == output.end()) break;	
-		}
+		if (_mask[i] != 0) output[counter++] = output[i];
 	}
+	output.erase(output.begin() + counter, output.end());
 }
 
 //--------------------------------------------------
@@ -201,6 +192,21 @@ void FastDetector::EpipolarFilter(vector<Point2f>& pointSet1, vector<Point2f>& p
  */
 void FastDetector::SetFrame(Mat& image1, Mat& image2) 
 {
-	if (_frame != nullptr) delete _frame;
-	_frame = new NVLib::StereoFrame(image1, image2);
+	if (_frame == nullptr) { _frame = new NVLib::StereoFrame(image1, image2); return; }
+	_frame->GetLeft() = image1; _frame->GetRight() = image2;
+}
+
+//--------------------------------------------------
+// SetQuality
+//--------------------------------------------------
+
+/**
+ * @brief Apply the quality settings that are relevant to detection and matching
+ * @param settings The settings that we are applying
+ */
+void FastDetector::SetQuality(QualitySettings& settings) 
+{
+	_keypointTarget = settings.GetKeypointTarget();
+	_lkWindow = settings.GetLKWindow();
+	_lkLevels = settings.GetLKLevels();
 }
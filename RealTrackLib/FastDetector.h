@@ -18,6 +18,7 @@ using namespace cv;
 #include <NVLib/Model/StereoFrame.h>
 
 #include "FeatureMatch.h"
+#include "QualitySettings.h"
 
 namespace NVL_App
 {
@@ -25,20 +26,39 @@ namespace NVL_App
 	{
 	private:
 		int _blockSize;
+		int _keypointTarget;
+		int _lkWindow;
+		int _lkLevels;
 		NVLib::StereoFrame * _frame;
+		Ptr<FeatureDetector> _detector;
+
+		vector<KeyPoint> _points;
+		vector<int> _blocks;
+		vector<Point2f> _points_1;
+		vector<Point2f> _points_2;
+		vector<Point2f> _matchPoints;
+		vector<uchar> _status;
+		vector<float> _errors;
+		vector<Point2f> _filter_1;
+		vector<Point2f> _filter_2;
+		vector<uchar> _mask;
+		vector< vector<DMatch> > _matchVector;
+		Mat _trainDescriptors;
+		Mat _queryDescriptors;
 	public:
-		FastDetector(int blockSize) : _blockSize(blockSize) { _frame = nullptr; }
+		FastDetector(int blockSize) : _blockSize(blockSize), _keypointTarget(0), _lkWindow(21), _lkLevels(3) { _frame = nullptr; _detector = FastFeatureDetector::create(); }
 		~FastDetector() { if (_frame != nullptr) delete _frame; }
 
 		void Extract(Mat& image, vector<KeyPoint>& keypoints); 
-		void Match(vector<KeyPoint>& kp_1, vector<KeyPoint>& kp_2, vector<FeatureMatch *>& output);
+		void Match(vector<KeyPoint>& kp_1, vector<KeyPoint>& kp_2, vector<FeatureMatch>& output);
 
 		void SetFrame(Mat& image1, Mat& image2);
+		void SetQuality(QualitySettings& settings);
 	private:
 		int GetIndex(const Point2d& point, int blockSize, int width);
-		void FindMatches(vector<Point2f>& pointSet1, vector<Point2f>& pointSet2, vector<FeatureMatch *>& matches);
-		void FilterOnError(vector<uchar>& status, vector<float>& errors, vector<FeatureMatch *>& matches);
-		void EpipolarFilter(vector<Point2f>& pointSet1, vector<Point2f>& pointSet2, vector<FeatureMatch *>& output);
-		Mat BuildPointDescriptor(vector<Point2f>& points);
+		void FindMatches(vector<Point2f>& pointSet1, vector<Point2f>& pointSet2, vector<FeatureMatch>& matches);
+		void FilterOnError(vector<uchar>& status, vector<float>& errors, vector<FeatureMatch>& matches);
+		void EpipolarFilter(vector<Point2f>& pointSet1, vector<Point2f>& pointSet2, vector<FeatureMatch>& output);
+		void BuildPointDescriptor(vector<Point2f>& points, Mat& output);
 	};
 }
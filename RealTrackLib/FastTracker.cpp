@@ -9,6 +9,15 @@
 #include "FastTracker.h"
 using namespace NVL_App;
 
+// The number of depth samples a landmark needs before it stands in for the depth map
+#define MIN_OBSERVATIONS 3
+
+// The distance (relative to depth) within which a depth sample is taken to agree with its landmark
+#define LANDMARK_TOLERANCE 0.03
+
+// The radius (relative to depth) within which a new track picks up an unobserved landmark
+#define REACQUIRE_RADIUS 0.01
+
 //--------------------------------------------------
 // Constructors
 //--------------------------------------------------
@@ -18,9 +27,10 @@ using namespace NVL_App;
  * @param calibration The main calibration parameters
  * @param firstFrame The first frame within the series
  */
-FastTracker::FastTracker(Calibration * calibration, NVLib::DepthFrame * firstFrame) : _calibration(calibration), _frame(firstFrame)
+FastTracker::FastTracker(Calibration * calibration, NVLib::DepthFrame * firstFrame) : _calibration(calibration), _frame(firstFrame), _nextTrackId(0), _cache(nullptr), _matchKey(0), _features(nullptr), _detectKey(0), _landmarks(nullptr), _landmarkPoints(0)
 {
-	_detector = new FastDetector(5); _detector->Extract(firstFrame->GetColor(), _keypoints);
+	_estimator = new PoseEstimator(10000); _detector = new FastDetector(BLOCK_SIZE); _detector->Extract(firstFrame->GetColor(), _keypoints);
+	for (auto i = 0; i < (int)_keypoints.size(); i++) _trackIds.push_back(_nextTrackId++);
 }
 
 /**
@@ -28,7 +38,7 @@ FastTracker::FastTracker(Calibration * calibration, NVLib::DepthFrame * firstFra
  */
 FastTracker::~FastTracker() 
 {
-	delete _detector;
+	delete _detector; delete _estimator;
 }
 
 //--------------------------------------------------
@@ -40,26 +50,43 @@ FastTracker::~FastTracker()
  * @param frame The frame that we are getting the pose from
  * @param keypoints The keypoints associated with the new frame
  * @param error The output reprojection error
- * @return Mat Returns a Mat
+ * @return SE3 The pose of the new frame relative to the previous one
  */
-Mat FastTracker::GetPose(NVLib::DepthFrame * frame, vector<KeyPoint>& keypoints, Vec2d& error)
+SE3 FastTracker::GetPose(NVLib::DepthFrame * frame, vector<KeyPoint>& keypoints, Vec2d& error)
 {
-	// Extract the features that we need
-	_detector->Extract(frame->GetColor(), keypoints);
+	// Reuse the features and matches from an earlier run if nothing that they depend on has changed
+	auto start = chrono::steady_clock::now();
+	if (_cache != nullptr && _cache->GetMatches(_matchKey, keypoints, _matches)) 
+	{
+		_timings[0] = GetElapsed(start); _timings[1] = 0;
+	}
+	else 
+	{
+		// Extract the features that we need (unless they were precomputed)
+		{
+			auto perf = PerfScope("detect");
+			if (_features == nullptr || !_features->GetKeypoints(_detectKey, keypoints)) _detector->Extract(frame->GetColor(), keypoints);
+		}
+		_timings[0] = GetElapsed(start);
 
-	// Find corresponding features
-	_detector->SetFrame(_frame->GetColor(), frame->GetColor());
-	auto matches = vector<FeatureMatch *>(); _detector->Match(_keypoints, keypoints, matches);
+		// Find corresponding features
+		{
+			auto perf = PerfScope("match");
+			_detector->SetFrame(_frame->GetColor(), frame->GetColor());
+			_matches.clear(); _detector->Match(_keypoints, keypoints, _matches);
+		}
+		if (_cache != nullptr) _cache->SetMatches(_matchKey, keypoints, _matches);
+		_timings[1] = GetElapsed(start);
+	}
 
 	// DEBUG: Show the correspondences
 	//auto stereoFrame = NVLib::StereoFrame(_frame->GetColor(), frame->GetColor());
-	//ShowMatchingPoints(stereoFrame, matches, _keypoints, keypoints);
+	//ShowMatchingPoints(stereoFrame, _matches, _keypoints, keypoints);
 
 	// Estimate the pose
-	Mat pose = FindPoseProcess(keypoints, matches, error);
-
-	// Free Values
-	for (auto match : matches) delete match;
+	auto perf = PerfScope("pose");
+	auto pose = FindPoseProcess(keypoints, _matches, error);
+	_timings[2] = GetElapsed(start);
 
 	// Return the pose
 	return pose;
@@ -72,27 +99,32 @@ Mat FastTracker::GetPose(NVLib::DepthFrame * frame, vector<KeyPoint>& keypoints,
  * @param error The reprojection error due to matching
  * @return The resultant pose matrix
  */
-Mat FastTracker::FindPoseProcess(vector<KeyPoint>& keypoints_2, vector<FeatureMatch *>& matches, Vec2d& error) 
+SE3 FastTracker::FindPoseProcess(vector<KeyPoint>& keypoints_2, vector<FeatureMatch>& matches, Vec2d& error) 
 {
 	// Extract the camera matrix
 	Mat camera = _calibration->GetMatrix();
 
 	// Retrieve the scene points
-	auto scenePoints = vector<Point3f>(); scenePoints.clear();
-	GetScenePoints(_calibration, _frame->GetDepth(), matches, _keypoints, scenePoints);
+	_scenePoints.clear(); GetScenePoints(_calibration, _frame->GetDepth(), matches, _keypoints, _scenePoints);
 
 	// Retrieve the image points
-	auto imagePoints = vector<Point2f>(); imagePoints.clear();
-	GetImagePoints(keypoints_2, matches, imagePoints);
+	_imagePoints.clear(); GetImagePoints(keypoints_2, matches, _imagePoints);
 
 	// Filter the points so that they all have valid depth values
-	FilterBadDepth(scenePoints, imagePoints);
+	FilterBadDepth(_scenePoints, _imagePoints);
 
-	// Determine the pose value
-	Mat pose = EstimatePose(camera, scenePoints, imagePoints);
+	// Determine the pose value (and its reprojection error), unless it was cached for the same correspondences
+	auto key = (uint64_t)0; auto pose = SE3();
+	if (_cache != nullptr) 
+	{
+		key = StageCache::Hash(&_estimator->GetRansacIterations(), sizeof(int));
+		key = StageCache::Hash(_scenePoints.data(), _scenePoints.size() * sizeof(Point3f), key);
+		key = StageCache::Hash(_imagePoints.data(), _imagePoints.size() * sizeof(Point2f), key);
+		if (_cache->GetPose(key, pose, error)) return pose;
+	}
 
-	// Determine the reprojection value
-	EstimateError(camera, pose, scenePoints, imagePoints, error);
+	pose = _estimator->Estimate(camera, _scenePoints, _imagePoints, error);
+	if (_cache != nullptr) _cache->SetPose(key, pose, error);
 
 	// Return the pose result
 	return pose;
@@ -106,12 +138,23 @@ Mat FastTracker::FindPoseProcess(vector<KeyPoint>& keypoints_2, vector<FeatureMa
  * @param keypoints The list of associated key points
  * @param out The output scene points
  */
-void FastTracker::GetScenePoints(Calibration * calibration, Mat& depth, vector<FeatureMatch *>& matches, vector<KeyPoint>& keypoints, vector<Point3f>& out) 
+void FastTracker::GetScenePoints(Calibration * calibration, Mat& depth, vector<FeatureMatch>& matches, vector<KeyPoint>& keypoints, vector<Point3f>& out) 
 {
-	for (auto match : matches) 
+	_landmarkPoints = 0;
+
+	for (auto& match : matches) 
 	{
+		// Use the landmark of the track once it has settled, rather than lifting the keypoint again
+		auto landmark = _landmarks == nullptr ? nullptr : _landmarks->Find(_trackIds[match.GetFirstId()]);
+		if (landmark != nullptr && landmark->GetObservations() >= MIN_OBSERVATIONS) 
+		{
+			auto position = _worldPose.Transform(landmark->GetPosition());
+			out.push_back(Point3f((float)position.x, (float)position.y, (float)position.z)); _landmarkPoints++;
+			continue;
+		}
+
 		// Retrieve image points from the system
-		auto point = keypoints[match->GetFirstId()].pt;	
+		auto point = keypoints[match.GetFirstId()].pt;	
 
 		// Get the depth from the system
 		auto Z = ExtractDepth(depth, point);
@@ -134,11 +177,11 @@ void FastTracker::GetScenePoints(Calibration * calibration, Mat& depth, vector<F
  * @param matches The matches we are using in our system
  * @param out The list of output image points
  */
-void FastTracker::GetImagePoints(vector<KeyPoint>& keypoints, vector<FeatureMatch *>& matches, vector<Point2f>& out) 
+void FastTracker::GetImagePoints(vector<KeyPoint>& keypoints, vector<FeatureMatch>& matches, vector<Point2f>& out) 
 {
-	for (auto match : matches) 
+	for (auto& match : matches) 
 	{
-		auto point = keypoints[match->GetSecondId()];
+		auto& point = keypoints[match.GetSecondId()];
 		out.push_back(point.pt);
 	}
 }
@@ -153,122 +196,164 @@ void FastTracker::FilterBadDepth(vector<Point3f>& scenePoints, vector<Point2f>&
 	// Make sure that the incoming points are "kosher" 
 	assert(scenePoints.size() == imagePoints.size());
 
-	// Create a new container to hold the "validated" points
-	auto ascenePoints = vector<Point3f>(); auto aimagePoints = vector<Point2f>();
-
-	// Loop thru and validate the given points
+	// Compact the "validated" points to the front of the arrays
+	auto counter = 0;
 	for (auto i = 0; i < scenePoints.size(); i++) 
 	{
-		auto scenePoint = scenePoints[i]; auto imagePoint = imagePoints[i];
+		auto& scenePoint = scenePoints[i];
 
 		if (scenePoint.z > 300 && scenePoint.z < 2000) 
 		{
-			ascenePoints.push_back(scenePoint); aimagePoints.push_back(imagePoint);
+			scenePoints[counter] = scenePoint; imagePoints[counter] = imagePoints[i]; counter++;
 		}
 	}
 
-	// Clear the incoming points
-	scenePoints.clear(); imagePoints.clear();
+	// Drop the points that failed validation
+	scenePoints.resize(counter); imagePoints.resize(counter);
+}
 
-	// Copy the new values into the array
-	for (auto i = 0; i < ascenePoints.size(); i++) 
-	{
-		scenePoints.push_back(ascenePoints[i]);
-		imagePoints.push_back(aimagePoints[i]);
-	}
+//--------------------------------------------------
+// UpdateNextFrame
+//--------------------------------------------------
+
+/**
+ * @brief Add the logic to advance to the next frame
+ * @param frame The new frame that we are adding
+ * @param keypoints The key points that we are adding
+ * @param pose The final pose of the new frame relative to the previous one
+ * @param free Indicates whether we want to delete the value
+ */
+void FastTracker::UpdateNextFrame(NVLib::DepthFrame * frame, vector<KeyPoint>& keypoints, const SE3& pose, bool free) 
+{
+	// Carry the track ids across the matches (unmatched points start new tracks, or pick up an old landmark)
+	_nextTrackIds.assign(keypoints.size(), -1);
+	for (auto& match : _matches) _nextTrackIds[match.GetSecondId()] = _trackIds[match.GetFirstId()];
+	_worldPose = pose * _worldPose;
+	if (_landmarks != nullptr) UpdateLandmarks(frame->GetDepth(), keypoints);
+	for (auto& trackId : _nextTrackIds) if (trackId < 0) trackId = _nextTrackId++;
+	_trackIds.swap(_nextTrackIds);
+
+	// Perform Previous Updating
+	if (free) delete _frame; 
+	_frame = frame; 
+	_keypoints.clear(); 
+	for (auto& point : keypoints) _keypoints.push_back(point);
 }
 
 /**
- * @brief Perform the pose estimation logic
- * @param camera The given camera matrix
- * @param scenePoints The list of scene points
- * @param imagePoints The list of image points
- * @return Mat The pose that was estimated
+ * @brief Add the depth samples of the new reference to the landmark map. The carried tracks go first, so that
+ * they claim their landmarks before the new tracks look for an unobserved landmark to pick up
+ * @param depth The depth map of the new reference
+ * @param keypoints The keypoints of the new reference (their track ids are in _nextTrackIds)
  */
-Mat FastTracker::EstimatePose(Mat& camera, vector<Point3f>& scenePoints, vector<Point2f>& imagePoints) 
+void FastTracker::UpdateLandmarks(Mat& depth, vector<KeyPoint>& keypoints) 
 {
-	// Convert the scene points and image points to doubles
-	auto dscene = vector<Point3d>(); auto dimage = vector<Point2d>();
-	for (auto i = 0; i < scenePoints.size(); i++) 
+	auto toWorld = _worldPose.Inverse(); auto point = Point3d();
+
+	for (auto i = 0; i < (int)keypoints.size(); i++) 
 	{
-		dscene.push_back(Point3d(scenePoints[i].x, scenePoints[i].y, scenePoints[i].z)); 
-		dimage.push_back(Point2d(imagePoints[i].x, imagePoints[i].y));
+		if (_nextTrackIds[i] < 0 || !LiftPoint(depth, keypoints[i].pt, point)) continue;
+		_landmarks->Observe(_nextTrackIds[i], toWorld.Transform(point), point.z * LANDMARK_TOLERANCE);
 	}
 
-	// Perform the pose estimation
-	Mat nodistortion = Mat_<double>::zeros(4,1);
-	Vec3d rvec, tvec; solvePnPRansac(dscene, dimage, camera, nodistortion, rvec, tvec, false, 1e4, 10, 0.9, noArray(), SOLVEPNP_DLS);
+	for (auto i = 0; i < (int)keypoints.size(); i++) 
+	{
+		if (_nextTrackIds[i] >= 0 || !LiftPoint(depth, keypoints[i].pt, point)) continue;
+		auto position = toWorld.Transform(point);
+		auto landmark = _landmarks->FindUnseen(position, point.z * REACQUIRE_RADIUS);
+		_nextTrackIds[i] = landmark != nullptr ? landmark->GetId() : _nextTrackId++;
+		_landmarks->Observe(_nextTrackIds[i], position, point.z * LANDMARK_TOLERANCE);
+	}
 
-	// Return the result
-	return NVLib::PoseUtils::Vectors2Pose(rvec, tvec);
+	_landmarks->NextFrame();
 }
 
 /**
- * @brief Determine the reprojection error associated with the pose
- * @param camera The given camera matrix
- * @param pose The estimated pose
- * @param scenePoints The list of scene points
- * @param imagePoints The list of image points
- * @param error The error point that we are getting
+ * @brief Create a keyframe from the current frame, holding the tracked keypoints (and their depths)
+ * @param id The id of the keyframe (its index within the trajectory)
+ * @param odometry The camera to world pose of the frame, as given by the odometry
+ * @return Keyframe * The keyframe that was created (the caller takes ownership)
  */
-void FastTracker::EstimateError(Mat& camera, Mat& pose, vector<Point3f>& scenePoints, vector<Point2f>& imagePoints, Vec2d& error) 
+Keyframe * FastTracker::CreateKeyframe(int id, const SE3& odometry) 
 {
-	// Convert the scene points and image points to doubles
-	auto dscene = vector<Point3d>(); auto dimage = vector<Point2d>();
-	for (auto i = 0; i < scenePoints.size(); i++) 
+	auto observations = vector<Observation>(); observations.reserve(_keypoints.size());
+	for (auto i = 0; i < (int)_keypoints.size(); i++) 
 	{
-		dscene.push_back(Point3d(scenePoints[i].x, scenePoints[i].y, scenePoints[i].z)); 
-		dimage.push_back(Point2d(imagePoints[i].x, imagePoints[i].y));
+		auto& point = _keypoints[i].pt;
+		auto landmark = _landmarks == nullptr ? nullptr : _landmarks->Find(_trackIds[i]);
+		auto Z = landmark != nullptr && landmark->GetObservations() >= MIN_OBSERVATIONS ? _worldPose.Transform(landmark->GetPosition()).z : ExtractDepth(_frame->GetDepth(), point);
+		if (Z <= 300 || Z >= 2000) Z = 0;
+		observations.push_back(Observation(_trackIds[i], Point2d(point.x, point.y), Z));
 	}
-
-	// Convert the pose matrix to some vectors
-	auto rvec = Vec3d(); auto tvec = Vec3d(); NVLib::PoseUtils::Pose2Vectors(pose, rvec, tvec);
-
-	// Project 3D points to get "estimated points"
-	Mat nodistortion = Mat_<double>::zeros(4,1);
-	auto estimated = vector<Point2d>(); projectPoints(dscene, rvec, tvec, camera, nodistortion, estimated);
-
-	// Calculate the errors
-	auto errors = vector<double>();
-    for (auto i = 0; i < estimated.size(); i++) 
-    {
-        auto xDiff = dimage[i].x - estimated[i].x;
-        auto yDiff = dimage[i].y - estimated[i].y;
-        auto length = sqrt(xDiff * xDiff + yDiff * yDiff);
-		errors.push_back(length);
-    }
-
-	// Extract the error "summaries"
-	auto mean = Scalar(); auto stddev = Scalar();
-	cv::meanStdDev(errors, mean, stddev);
-	error[0] = mean[0]; error[1] = stddev[0];
+	return new Keyframe(id, odometry, observations);
 }
 
 //--------------------------------------------------
-// UpdateNextFrame
+// SetQuality
 //--------------------------------------------------
 
 /**
- * @brief Add the logic to advance to the next frame
- * @param frame The new frame that we are adding
- * @param keypoints The key points that we are adding
- * @param free Indicates whether we want to delete the value
+ * @brief Apply the quality settings that are relevant to tracking
+ * @param settings The settings that we are applying
  */
-void FastTracker::UpdateNextFrame(NVLib::DepthFrame * frame, vector<KeyPoint>& keypoints, bool free) 
+void FastTracker::SetQuality(QualitySettings& settings) 
 {
-	// Perform Previous Updating
-	if (free) delete _frame; _frame = frame; 
-	_keypoints.clear(); 
-	for (auto point : keypoints) _keypoints.push_back(point);
+	_detector->SetQuality(settings);
+	_estimator->GetRansacIterations() = settings.GetRansacIterations();
+
+	// The settings that the detection and matching depend on make up the key of their cache entries
+	int detection[3] = { settings.GetKeypointTarget(), settings.GetLKWindow(), settings.GetLKLevels() };
+	_matchKey = StageCache::Hash(detection, sizeof(detection));
+	_detectKey = GetDetectionKey(settings);
+}
+
+/**
+ * @brief Build the key of the settings that the detection alone depends on (which precomputed features must match)
+ * @param settings The quality settings
+ * @return uint64_t The key
+ */
+uint64_t FastTracker::GetDetectionKey(QualitySettings& settings) 
+{
+	int detection[2] = { BLOCK_SIZE, settings.GetKeypointTarget() };
+	return StageCache::Hash(detection, sizeof(detection));
 }
 
 //--------------------------------------------------
 // Utilities
 //--------------------------------------------------
 
+/**
+ * @brief Determine the time since the given start point, and reset the start point
+ * @param start The start point (updated to now)
+ * @return double The elapsed time in milliseconds
+ */
+double FastTracker::GetElapsed(chrono::steady_clock::time_point& start) 
+{
+	auto now = chrono::steady_clock::now();
+	auto elapsed = chrono::duration<double, milli>(now - start).count();
+	start = now; return elapsed;
+}
+
+/**
+ * @brief Lift a keypoint to a 3D point in the camera frame, using the depth at its nearest pixel
+ * @param depth The depth map (float or 16-bit millimetres)
+ * @param location The location of the keypoint
+ * @param out The 3D point
+ * @return true If the depth was within the valid range
+ */
+bool FastTracker::LiftPoint(Mat& depth, const Point2f& location, Point3d& out) 
+{
+	auto Z = (double)ExtractDepth(depth, location);
+	if (Z <= 300 || Z >= 2000) return false;
+
+	out.x = (location.x - _calibration->GetCenter().x) * (Z / _calibration->GetFocals()[0]);
+	out.y = (location.y - _calibration->GetCenter().y) * (Z / _calibration->GetFocals()[1]);
+	out.z = Z; return true;
+}
+
 /**
  * @brief Add the logic to extract depth from a given system
- * @param depth The depth value that we are extracting
+ * @param depth The depth map (float or 16-bit millimetres)
  * @param location The location of the depth value that we are extracting
  * @return float The depth value that we have gotten from the file
  */
@@ -276,8 +361,9 @@ float FastTracker::ExtractDepth(Mat& depth, const Point2f& location)
 {
 	auto x = (int)round(location.x); auto y = (int)round(location.y);
 	if (x < 0 || y < 0 || x >= depth.cols || y >= depth.rows) return 0;
-	auto data = (float *) depth.data; auto index = x + y * depth.cols;
-	return data[index];
+	auto index = x + y * depth.cols;
+	if (depth.depth() == CV_16U) return ((ushort *) depth.data)[index];
+	return ((float *) depth.data)[index];
 }
 
 /**
@@ -287,12 +373,12 @@ float FastTracker::ExtractDepth(Mat& depth, const Point2f& location)
  * @param keypoints_1 All the feature points for the first image
  * @param keypoints_2 All the feature points for the second image
  */
-void FastTracker::ShowMatchingPoints(NVLib::StereoFrame& frame, vector<FeatureMatch *>& matches, vector<KeyPoint>& keypoints_1, vector<KeyPoint>& keypoints_2) 
+void FastTracker::ShowMatchingPoints(NVLib::StereoFrame& frame, vector<FeatureMatch>& matches, vector<KeyPoint>& keypoints_1, vector<KeyPoint>& keypoints_2) 
 {
 	auto displayMatches = vector<NVLib::FeatureMatch>();
 	for (auto& match : matches) 
 	{	
-		auto id_1 = match->GetFirstId(); auto id_2 = match->GetSecondId();
+		auto id_1 = match.GetFirstId(); auto id_2 = match.GetSecondId();
 		auto m = NVLib::FeatureMatch(keypoints_1[id_1].pt, keypoints_2[id_2].pt);
 		displayMatches.push_back(m);
 	}
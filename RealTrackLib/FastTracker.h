@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <iostream>
 using namespace std;
 
@@ -19,8 +20,15 @@ using namespace cv;
 #include <NVLib/Model/DepthFrame.h>
 #include <NVLib/Model/StereoFrame.h>
 
+#include "SE3.h"
+#include "Keyframe.h"
 #include "Calibration.h"
 #include "FastDetector.h"
+#include "PoseEstimator.h"
+#include "StageCache.h"
+#include "FeatureFile.h"
+#include "LandmarkMap.h"
+#include "PerfCounters.h"
 
 namespace NVL_App
 {
@@ -30,26 +38,56 @@ namespace NVL_App
 		Calibration * _calibration;
 		NVLib::DepthFrame * _frame;
 		vector<KeyPoint> _keypoints;
+		vector<long> _trackIds;
+		vector<long> _nextTrackIds;
+		long _nextTrackId;
 		FastDetector * _detector;
+		PoseEstimator * _estimator;
+		Vec3d _timings;
+		StageCache * _cache;
+		uint64_t _matchKey;
+		FeatureFile * _features;
+		uint64_t _detectKey;
+		LandmarkMap * _landmarks;
+		SE3 _worldPose;
+		int _landmarkPoints;
+
+		vector<FeatureMatch> _matches;
+		vector<Point3f> _scenePoints;
+		vector<Point2f> _imagePoints;
 	public:
+		static constexpr int BLOCK_SIZE = 5;
+
 		FastTracker(Calibration * calibration, NVLib::DepthFrame * firstFrame);
 		~FastTracker();
 
-		Mat GetPose(NVLib::DepthFrame * frame, vector<KeyPoint>& keypoints, Vec2d& error);
+		SE3 GetPose(NVLib::DepthFrame * frame, vector<KeyPoint>& keypoints, Vec2d& error);
 
-		void UpdateNextFrame(NVLib::DepthFrame * frame, vector<KeyPoint>& keypoints, bool free);
+		void UpdateNextFrame(NVLib::DepthFrame * frame, vector<KeyPoint>& keypoints, const SE3& pose, bool free);
+		void SetQuality(QualitySettings& settings);
+		Keyframe * CreateKeyframe(int id, const SE3& odometry);
+		inline void ClearMatches() { _matches.clear(); }
+		inline void SetCache(StageCache * cache) { _cache = cache; }
+		inline void SetFeatures(FeatureFile * features) { _features = features; }
+		inline void SetLandmarks(LandmarkMap * landmarks) { _landmarks = landmarks; }
 
 		inline NVLib::DepthFrame *& GetFrame() { return _frame; }
 		inline vector<KeyPoint>& GetKeypoints() { return _keypoints; }
+		inline vector<long>& GetTrackIds() { return _trackIds; }
+		inline Vec3d& GetTimings() { return _timings; }
+		inline int GetLandmarkPoints() { return _landmarkPoints; }
+
+		static uint64_t GetDetectionKey(QualitySettings& settings);
 	private:
-		Mat FindPoseProcess(vector<KeyPoint>& keypoints_2, vector<FeatureMatch *>& matches, Vec2d& error);
-		void GetScenePoints(Calibration * calibration, Mat& depth, vector<FeatureMatch *>& matches, vector<KeyPoint>& keypoints, vector<Point3f>& out);
-		void GetImagePoints(vector<KeyPoint>& keypoints, vector<FeatureMatch *>& matches, vector<Point2f>& out);
+		SE3 FindPoseProcess(vector<KeyPoint>& keypoints_2, vector<FeatureMatch>& matches, Vec2d& error);
+		void GetScenePoints(Calibration * calibration, Mat& depth, vector<FeatureMatch>& matches, vector<KeyPoint>& keypoints, vector<Point3f>& out);
+		void GetImagePoints(vector<KeyPoint>& keypoints, vector<FeatureMatch>& matches, vector<Point2f>& out);
 		void FilterBadDepth(vector<Point3f>& scenePoints, vector<Point2f>& imagePoints);
-		Mat EstimatePose(Mat& camera, vector<Point3f>& scenePoints, vector<Point2f>& imagePoints);	
-		void EstimateError(Mat& camera, Mat& pose, vector<Point3f>& scenePoints, vector<Point2f>& imagePoints, Vec2d& error);
+		void UpdateLandmarks(Mat& depth, vector<KeyPoint>& keypoints);
+		bool LiftPoint(Mat& depth, const Point2f& location, Point3d& out);
 
 		float ExtractDepth(Mat& depth, const Point2f& location);
-		void ShowMatchingPoints(NVLib::StereoFrame& frame, vector<FeatureMatch *>& matches, vector<KeyPoint>& keypoints_1, vector<KeyPoint>& keypoints_2);
+		double GetElapsed(chrono::steady_clock::time_point& start);
+		void ShowMatchingPoints(NVLib::StereoFrame& frame, vector<FeatureMatch>& matches, vector<KeyPoint>& keypoints_1, vector<KeyPoint>& keypoints_2);
 	};
 }
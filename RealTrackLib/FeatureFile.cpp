@@ -0,0 +1,95 @@
+//--------------------------------------------------
+// Implementation of class FeatureFile
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "FeatureFile.h"
+using namespace NVL_App;
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor
+ * @param path The path to the feature file
+ */
+FeatureFile::FeatureFile(const string& path) : _frame(-1), _hits(0), _misses(0)
+{
+	auto handle = open(path.c_str(), O_RDONLY);
+	if (handle < 0) throw runtime_error("Unable to open file: " + path);
+
+	struct stat details; auto valid = fstat(handle, &details) == 0 && details.st_size >= (off_t)sizeof(FeatureHeader);
+	auto memory = valid ? mmap(nullptr, details.st_size, PROT_READ, MAP_SHARED, handle, 0) : MAP_FAILED;
+	close(handle);
+	if (memory == MAP_FAILED) throw runtime_error("Unable to map file: " + path);
+
+	_memory = (uchar *)memory; _bytes = details.st_size; _header = (FeatureHeader *)memory;
+	if (!FeatureFormat::IsValid(*_header) || _bytes < FeatureFormat::GetFileSize(*_header))
+	{
+		munmap(_memory, _bytes);
+		throw runtime_error("The file is not a valid feature file: " + path);
+	}
+	_index = (FeatureEntry *)(_memory + _header->IndexOffset);
+}
+
+/**
+ * @brief Main Terminator
+ */
+FeatureFile::~FeatureFile()
+{
+	munmap(_memory, _bytes);
+}
+
+//--------------------------------------------------
+// Retrieval
+//--------------------------------------------------
+
+/**
+ * @brief Select the frame that the following lookups are for
+ * @param frame The index of the frame within the sequence
+ */
+void FeatureFile::Begin(int frame)
+{
+	_frame = frame;
+}
+
+/**
+ * @brief Retrieve the keypoints of the current frame (appended to the list, as the detector would)
+ * @param key The hash of the current detection settings (which has to match the one that the file was built with)
+ * @param keypoints The list that the keypoints are added to
+ * @return true If the keypoints were found
+ */
+bool FeatureFile::GetKeypoints(uint64_t key, vector<KeyPoint>& keypoints)
+{
+	if (key != _header->Key || _frame < 0 || _frame >= (int)_header->FrameCount || _index[_frame].Written == 0) { _misses++; return false; }
+
+	auto& entry = _index[_frame]; auto first = (KeyPoint *)(_memory + entry.Offset);
+	keypoints.insert(keypoints.end(), first, first + entry.Count);
+	_hits++;
+
+	return true;
+}
+
+/**
+ * @brief Determine whether a file exists that was built for the sequence with the given settings
+ * @param path The path to the feature file
+ * @param key The hash of the detection settings
+ * @param source The hash of the sequence
+ * @param size The resolution that the detection runs at
+ * @param frameCount The number of frames within the sequence
+ * @return true If the file can be used as it is
+ */
+bool FeatureFile::IsCurrent(const string& path, uint64_t key, uint64_t source, const Size& size, int frameCount)
+{
+	auto reader = ifstream(path, ios::binary);
+	if (!reader.is_open()) return false;
+
+	auto header = FeatureHeader(); reader.read((char *)&header, sizeof(FeatureHeader));
+	if (!reader || !FeatureFormat::IsValid(header)) return false;
+
+	return header.Key == key && header.Source == source && (int)header.Width == size.width && (int)header.Height == size.height && (int)header.FrameCount >= frameCount;
+}
@@ -0,0 +1,52 @@
+//--------------------------------------------------
+// Read access to a precomputed feature file (see FeatureFormat). The file is memory mapped, so a frame's keypoints 
+// are copied straight out of the page cache and nothing is read up front
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <fstream>
+#include <iostream>
+using namespace std;
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include "FeatureFormat.h"
+
+namespace NVL_App
+{
+	class FeatureFile
+	{
+	private:
+		uchar * _memory;
+		size_t _bytes;
+		FeatureHeader * _header;
+		FeatureEntry * _index;
+		int _frame;
+		int _hits;
+		int _misses;
+	public:
+		FeatureFile(const string& path);
+		~FeatureFile();
+
+		void Begin(int frame);
+		bool GetKeypoints(uint64_t key, vector<KeyPoint>& keypoints);
+
+		inline int GetFrameCount() { return (int)_header->FrameCount; }
+		inline Size GetSize() { return Size(_header->Width, _header->Height); }
+		inline int GetHits() { return _hits; }
+		inline int GetMisses() { return _misses; }
+
+		static bool IsCurrent(const string& path, uint64_t key, uint64_t source, const Size& size, int frameCount);
+	};
+}
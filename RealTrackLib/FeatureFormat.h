@@ -0,0 +1,72 @@
+//--------------------------------------------------
+// Describes the layout of a precomputed feature file
+//
+// A feature file is a FeatureHeader, followed by the keypoints of each frame (stored back to back as raw KeyPoint 
+// records) and then an index of FrameCount FeatureEntry records, which gives where the keypoints of each frame 
+// start and how many there are. The index goes at the end so that the file can be written in a single pass. The 
+// key is a hash of the settings that the detection depends on, and the source is a hash of the sequence that the 
+// file was built from (see Odometry::GetSequence), so a file that was built with other settings or frames is not used
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+namespace NVL_App
+{
+	struct FeatureHeader
+	{
+		char Magic[4];
+		uint32_t Version;
+		uint64_t Key;
+		uint64_t Source;
+		uint32_t Width;
+		uint32_t Height;
+		uint32_t FrameCount;
+		uint32_t KeypointSize;
+		uint64_t IndexOffset;
+	};
+
+	struct FeatureEntry
+	{
+		uint64_t Offset;
+		uint32_t Count;
+		uint32_t Written;
+	};
+
+	class FeatureFormat
+	{
+	public:
+		static constexpr uint32_t VERSION = 2;
+
+		/**
+		 * @brief Determine whether the header is one that we know how to read
+		 * @param header The header that we are validating
+		 * @return true If the header is valid
+		 */
+		static inline bool IsValid(const FeatureHeader& header) 
+		{
+			return header.Magic[0] == 'R' && header.Magic[1] == 'T' && header.Magic[2] == 'F' && header.Magic[3] == 'T' && 
+				header.Version == VERSION && header.KeypointSize == sizeof(KeyPoint);
+		}
+
+		/**
+		 * @brief Determine the size of a complete file
+		 * @param header The header describing the file
+		 * @return size_t The size of the file in bytes
+		 */
+		static inline size_t GetFileSize(const FeatureHeader& header) 
+		{
+			return header.IndexOffset + (size_t)header.FrameCount * sizeof(FeatureEntry);
+		}
+	};
+}
@@ -0,0 +1,76 @@
+//--------------------------------------------------
+// Implementation of class FeatureWriter
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "FeatureWriter.h"
+using namespace NVL_App;
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor
+ * @param path The path to the file that we are writing
+ * @param key The hash of the settings that the detection depends on
+ * @param source The hash of the sequence that the keypoints were detected in
+ * @param size The resolution of the images that the keypoints were detected in
+ */
+FeatureWriter::FeatureWriter(const string& path, uint64_t key, uint64_t source, const Size& size) : _offset(sizeof(FeatureHeader))
+{
+	_writer.open(path, ios::binary | ios::trunc);
+	if (!_writer.is_open()) throw runtime_error("Unable to open file: " + path);
+
+	_header = FeatureHeader();
+	_header.Magic[0] = 'R'; _header.Magic[1] = 'T'; _header.Magic[2] = 'F'; _header.Magic[3] = 'T';
+	_header.Version = FeatureFormat::VERSION; _header.Key = key; _header.Source = source;
+	_header.Width = size.width; _header.Height = size.height;
+	_header.FrameCount = 0; _header.KeypointSize = sizeof(KeyPoint); _header.IndexOffset = 0;
+
+	_writer.write((char *)&_header, sizeof(FeatureHeader));
+}
+
+/**
+ * @brief Main Terminator
+ */
+FeatureWriter::~FeatureWriter()
+{
+	Close();
+}
+
+//--------------------------------------------------
+// Write
+//--------------------------------------------------
+
+/**
+ * @brief Append the keypoints of a frame (frames that are skipped are marked as missing)
+ * @param frame The index of the frame within the sequence
+ * @param keypoints The keypoints that were detected within the frame
+ */
+void FeatureWriter::Write(int frame, vector<KeyPoint>& keypoints)
+{
+	if (frame < (int)_index.size()) throw runtime_error("Feature file frames must be written in order");
+	_index.resize(frame + 1, FeatureEntry());
+
+	auto& entry = _index[frame]; entry.Offset = _offset; entry.Count = (uint32_t)keypoints.size(); entry.Written = 1;
+	_writer.write((char *)keypoints.data(), keypoints.size() * sizeof(KeyPoint));
+	_offset += keypoints.size() * sizeof(KeyPoint);
+}
+
+/**
+ * @brief Append the index, patch the header and close the file
+ */
+void FeatureWriter::Close()
+{
+	if (!_writer.is_open()) return;
+
+	_header.FrameCount = (uint32_t)_index.size(); _header.IndexOffset = _offset;
+	_writer.write((char *)_index.data(), _index.size() * sizeof(FeatureEntry));
+	_writer.seekp(0, ios::beg);
+	_writer.write((char *)&_header, sizeof(FeatureHeader));
+	_writer.close();
+}
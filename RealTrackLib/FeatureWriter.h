@@ -0,0 +1,38 @@
+//--------------------------------------------------
+// Writes the keypoints of a sequence to a precomputed feature file
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <fstream>
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include "FeatureFormat.h"
+
+namespace NVL_App
+{
+	class FeatureWriter
+	{
+	private:
+		ofstream _writer;
+		FeatureHeader _header;
+		vector<FeatureEntry> _index;
+		uint64_t _offset;
+	public:
+		FeatureWriter(const string& path, uint64_t key, uint64_t source, const Size& size);
+		~FeatureWriter();
+
+		void Write(int frame, vector<KeyPoint>& keypoints);
+		void Close();
+
+		inline int GetFrameCount() { return (int)_index.size(); }
+	};
+}
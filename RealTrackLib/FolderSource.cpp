@@ -0,0 +1,71 @@
+//--------------------------------------------------
+// Implementation of class FolderSource
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "FolderSource.h"
+using namespace NVL_App;
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor
+ * @param folder The folder that holds the color_XXXX.png and depth_XXXX.tiff images
+ * @param imageCount The number of frames within the folder
+ * @param frameRate The rate at which the frames were recorded (used to generate the timestamps)
+ * @param poolSize The number of frame buffers that we allocate up front
+ * @param depthType The depth type that the frames hold (the images on disk are converted to it when loaded)
+ */
+FolderSource::FolderSource(const string& folder, int imageCount, double frameRate, int poolSize, int depthType) : _folder(folder), _imageCount(imageCount), _frameRate(frameRate), _next(0)
+{
+	if (frameRate <= 0) throw runtime_error("The frame rate for a folder source must be positive");
+
+	// Size the pool from the first frame within the sequence
+	auto frame = LoadUtils::LoadFrame(folder, 0);
+	_pool = new FramePool(frame->GetColor().size(), poolSize, depthType);
+	_pool->Release(frame);
+}
+
+/**
+ * @brief Main Terminator
+ */
+FolderSource::~FolderSource()
+{
+	delete _pool;
+}
+
+//--------------------------------------------------
+// Frame Retrieval
+//--------------------------------------------------
+
+/**
+ * @brief Load the next frame from the folder
+ * @param output The frame that was loaded
+ * @return true If a frame was loaded
+ * @return false If we have run out of frames
+ */
+bool FolderSource::Next(SourceFrame& output)
+{
+	if (_next >= _imageCount) return false;
+
+	auto frame = _pool->Acquire();
+	LoadUtils::LoadFrame(_folder, _next, frame, _buffer, _depthBuffer);
+	output = SourceFrame(_next, _next / _frameRate, frame);
+	_next++;
+
+	return true;
+}
+
+/**
+ * @brief Hand the frame back to the pool
+ * @param frame The frame that we are releasing
+ */
+void FolderSource::Release(NVLib::DepthFrame * frame)
+{
+	_pool->Release(frame);
+}
@@ -0,0 +1,43 @@
+//--------------------------------------------------
+// A frame source that reads the numbered color/depth images from a folder
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include "FramePool.h"
+#include "FrameSource.h"
+#include "LoadUtils.h"
+
+namespace NVL_App
+{
+	class FolderSource : public FrameSource
+	{
+	private:
+		string _folder;
+		int _imageCount;
+		double _frameRate;
+		int _next;
+		FramePool * _pool;
+		vector<uchar> _buffer;
+		Mat _depthBuffer;
+	public:
+		FolderSource(const string& folder, int imageCount, double frameRate, int poolSize, int depthType);
+		~FolderSource();
+
+		bool Next(SourceFrame& output) override;
+		void Release(NVLib::DepthFrame * frame) override;
+
+		inline Size GetSize() override { return _pool->GetSize(); }
+		inline int GetFrameCount() override { return _imageCount; }
+	};
+}
@@ -0,0 +1,80 @@
+//--------------------------------------------------
+// Implementation of class FramePool
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "FramePool.h"
+using namespace NVL_App;
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor
+ * @param size The resolution of the frames that the pool holds
+ * @param capacity The number of frames that we allocate up front
+ * @param depthType The OpenCV type of the depth maps (CV_32FC1 or CV_16UC1 millimetres)
+ */
+FramePool::FramePool(const Size& size, int capacity, int depthType) : _size(size), _depthType(depthType), _allocated(0)
+{
+	_free.reserve(capacity * 2);
+	for (auto i = 0; i < capacity; i++) _free.push_back(CreateFrame());
+}
+
+/**
+ * @brief Main Terminator
+ */
+FramePool::~FramePool()
+{
+	for (auto frame : _free) delete frame;
+}
+
+//--------------------------------------------------
+// Acquire and Release
+//--------------------------------------------------
+
+/**
+ * @brief Retrieve a frame from the pool (only allocates when the pool has run dry). Safe to call across threads
+ * @return NVLib::DepthFrame * The frame that the caller now owns until it is released
+ */
+NVLib::DepthFrame * FramePool::Acquire()
+{
+	lock_guard<mutex> guard(_lock);
+	if (_free.empty()) return CreateFrame();
+	auto frame = _free.back(); _free.pop_back();
+	return frame;
+}
+
+/**
+ * @brief Hand a frame back to the pool for reuse
+ * @param frame The frame that we are returning
+ */
+void FramePool::Release(NVLib::DepthFrame * frame)
+{
+	if (frame == nullptr) return;
+
+	// Frames that do not match the pool layout are not worth keeping
+	if (frame->GetColor().size() != _size || frame->GetDepth().size() != _size || frame->GetDepth().type() != _depthType) { delete frame; return; }
+
+	lock_guard<mutex> guard(_lock);
+	_free.push_back(frame);
+}
+
+//--------------------------------------------------
+// Helpers
+//--------------------------------------------------
+
+/**
+ * @brief Allocate a new frame with the buffers matching the pool resolution
+ * @return NVLib::DepthFrame * The frame that was created
+ */
+NVLib::DepthFrame * FramePool::CreateFrame()
+{
+	Mat color = Mat_<Vec3b>(_size); Mat depth = Mat::zeros(_size, _depthType);
+	_allocated++;
+	return new NVLib::DepthFrame(color, depth);
+}
@@ -0,0 +1,44 @@
+//--------------------------------------------------
+// A recycling pool of depth frames, so that the tracking loop does not hit the allocator
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <mutex>
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include <NVLib/Model/DepthFrame.h>
+
+namespace NVL_App
+{
+	class FramePool
+	{
+	private:
+		Size _size;
+		int _depthType;
+		int _allocated;
+		vector<NVLib::DepthFrame *> _free;
+		mutex _lock;
+	public:
+		FramePool(const Size& size, int capacity, int depthType);
+		~FramePool();
+
+		NVLib::DepthFrame * Acquire();
+		void Release(NVLib::DepthFrame * frame);
+
+		inline Size& GetSize() { return _size; }
+		inline int GetDepthType() { return _depthType; }
+		inline int GetAllocated() { return _allocated; }
+		inline int GetAvailable() { lock_guard<mutex> guard(_lock); return (int)_free.size(); }
+	private:
+		NVLib::DepthFrame * CreateFrame();
+	};
+}
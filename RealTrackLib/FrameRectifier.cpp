@@ -0,0 +1,146 @@
+//--------------------------------------------------
+// Implementation of class FrameRectifier
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "FrameRectifier.h"
+using namespace NVL_App;
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor: builds the lookup tables for the session
+ * @param calibration The calibration of the sequence
+ * @param size The resolution of the color frames
+ */
+FrameRectifier::FrameRectifier(Calibration * calibration, const Size& size) : _size(size), _undistort(false), _register(false)
+{
+	_camera = calibration->GetMatrix();
+
+	// The undistorted frames keep the color camera matrix, so the calibration still describes them
+	if (calibration->HasDistortion())
+	{
+		Mat mapX, mapY; initUndistortRectifyMap(_camera, calibration->GetDistortion(), Mat(), _camera, size, CV_32FC1, mapX, mapY);
+		convertMaps(mapX, mapY, _colorMap, _colorWeights, CV_16SC2, false);
+		convertMaps(mapX, mapY, _depthMap, noArray(), CV_16SC2, true);
+		_undistort = true;
+	}
+
+	if (calibration->HasDepthCamera())
+	{
+		_depthCamera = calibration->GetDepthCamera(); _depthDistortion = calibration->GetDepthDistortion();
+
+		auto pose = (double *)calibration->GetDepthPose().data;
+		for (auto row = 0; row < 3; row++) 
+		{
+			for (auto column = 0; column < 3; column++) _rotation[row * 3 + column] = pose[row * 4 + column];
+			_translation[row] = pose[row * 4 + 3];
+		}
+		_register = true;
+	}
+}
+
+//--------------------------------------------------
+// Apply
+//--------------------------------------------------
+
+/**
+ * @brief Correct a frame in place. The corrections are written through scratch buffers and copied back, since the
+ * frame buffers may be views that the source owns (e.g. the slots of a shared ring). The registered depth is always
+ * at the color resolution, so a depth camera with another resolution can not be copied back into its buffer: the
+ * frame's depth is then reallocated on every frame (which only a folder source can deliver, since the packed and
+ * shared formats store the depth at the color resolution)
+ * @param frame The frame that we are correcting
+ */
+void FrameRectifier::Apply(NVLib::DepthFrame * frame)
+{
+	auto perf = PerfScope("rectify");
+	auto& color = frame->GetColor(); auto& depth = frame->GetDepth();
+
+	if (_undistort)
+	{
+		remap(color, _color, _colorMap, _colorWeights, INTER_LINEAR, BORDER_CONSTANT);
+		_color.copyTo(color);
+	}
+
+	if (_register)
+	{
+		if (depth.depth() == CV_16U) Register<ushort>(depth, _depth); else Register<float>(depth, _depth);
+		_depth.copyTo(depth);
+	}
+	else if (_undistort)
+	{
+		remap(depth, _depth, _depthMap, noArray(), INTER_NEAREST, BORDER_CONSTANT);
+		_depth.copyTo(depth);
+	}
+}
+
+/**
+ * @brief Forward project a depth map from the depth camera into the (undistorted) color camera. Where several 
+ * depth pixels land on the same color pixel the nearest one wins, and the color pixels that none land on are holes
+ * @param depth The depth map of the depth camera
+ * @param output The depth map of the color camera (in the same format)
+ */
+template <typename T> void FrameRectifier::Register(Mat& depth, Mat& output)
+{
+	if (depth.size() != _raySize) BuildRays(depth.size());
+
+	output.create(_size, depth.type()); output.setTo(0);
+	auto input = (T *)depth.data; auto result = (T *)output.data;
+
+	auto camera = (double *)_camera.data;
+	auto fx = camera[0]; auto fy = camera[4]; auto cx = camera[2]; auto cy = camera[5];
+	auto R = _rotation; auto t = _translation;
+
+	for (auto i = 0; i < (int)depth.total(); i++)
+	{
+		auto z = (double)input[i]; if (z <= 0) continue;
+		auto x = _rays[i * 2 + 0] * z; auto y = _rays[i * 2 + 1] * z;
+
+		auto X = R[0] * x + R[1] * y + R[2] * z + t[0];
+		auto Y = R[3] * x + R[4] * y + R[5] * z + t[1];
+		auto Z = R[6] * x + R[7] * y + R[8] * z + t[2];
+		if (Z <= 0) continue;
+
+		auto u = (int)lround(fx * X / Z + cx); auto v = (int)lround(fy * Y / Z + cy);
+		if (u < 0 || v < 0 || u >= _size.width || v >= _size.height) continue;
+
+		auto& target = result[u + v * _size.width]; auto value = saturate_cast<T>(Z);
+		if (target == 0 || value < target) target = value;
+	}
+}
+
+//--------------------------------------------------
+// Helpers
+//--------------------------------------------------
+
+/**
+ * @brief Build the table of undistorted (normalized) rays for each pixel of the depth camera
+ * @param size The resolution of the depth frames
+ */
+void FrameRectifier::BuildRays(const Size& size)
+{
+	auto pixels = vector<Point2f>();
+	for (auto row = 0; row < size.height; row++) for (auto column = 0; column < size.width; column++) pixels.push_back(Point2f(column, row));
+
+	auto rays = vector<Point2f>(); undistortPoints(pixels, rays, _depthCamera, _depthDistortion);
+
+	_rays.resize(rays.size() * 2);
+	for (auto i = 0; i < (int)rays.size(); i++) { _rays[i * 2 + 0] = rays[i].x; _rays[i * 2 + 1] = rays[i].y; }
+	_raySize = size;
+}
+
+/**
+ * @brief Determine whether a calibration calls for any correction of the frames
+ * @param calibration The calibration of the sequence
+ * @return true If the frames need undistorting or registering
+ */
+bool FrameRectifier::IsNeeded(Calibration * calibration)
+{
+	return calibration->HasDistortion() || calibration->HasDepthCamera();
+}
@@ -0,0 +1,61 @@
+//--------------------------------------------------
+// Corrects the raw frames of a sequence for lens distortion (and registers the depth to the color camera when they
+// are separate), using lookup tables that are built once from the calibration.
+//
+// The color is undistorted through fixed point remap tables and the depth through nearest neighbour tables (since
+// interpolating across depth edges invents surfaces). Depth from a separate camera is instead forward projected into
+// the undistorted color camera, through a table of the undistorted rays of the depth pixels and a depth test. The
+// corrected frames are pinhole images of the color camera, so the rest of the pipeline needs no distortion model
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include <NVLib/Model/DepthFrame.h>
+
+#include "Calibration.h"
+#include "PerfCounters.h"
+
+namespace NVL_App
+{
+	class FrameRectifier
+	{
+	private:
+		Size _size;
+		Mat _camera;
+		bool _undistort;
+		bool _register;
+
+		Mat _colorMap;
+		Mat _colorWeights;
+		Mat _depthMap;
+
+		Mat _depthCamera;
+		Mat _depthDistortion;
+		double _rotation[9];
+		double _translation[3];
+		Size _raySize;
+		vector<float> _rays;
+
+		Mat _color;
+		Mat _depth;
+	public:
+		FrameRectifier(Calibration * calibration, const Size& size);
+
+		void Apply(NVLib::DepthFrame * frame);
+
+		static bool IsNeeded(Calibration * calibration);
+	private:
+		void BuildRays(const Size& size);
+		template <typename T> void Register(Mat& depth, Mat& output);
+	};
+}
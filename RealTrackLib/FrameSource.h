@@ -0,0 +1,63 @@
+//--------------------------------------------------
+// The common interface for anything that supplies frames to the tracker
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <chrono>
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include <NVLib/Model/DepthFrame.h>
+
+namespace NVL_App
+{
+	class SourceFrame
+	{
+	private:
+		int _index;
+		double _timestamp;
+		chrono::steady_clock::time_point _arrival;
+		NVLib::DepthFrame * _frame;
+	public:
+		SourceFrame() : _index(-1), _timestamp(0), _frame(nullptr) {}
+		SourceFrame(int index, double timestamp, NVLib::DepthFrame * frame) :
+			_index(index), _timestamp(timestamp), _arrival(chrono::steady_clock::now()), _frame(frame) {}
+
+		inline int& GetIndex() { return _index; }
+		inline double& GetTimestamp() { return _timestamp; }
+		inline chrono::steady_clock::time_point& GetArrival() { return _arrival; }
+		inline NVLib::DepthFrame *& GetFrame() { return _frame; }
+	};
+
+	class FrameSource
+	{
+	public:
+		virtual ~FrameSource() {}
+
+		/**
+		 * @brief Retrieve the next frame within the sequence (blocks until one is available)
+		 * @param output The frame that was retrieved (must be handed back through Release)
+		 * @return true If a frame was retrieved
+		 * @return false If the sequence has ended
+		 */
+		virtual bool Next(SourceFrame& output) = 0;
+
+		/**
+		 * @brief Hand a frame back to the source once the caller is done with it
+		 * @param frame The frame that we are releasing
+		 */
+		virtual void Release(NVLib::DepthFrame * frame) = 0;
+
+		virtual Size GetSize() = 0;
+		virtual int GetFrameCount() = 0;
+		virtual int GetDropped() { return 0; }
+	};
+}
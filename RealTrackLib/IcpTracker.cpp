@@ -0,0 +1,403 @@
+//--------------------------------------------------
+// Implementation of class IcpTracker
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "IcpTracker.h"
+using namespace NVL_App;
+
+// The valid depth range (mm), the association gates and the acceptance thresholds
+#define MIN_DEPTH 300.0f
+#define MAX_DEPTH 2500.0f
+#define MAX_DISTANCE 100.0f
+#define MIN_NORMAL_DOT 0.8f
+#define MIN_POINTS 64
+#define MIN_INLIER_RATIO 0.3
+#define MAX_ERROR 10.0
+
+// The layout of a reduction: the upper triangle of J^T J (21), J^T r (6), the count and the squared error
+#define SUM_SIZE 29
+
+// The number of term columns packed for each row (J0..J5 and r)
+#define TERM_SIZE 7
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor
+ * @param calibration The calibration of the camera
+ * @param size The size of the depth maps
+ * @param iterations The number of iterations at each pyramid level (coarsest first), which also sets the level count
+ * @param threads The number of threads used for the reductions (0 for one per hardware thread)
+ */
+IcpTracker::IcpTracker(Calibration * calibration, const Size& size, vector<int>& iterations, int threads) : _iterations(iterations), _validCount(0), _error(0), _inlierRatio(0)
+{
+	if (iterations.empty()) throw runtime_error("The ICP iteration schedule must have at least one level");
+
+	auto& focals = calibration->GetFocals(); auto& center = calibration->GetCenter();
+	auto levelSize = size; auto scale = 1.0;
+	for (auto i = 0; i < (int)iterations.size(); i++)
+	{
+		auto intrinsics = Vec4d(focals[0] * scale, focals[1] * scale, (center.x + 0.5) * scale - 0.5, (center.y + 0.5) * scale - 0.5);
+		_reference.push_back(new IcpLevel(levelSize, intrinsics)); _current.push_back(new IcpLevel(levelSize, intrinsics));
+		levelSize = Size(levelSize.width / 2, levelSize.height / 2); scale *= 0.5;
+	}
+
+	_pool = new ThreadPool(threads);
+	_bands = _pool->GetThreadCount() * 2; _bandSums.resize(_bands * SUM_SIZE); _bandTerms.resize(_bands * TERM_SIZE * size.width);
+}
+
+/**
+ * @brief Main Terminator
+ */
+IcpTracker::~IcpTracker()
+{
+	delete _pool;
+	for (auto level : _reference) delete level;
+	for (auto level : _current) delete level;
+}
+
+//--------------------------------------------------
+// Frames
+//--------------------------------------------------
+
+/**
+ * @brief Build the vertex and normal pyramid of a new depth map (millimetres, float or 16-bit)
+ * @param depth The depth map
+ */
+void IcpTracker::SetFrame(Mat& depth)
+{
+	auto& z = _current[0]->GetZ();
+	depth.convertTo(z, CV_32F);
+
+	auto data = (float *)z.data; auto count = (int)z.total(); auto valid = 0;
+	for (auto i = 0; i < count; i++)
+	{
+		auto inside = data[i] > MIN_DEPTH && data[i] < MAX_DEPTH;
+		data[i] = inside ? data[i] : 0.0f; valid += inside;
+	}
+	_validCount = valid;
+
+	BuildLevel(_current[0]);
+	for (auto i = 1; i < (int)_current.size(); i++) { Downsample(_current[i - 1], _current[i]); BuildLevel(_current[i]); }
+}
+
+/**
+ * @brief Make the current frame the reference for the next one
+ */
+void IcpTracker::Accept()
+{
+	_reference.swap(_current);
+}
+
+//--------------------------------------------------
+// Track
+//--------------------------------------------------
+
+/**
+ * @brief Align the current frame to the reference, from the coarsest level to the finest
+ * @param pose The pose that maps the reference camera into the current camera (only written on success)
+ * @return true If the alignment converged with enough inliers and a small enough error
+ * @return false If the tracking failed
+ */
+bool IcpTracker::Track(SE3& pose)
+{
+	auto estimate = SE3(); _error = 0; _inlierRatio = 0;
+
+	for (auto level = (int)_iterations.size() - 1; level >= 0; level--)
+	{
+		for (auto iteration = 0; iteration < _iterations[_iterations.size() - 1 - level]; iteration++)
+		{
+			Reduce(level, estimate);
+			if (_sums[27] < MIN_POINTS) return false;
+			if (level == 0) { _error = sqrt(_sums[28] / _sums[27]); _inlierRatio = _sums[27] / max(_validCount, 1.0); }
+
+			auto delta = Vec6d(); if (!Solve(_sums, delta)) return false;
+			estimate = SE3::Exp(delta) * estimate;
+
+			auto rotation = sqrt(delta[0] * delta[0] + delta[1] * delta[1] + delta[2] * delta[2]);
+			auto translation = sqrt(delta[3] * delta[3] + delta[4] * delta[4] + delta[5] * delta[5]);
+			if (rotation < 1e-4 && translation < 1e-1) break;
+		}
+	}
+
+	if (_inlierRatio < MIN_INLIER_RATIO || _error > MAX_ERROR) return false;
+
+	// The estimate maps the current camera into the reference camera
+	pose = estimate.Inverse();
+	return true;
+}
+
+//--------------------------------------------------
+// Pyramid
+//--------------------------------------------------
+
+/**
+ * @brief Fill in the vertices and normals of a level from its depth
+ * @param level The level that we are building
+ */
+void IcpTracker::BuildLevel(IcpLevel * level)
+{
+	auto& intrinsics = level->GetIntrinsics(); auto rows = level->GetZ().rows; auto cols = level->GetZ().cols;
+	auto ifx = (float)(1.0 / intrinsics[0]); auto ify = (float)(1.0 / intrinsics[1]); auto cx = (float)intrinsics[2]; auto cy = (float)intrinsics[3];
+
+	for (auto row = 0; row < rows; row++)
+	{
+		auto z = (float *)level->GetZ().data + row * cols; auto x = (float *)level->GetX().data + row * cols; auto y = (float *)level->GetY().data + row * cols;
+		auto ry = (row - cy) * ify;
+		for (auto column = 0; column < cols; column++) { x[column] = (column - cx) * ifx * z[column]; y[column] = ry * z[column]; }
+	}
+
+	ComputeNormals(level);
+}
+
+/**
+ * @brief Halve the resolution of a level, averaging the valid depths in each 2x2 block
+ * @param input The finer level
+ * @param output The coarser level
+ */
+void IcpTracker::Downsample(IcpLevel * input, IcpLevel * output)
+{
+	auto inputCols = input->GetZ().cols; auto rows = output->GetZ().rows; auto cols = output->GetZ().cols;
+
+	for (auto row = 0; row < rows; row++)
+	{
+		auto top = (float *)input->GetZ().data + (2 * row) * inputCols; auto bottom = top + inputCols;
+		auto out = (float *)output->GetZ().data + row * cols;
+		for (auto column = 0; column < cols; column++)
+		{
+			auto a = top[2 * column], b = top[2 * column + 1], c = bottom[2 * column], d = bottom[2 * column + 1];
+			auto count = (float)((a > 0) + (b > 0) + (c > 0) + (d > 0));
+			out[column] = count > 0 ? (a + b + c + d) / count : 0.0f;
+		}
+	}
+}
+
+/**
+ * @brief Compute the normals from the cross product of the neighbouring vertices. The loop is branch free (an
+ * invalid neighbour zeroes the normal through a mask), so that the compiler can vectorize it
+ * @param level The level that we are computing normals for
+ */
+void IcpTracker::ComputeNormals(IcpLevel * level)
+{
+	auto rows = level->GetZ().rows; auto cols = level->GetZ().cols;
+	auto X = (float *)level->GetX().data; auto Y = (float *)level->GetY().data; auto Z = (float *)level->GetZ().data;
+	auto NX = (float *)level->GetNX().data; auto NY = (float *)level->GetNY().data; auto NZ = (float *)level->GetNZ().data;
+
+	for (auto row = 0; row < rows - 1; row++)
+	{
+		auto offset = row * cols;
+		for (auto column = 0; column < cols - 1; column++)
+		{
+			auto i = offset + column; auto right = i + 1; auto down = i + cols;
+
+			auto dxx = X[right] - X[i], dxy = Y[right] - Y[i], dxz = Z[right] - Z[i];
+			auto dyx = X[down] - X[i], dyy = Y[down] - Y[i], dyz = Z[down] - Z[i];
+
+			// down x right points back towards the camera
+			auto nx = dyy * dxz - dyz * dxy;
+			auto ny = dyz * dxx - dyx * dxz;
+			auto nz = dyx * dxy - dyy * dxx;
+
+			auto mask = (float)((Z[i] > 0) & (Z[right] > 0) & (Z[down] > 0));
+			auto scale = mask / sqrt(nx * nx + ny * ny + nz * nz + 1e-12f);
+			NX[i] = nx * scale; NY[i] = ny * scale; NZ[i] = nz * scale;
+		}
+		NX[offset + cols - 1] = NY[offset + cols - 1] = NZ[offset + cols - 1] = 0;
+	}
+
+	auto last = (rows - 1) * cols;
+	for (auto column = 0; column < cols; column++) NX[last + column] = NY[last + column] = NZ[last + column] = 0;
+}
+
+//--------------------------------------------------
+// Reduction
+//--------------------------------------------------
+
+/**
+ * @brief Build the normal equations for a level, reducing bands of rows in parallel
+ * @param level The level that we are reducing
+ * @param pose The current estimate (current camera to reference camera)
+ */
+void IcpTracker::Reduce(int level, const SE3& pose)
+{
+	auto rows = _current[level]->GetZ().rows; auto termStride = _bandTerms.size() / _bands;
+	fill(_bandSums.begin(), _bandSums.end(), 0.0);
+
+	auto bandRows = (rows + _bands - 1) / _bands;
+	for (auto band = 0; band < _bands; band++)
+	{
+		auto startRow = band * bandRows; auto endRow = min(startRow + bandRows, rows);
+		if (startRow >= endRow) break;
+		auto sums = &_bandSums[band * SUM_SIZE]; auto terms = &_bandTerms[band * termStride];
+		_pool->Submit([this, level, &pose, startRow, endRow, sums, terms] { ReduceBand(level, pose, startRow, endRow, sums, terms); });
+	}
+	_pool->Wait();
+
+	for (auto i = 0; i < SUM_SIZE; i++) _sums[i] = 0;
+	for (auto band = 0; band < _bands; band++) for (auto i = 0; i < SUM_SIZE; i++) _sums[i] += _bandSums[band * SUM_SIZE + i];
+}
+
+/**
+ * @brief Accumulate the point-to-plane terms of a band of rows. Each current vertex is moved into the reference
+ * camera and projected to find its partner (projective association), and pairs that are too far apart or whose
+ * normals disagree are rejected
+ * @param level The level that we are reducing
+ * @param pose The current estimate (current camera to reference camera)
+ * @param startRow The first row of the band
+ * @param endRow The row after the last row of the band
+ * @param sums The sums for the band
+ * @param terms The scratch space for the packed terms of a row (TERM_SIZE columns of the full resolution width)
+ */
+void IcpTracker::ReduceBand(int level, const SE3& pose, int startRow, int endRow, double * sums, float * terms)
+{
+	auto current = _current[level]; auto reference = _reference[level];
+	auto rows = current->GetZ().rows; auto cols = current->GetZ().cols;
+	auto& intrinsics = reference->GetIntrinsics();
+	auto fx = (float)intrinsics[0], fy = (float)intrinsics[1], cx = (float)intrinsics[2], cy = (float)intrinsics[3];
+
+	float r[9]; float t[3];
+	for (auto i = 0; i < 9; i++) r[i] = (float)pose.GetRotation()[i];
+	for (auto i = 0; i < 3; i++) t[i] = (float)pose.GetTranslation()[i];
+
+	auto X = (float *)current->GetX().data, Y = (float *)current->GetY().data, Z = (float *)current->GetZ().data;
+	auto NX = (float *)current->GetNX().data, NY = (float *)current->GetNY().data, NZ = (float *)current->GetNZ().data;
+	auto RX = (float *)reference->GetX().data, RY = (float *)reference->GetY().data, RZ = (float *)reference->GetZ().data;
+	auto RNX = (float *)reference->GetNX().data, RNY = (float *)reference->GetNY().data, RNZ = (float *)reference->GetNZ().data;
+
+	// The terms of each row are packed into columns (J0..J5, r) and then reduced with dot products over the
+	// columns, which vectorize, rather than accumulating the 27 products pixel by pixel
+	float * columns[TERM_SIZE];
+	for (auto k = 0; k < TERM_SIZE; k++) columns[k] = terms + k * cols;
+
+	for (auto row = startRow; row < endRow; row++)
+	{
+		auto count = 0;
+		for (auto column = 0; column < cols; column++)
+		{
+			auto i = row * cols + column;
+			if (Z[i] <= 0 || (NX[i] == 0 && NY[i] == 0 && NZ[i] == 0)) continue;
+
+			// Move the vertex into the reference camera and project it
+			auto px = r[0] * X[i] + r[1] * Y[i] + r[2] * Z[i] + t[0];
+			auto py = r[3] * X[i] + r[4] * Y[i] + r[5] * Z[i] + t[1];
+			auto pz = r[6] * X[i] + r[7] * Y[i] + r[8] * Z[i] + t[2];
+			if (pz <= 0) continue;
+
+			auto u = (int)(fx * px / pz + cx + 0.5f); auto v = (int)(fy * py / pz + cy + 0.5f);
+			if (u < 0 || v < 0 || u >= cols || v >= rows) continue;
+
+			auto j = v * cols + u;
+			auto nx = RNX[j], ny = RNY[j], nz = RNZ[j];
+			if (RZ[j] <= 0 || (nx == 0 && ny == 0 && nz == 0)) continue;
+
+			// Gate on distance and normal agreement
+			auto dx = px - RX[j], dy = py - RY[j], dz = pz - RZ[j];
+			if (dx * dx + dy * dy + dz * dz > MAX_DISTANCE * MAX_DISTANCE) continue;
+			auto cnx = r[0] * NX[i] + r[1] * NY[i] + r[2] * NZ[i];
+			auto cny = r[3] * NX[i] + r[4] * NY[i] + r[5] * NZ[i];
+			auto cnz = r[6] * NX[i] + r[7] * NY[i] + r[8] * NZ[i];
+			if (cnx * nx + cny * ny + cnz * nz < MIN_NORMAL_DOT) continue;
+
+			// The Jacobian [p x n, n] for a left update of the estimate, and the residual
+			columns[0][count] = py * nz - pz * ny; columns[1][count] = pz * nx - px * nz; columns[2][count] = px * ny - py * nx;
+			columns[3][count] = nx; columns[4][count] = ny; columns[5][count] = nz;
+			columns[6][count] = nx * dx + ny * dy + nz * dz;
+			count++;
+		}
+
+		// The upper triangle of [J r]^T [J r] gives J^T J, J^T r and r^T r in one sweep
+		auto index = 0;
+		for (auto a = 0; a < 7; a++)
+		{
+			for (auto b = a; b < 7; b++)
+			{
+				auto sum = Dot(columns[a], columns[b], count);
+
+				if (a < 6 && b < 6) sums[index++] += sum;
+				else if (a < 6) sums[21 + a] += sum;
+				else sums[28] += sum;
+			}
+		}
+		sums[27] += count;
+	}
+}
+
+/**
+ * @brief A dot product with eight independent accumulators, so that it vectorizes without relaxing the
+ * floating point rules (a single accumulator would serialize on the add latency)
+ * @param left The first column
+ * @param right The second column
+ * @param count The number of elements
+ * @return float The dot product
+ */
+float IcpTracker::Dot(const float * left, const float * right, int count)
+{
+	float partial[8] = {}; auto k = 0;
+	for (; k + 8 <= count; k += 8) for (auto lane = 0; lane < 8; lane++) partial[lane] += left[k + lane] * right[k + lane];
+	for (; k < count; k++) partial[0] += left[k] * right[k];
+	return ((partial[0] + partial[1]) + (partial[2] + partial[3])) + ((partial[4] + partial[5]) + (partial[6] + partial[7]));
+}
+
+/**
+ * @brief Solve the 6x6 normal equations (J^T J) delta = -J^T r with a Cholesky factorization
+ * @param sums The reduced sums
+ * @param delta The resultant update
+ * @return true If the system was positive definite
+ * @return false If the geometry did not constrain every direction
+ */
+bool IcpTracker::Solve(const double * sums, Vec6d& delta)
+{
+	double A[36]; auto index = 0;
+	for (auto a = 0; a < 6; a++) for (auto b = a; b < 6; b++) { A[a * 6 + b] = sums[index]; A[b * 6 + a] = sums[index]; index++; }
+
+	double L[36] = {};
+	for (auto a = 0; a < 6; a++)
+	{
+		for (auto b = 0; b <= a; b++)
+		{
+			auto sum = A[a * 6 + b];
+			for (auto c = 0; c < b; c++) sum -= L[a * 6 + c] * L[b * 6 + c];
+			if (a == b) { if (sum <= 1e-12) return false; L[a * 6 + a] = sqrt(sum); }
+			else L[a * 6 + b] = sum / L[b * 6 + b];
+		}
+	}
+
+	double y[6];
+	for (auto a = 0; a < 6; a++)
+	{
+		auto sum = -sums[21 + a];
+		for (auto c = 0; c < a; c++) sum -= L[a * 6 + c] * y[c];
+		y[a] = sum / L[a * 6 + a];
+	}
+	for (auto a = 5; a >= 0; a--)
+	{
+		auto sum = y[a];
+		for (auto c = a + 1; c < 6; c++) sum -= L[c * 6 + a] * delta[c];
+		delta[a] = sum / L[a * 6 + a];
+	}
+
+	return true;
+}
+
+//--------------------------------------------------
+// Helpers
+//--------------------------------------------------
+
+/**
+ * @brief Parse an iteration schedule such as "10,5,4" (coarsest level first)
+ * @param schedule The schedule string
+ * @return vector<int> The iterations per level
+ */
+vector<int> IcpTracker::ParseSchedule(const string& schedule)
+{
+	auto result = vector<int>(); auto reader = stringstream(schedule); auto token = string();
+	while (getline(reader, token, ',')) result.push_back(stoi(token));
+	if (result.empty()) throw runtime_error("Invalid ICP iteration schedule: " + schedule);
+	return result;
+}
@@ -0,0 +1,81 @@
+//--------------------------------------------------
+// A geometric tracker that aligns depth maps with point-to-plane ICP, using projective data association over
+// a depth pyramid. It works where the features give out (e.g. on blank walls) as long as the depth is good
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include "SE3.h"
+#include "Calibration.h"
+#include "ThreadPool.h"
+
+namespace NVL_App
+{
+	class IcpLevel
+	{
+	private:
+		Vec4d _intrinsics;
+		Mat _x, _y, _z;
+		Mat _nx, _ny, _nz;
+	public:
+		IcpLevel(const Size& size, const Vec4d& intrinsics) : _intrinsics(intrinsics)
+		{
+			_x = Mat_<float>(size); _y = Mat_<float>(size); _z = Mat_<float>(size);
+			_nx = Mat_<float>(size); _ny = Mat_<float>(size); _nz = Mat_<float>(size);
+		}
+
+		inline Vec4d& GetIntrinsics() { return _intrinsics; }
+		inline Mat& GetX() { return _x; }
+		inline Mat& GetY() { return _y; }
+		inline Mat& GetZ() { return _z; }
+		inline Mat& GetNX() { return _nx; }
+		inline Mat& GetNY() { return _ny; }
+		inline Mat& GetNZ() { return _nz; }
+	};
+
+	class IcpTracker
+	{
+	private:
+		vector<int> _iterations;
+		vector<IcpLevel *> _reference;
+		vector<IcpLevel *> _current;
+		ThreadPool * _pool;
+		int _bands;
+		vector<double> _bandSums;
+		vector<float> _bandTerms;
+		double _sums[29];
+		double _validCount;
+		double _error;
+		double _inlierRatio;
+	public:
+		IcpTracker(Calibration * calibration, const Size& size, vector<int>& iterations, int threads);
+		~IcpTracker();
+
+		void SetFrame(Mat& depth);
+		bool Track(SE3& pose);
+		void Accept();
+
+		inline double GetError() { return _error; }
+		inline double GetInlierRatio() { return _inlierRatio; }
+
+		static vector<int> ParseSchedule(const string& schedule);
+	private:
+		void BuildLevel(IcpLevel * level);
+		void Downsample(IcpLevel * input, IcpLevel * output);
+		void ComputeNormals(IcpLevel * level);
+		void Reduce(int level, const SE3& pose);
+		void ReduceBand(int level, const SE3& pose, int startRow, int endRow, double * sums, float * terms);
+		static float Dot(const float * left, const float * right, int count);
+		static bool Solve(const double * sums, Vec6d& delta);
+	};
+}
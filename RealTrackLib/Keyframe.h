@@ -0,0 +1,54 @@
+//--------------------------------------------------
+// A keyframe (and its tracked feature observations) that is handed to the local bundle adjuster
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include "SE3.h"
+
+namespace NVL_App
+{
+	class Observation
+	{
+	private:
+		long _trackId;
+		Point2d _point;
+		double _depth;
+	public:
+		Observation(long trackId, const Point2d& point, double depth) :
+			_trackId(trackId), _point(point), _depth(depth) {}
+
+		inline long& GetTrackId() { return _trackId; }
+		inline Point2d& GetPoint() { return _point; }
+		inline double& GetDepth() { return _depth; }
+	};
+
+	class Keyframe
+	{
+	private:
+		int _id;
+		SE3 _odometry;
+		SE3 _pose;
+		vector<Observation> _observations;
+		Mat _image;
+	public:
+		Keyframe(int id, const SE3& odometry, vector<Observation>& observations) :
+			_id(id), _odometry(odometry), _pose(odometry), _observations(observations) {}
+
+		inline int& GetId() { return _id; }
+		inline SE3& GetOdometry() { return _odometry; }
+		inline SE3& GetPose() { return _pose; }
+		inline vector<Observation>& GetObservations() { return _observations; }
+		inline Mat& GetImage() { return _image; }
+	};
+}
@@ -0,0 +1,193 @@
+//--------------------------------------------------
+// Implementation of class LandmarkMap
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "LandmarkMap.h"
+using namespace NVL_App;
+
+// The edge length of a grid cell (mm)
+#define CELL_SIZE 50.0
+
+// The most weight that the running estimate gives the past samples (so that a landmark can still follow drift)
+#define MAX_WEIGHT 10
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor
+ * @param maxAge The number of frames that a landmark survives without being observed
+ */
+LandmarkMap::LandmarkMap(int maxAge) : _maxAge(maxAge), _frame(0) {}
+
+/**
+ * @brief Main Terminator
+ */
+LandmarkMap::~LandmarkMap()
+{
+	for (auto& landmark : _landmarks) delete landmark.second;
+}
+
+//--------------------------------------------------
+// Update
+//--------------------------------------------------
+
+/**
+ * @brief Retrieve the landmark of a track
+ * @param id The id of the track
+ * @return Landmark * The landmark (or nullptr if the track has none)
+ */
+Landmark * LandmarkMap::Find(long id)
+{
+	auto landmark = _landmarks.find(id);
+	return landmark == _landmarks.end() ? nullptr : landmark->second;
+}
+
+/**
+ * @brief Add a depth sample of a landmark (creating the landmark if this is the first one). A sample that lands
+ * further than the tolerance from the estimate restarts it, as the track has most likely slipped onto another surface
+ * @param id The id of the track that observed the landmark
+ * @param position The sampled position (in the odometry frame)
+ * @param tolerance The distance (in mm) within which the sample is taken to agree with the estimate
+ * @return Landmark * The landmark
+ */
+Landmark * LandmarkMap::Observe(long id, const Point3d& position, double tolerance)
+{
+	auto landmark = Find(id);
+	if (landmark == nullptr)
+	{
+		landmark = new Landmark(id, position, _frame, GetCell(position));
+		_landmarks[id] = landmark; _grid[landmark->GetCell()].push_back(landmark);
+		return landmark;
+	}
+
+	auto& estimate = landmark->GetPosition(); auto& observations = landmark->GetObservations();
+	if (norm(position - estimate) > tolerance) { estimate = position; observations = 1; }
+	else
+	{
+		auto weight = (double)min(observations, MAX_WEIGHT);
+		estimate = (estimate * weight + position) * (1.0 / (weight + 1)); observations++;
+	}
+	landmark->GetLastSeen() = _frame;
+
+	// Move the landmark to its new cell if the estimate has crossed over
+	auto cell = GetCell(estimate);
+	if (cell != landmark->GetCell()) { Unbin(landmark); landmark->GetCell() = cell; _grid[cell].push_back(landmark); }
+
+	return landmark;
+}
+
+/**
+ * @brief Advance to the next frame, dropping the landmarks that have gone unobserved for too long
+ */
+void LandmarkMap::NextFrame()
+{
+	_frame++;
+
+	auto expired = vector<Landmark *>();
+	for (auto& landmark : _landmarks) if (_frame - landmark.second->GetLastSeen() > _maxAge) expired.push_back(landmark.second);
+	for (auto landmark : expired) Remove(landmark);
+}
+
+/**
+ * @brief Remove a landmark from the map
+ * @param landmark The landmark that we are removing
+ */
+void LandmarkMap::Remove(Landmark * landmark)
+{
+	Unbin(landmark);
+	_landmarks.erase(landmark->GetId());
+	delete landmark;
+}
+
+/**
+ * @brief Take a landmark out of its grid cell
+ * @param landmark The landmark that we are moving or removing
+ */
+void LandmarkMap::Unbin(Landmark * landmark)
+{
+	auto& members = _grid[landmark->GetCell()];
+	members.erase(find(members.begin(), members.end(), landmark));
+	if (members.empty()) _grid.erase(landmark->GetCell());
+}
+
+//--------------------------------------------------
+// Query
+//--------------------------------------------------
+
+/**
+ * @brief Find the closest landmark to a point that has not been observed within the current frame
+ * @param position The point that we are searching around (in the odometry frame)
+ * @param radius The search radius (in mm)
+ * @return Landmark * The closest landmark (or nullptr if there is none within the radius)
+ */
+Landmark * LandmarkMap::FindUnseen(const Point3d& position, double radius)
+{
+	auto candidates = vector<Landmark *>(); Query(position, radius, candidates);
+
+	Landmark * result = nullptr; auto best = radius;
+	for (auto candidate : candidates)
+	{
+		if (candidate->GetLastSeen() == _frame) continue;
+		auto distance = norm(candidate->GetPosition() - position);
+		if (distance <= best) { best = distance; result = candidate; }
+	}
+
+	return result;
+}
+
+/**
+ * @brief Find the landmarks within a radius of a point (only the cells that the sphere overlaps are searched)
+ * @param center The center of the search (in the odometry frame)
+ * @param radius The search radius (in mm)
+ * @param out The landmarks that were found
+ */
+void LandmarkMap::Query(const Point3d& center, double radius, vector<Landmark *>& out)
+{
+	auto low = Point3i((int)floor((center.x - radius) / CELL_SIZE), (int)floor((center.y - radius) / CELL_SIZE), (int)floor((center.z - radius) / CELL_SIZE));
+	auto high = Point3i((int)floor((center.x + radius) / CELL_SIZE), (int)floor((center.y + radius) / CELL_SIZE), (int)floor((center.z + radius) / CELL_SIZE));
+
+	for (auto z = low.z; z <= high.z; z++)
+	{
+		for (auto y = low.y; y <= high.y; y++)
+		{
+			for (auto x = low.x; x <= high.x; x++)
+			{
+				auto cell = _grid.find(GetCell(x, y, z)); if (cell == _grid.end()) continue;
+				for (auto landmark : cell->second) if (norm(landmark->GetPosition() - center) <= radius) out.push_back(landmark);
+			}
+		}
+	}
+}
+
+//--------------------------------------------------
+// Helpers
+//--------------------------------------------------
+
+/**
+ * @brief Find the key of the cell that holds a point
+ * @param position The point (in the odometry frame)
+ * @return int64_t The key of the cell
+ */
+int64_t LandmarkMap::GetCell(const Point3d& position)
+{
+	return GetCell((int)floor(position.x / CELL_SIZE), (int)floor(position.y / CELL_SIZE), (int)floor(position.z / CELL_SIZE));
+}
+
+/**
+ * @brief Pack the coordinates of a cell into a key (21 bits per axis, which covers +/- 52 km at 50 mm cells)
+ * @param x The cell column
+ * @param y The cell row
+ * @param z The cell layer
+ * @return int64_t The key of the cell
+ */
+int64_t LandmarkMap::GetCell(int x, int y, int z)
+{
+	auto mask = (int64_t)0x1FFFFF;
+	return ((int64_t)x & mask) | (((int64_t)y & mask) << 21) | (((int64_t)z & mask) << 42);
+}
@@ -0,0 +1,71 @@
+//--------------------------------------------------
+// A store of persistent 3D landmarks, keyed by the id of the feature track that observes them.
+//
+// Positions are held in the frame of the first tracked frame (the odometry frame of the tracker), and each one is a
+// running estimate over the depth samples that have been taken of it. The landmarks are also binned in a coarse
+// voxel grid, so that the ones near a point can be found without a search of the whole map (which is used to pick
+// up a landmark again when a new track starts on it)
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+#include <unordered_map>
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+namespace NVL_App
+{
+	class Landmark
+	{
+	private:
+		long _id;
+		Point3d _position;
+		int _observations;
+		int _lastSeen;
+		int64_t _cell;
+	public:
+		Landmark(long id, const Point3d& position, int frame, int64_t cell) :
+			_id(id), _position(position), _observations(1), _lastSeen(frame), _cell(cell) {}
+
+		inline long& GetId() { return _id; }
+		inline Point3d& GetPosition() { return _position; }
+		inline int& GetObservations() { return _observations; }
+		inline int& GetLastSeen() { return _lastSeen; }
+		inline int64_t& GetCell() { return _cell; }
+	};
+
+	class LandmarkMap
+	{
+	private:
+		int _maxAge;
+		int _frame;
+		unordered_map<long, Landmark *> _landmarks;
+		unordered_map<int64_t, vector<Landmark *>> _grid;
+	public:
+		LandmarkMap(int maxAge);
+		~LandmarkMap();
+
+		Landmark * Find(long id);
+		Landmark * Observe(long id, const Point3d& position, double tolerance);
+		Landmark * FindUnseen(const Point3d& position, double radius);
+		void Query(const Point3d& center, double radius, vector<Landmark *>& out);
+		void NextFrame();
+
+		inline int GetCount() { return (int)_landmarks.size(); }
+		inline int GetFrame() { return _frame; }
+	private:
+		void Remove(Landmark * landmark);
+		void Unbin(Landmark * landmark);
+		static int64_t GetCell(const Point3d& position);
+		static int64_t GetCell(int x, int y, int z);
+	};
+}
@@ -0,0 +1,135 @@
+//--------------------------------------------------
+// Implementation of class LatencyController
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "LatencyController.h"
+using namespace NVL_App;
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor
+ * @param budget The per-frame deadline in milliseconds (0 to disable the controller)
+ */
+LatencyController::LatencyController(double budget) : _budget(budget), _quality(1), _evaluationCost(0), _frameCount(0)
+{
+	_low = QualitySettings(300, 11, 1, 200, 8, 1, 14);
+	_high = QualitySettings(3000, 21, 3, 10000, 1, 3, 1400);
+	_settings = IsEnabled() ? _high : QualitySettings();
+
+	for (auto i = 0; i < (int)PipelineStage::COUNT; i++) { _stageTimes[i] = 0; _stageAverages[i] = 0; }
+}
+
+//--------------------------------------------------
+// Measurement
+//--------------------------------------------------
+
+/**
+ * @brief Mark the start of a new frame
+ */
+void LatencyController::StartFrame()
+{
+	_frameStart = chrono::steady_clock::now();
+	for (auto i = 0; i < (int)PipelineStage::COUNT; i++) _stageTimes[i] = 0;
+}
+
+/**
+ * @brief Record the time that a stage took within the current frame
+ * @param stage The stage that we are recording
+ * @param milliseconds The time that the stage took
+ */
+void LatencyController::AddStage(PipelineStage stage, double milliseconds)
+{
+	_stageTimes[(int)stage] += milliseconds;
+}
+
+/**
+ * @brief Record the cost of the photometric refinement so that we can predict the cost of an evaluation
+ * @param milliseconds The time that the refinement took
+ * @param evaluations The number of error evaluations that were performed
+ */
+void LatencyController::AddRefineCost(double milliseconds, int evaluations)
+{
+	if (evaluations <= 0) return;
+	auto cost = milliseconds / evaluations;
+	_evaluationCost = _evaluationCost == 0 ? cost : 0.8 * _evaluationCost + 0.2 * cost;
+}
+
+/**
+ * @brief Retrieve the time that has elapsed since the start of the frame
+ * @return double The elapsed time in milliseconds
+ */
+double LatencyController::GetElapsed()
+{
+	return chrono::duration<double, milli>(chrono::steady_clock::now() - _frameStart).count();
+}
+
+//--------------------------------------------------
+// Adaptation
+//--------------------------------------------------
+
+/**
+ * @brief Determine how many refinement evaluations we can afford within what is left of the budget
+ * @return int The number of evaluations (0 means that refinement should be skipped)
+ */
+int LatencyController::GetRefineBudget()
+{
+	if (!IsEnabled() || _evaluationCost == 0) return _settings.GetRefineIterations();
+
+	// Leave room for fusion (using the running average) and a little slack for jitter
+	auto remaining = _budget * 0.95 - GetElapsed() - _stageAverages[(int)PipelineStage::FUSE];
+	if (remaining <= 0) return 0;
+
+	auto affordable = (int)(remaining / _evaluationCost);
+	return min(affordable, _settings.GetRefineIterations());
+}
+
+/**
+ * @brief Close the frame and adjust the quality for the next one
+ */
+void LatencyController::EndFrame()
+{
+	auto total = GetElapsed();
+
+	// Update the running averages of the stages
+	auto alpha = _frameCount == 0 ? 1.0 : 0.2;
+	for (auto i = 0; i < (int)PipelineStage::COUNT; i++) _stageAverages[i] = (1 - alpha) * _stageAverages[i] + alpha * _stageTimes[i];
+	_frameCount++;
+
+	if (!IsEnabled()) return;
+
+	// Back off quickly when we overrun, and creep back up when there is plenty of headroom
+	if (total > _budget) _quality -= min(0.5, (total - _budget) / _budget);
+	else if (total < 0.7 * _budget) _quality += 0.02;
+	_quality = min(max(_quality, 0.0), 1.0);
+
+	_settings = QualitySettings::Interpolate(_low, _high, _quality);
+}
+
+//--------------------------------------------------
+// Helpers
+//--------------------------------------------------
+
+/**
+ * @brief Retrieve a human readable name for a stage
+ * @param stage The stage that we want the name of
+ * @return const char * The name of the stage
+ */
+const char * LatencyController::GetStageName(PipelineStage stage)
+{
+	switch (stage) 
+	{
+		case PipelineStage::DETECT: return "detect";
+		case PipelineStage::MATCH: return "match";
+		case PipelineStage::POSE: return "pose";
+		case PipelineStage::REFINE: return "refine";
+		case PipelineStage::FUSE: return "fuse";
+		default: return "unknown";
+	}
+}
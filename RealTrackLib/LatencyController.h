@@ -0,0 +1,57 @@
+//--------------------------------------------------
+// Adapts the pipeline quality frame by frame to stay within a latency budget
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <chrono>
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include "QualitySettings.h"
+
+namespace NVL_App
+{
+	enum class PipelineStage { DETECT = 0, MATCH, POSE, REFINE, FUSE, COUNT };
+
+	class LatencyController
+	{
+	private:
+		double _budget;
+		double _quality;
+		QualitySettings _low;
+		QualitySettings _high;
+		QualitySettings _settings;
+
+		chrono::steady_clock::time_point _frameStart;
+		double _stageTimes[(int)PipelineStage::COUNT];
+		double _stageAverages[(int)PipelineStage::COUNT];
+		double _evaluationCost;
+		int _frameCount;
+	public:
+		LatencyController(double budget);
+
+		void StartFrame();
+		void AddStage(PipelineStage stage, double milliseconds);
+		void AddRefineCost(double milliseconds, int evaluations);
+		void EndFrame();
+
+		double GetElapsed();
+		int GetRefineBudget();
+
+		inline bool IsEnabled() { return _budget > 0; }
+		inline double GetBudget() { return _budget; }
+		inline double GetQuality() { return _quality; }
+		inline double GetStageTime(PipelineStage stage) { return _stageTimes[(int)stage]; }
+		inline QualitySettings& GetSettings() { return _settings; }
+
+		static const char * GetStageName(PipelineStage stage);
+	};
+}
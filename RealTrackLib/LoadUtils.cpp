@@ -28,12 +28,67 @@ NVLib::DepthFrame * LoadUtils::LoadFrame(const string& folder, int index)
 	return NVLib::LoadUtils::LoadDepthFrame(colorPath, depthPath);
 }
 
+/**
+ * @brief Load a depth frame into the buffers of an existing frame (no allocation once the buffers are warm)
+ * @param folder The folder to load the frames from
+ * @param index The index of the frame that we are loading
+ * @param frame The frame whose buffers we are decoding into (its depth type decides the stored depth format)
+ * @param buffer A scratch buffer that holds the raw file bytes
+ * @param depthBuffer A scratch image that the depth is decoded into before it is handed to the frame
+ */
+void LoadUtils::LoadFrame(const string& folder, int index, NVLib::DepthFrame * frame, vector<uchar>& buffer, Mat& depthBuffer)
+{
+	auto colorFile = stringstream(); colorFile << "color_" << setw(4) << setfill('0') << index << ".png";
+	auto depthFile = stringstream(); depthFile << "depth_" << setw(4) << setfill('0') << index << ".tiff";
+	auto colorPath = NVLib::FileUtils::PathCombine(folder, colorFile.str());
+	auto depthPath = NVLib::FileUtils::PathCombine(folder, depthFile.str());
+	DecodeImage(colorPath, IMREAD_COLOR, buffer, frame->GetColor());
+	DecodeImage(depthPath, IMREAD_UNCHANGED, buffer, depthBuffer);
+	ConvertDepth(depthBuffer, frame->GetDepth());
+}
+
+/**
+ * @brief Hand a decoded depth map over to the frame, in the frame's depth format. When the formats match the
+ * buffers are swapped (so the old frame buffer becomes the next decode target), otherwise the values are converted.
+ * Float maps are millimetres, so the conversion to CV_16U rounds to the nearest millimetre and saturates.
+ * @param input The decoded depth map
+ * @param output The frame depth map (its type is kept)
+ */
+void LoadUtils::ConvertDepth(Mat& input, Mat& output)
+{
+	if (input.type() == output.type() || output.empty()) swap(input, output);
+	else input.convertTo(output, output.type());
+}
+
+/**
+ * @brief Decode an image from disk straight into the given output buffer
+ * @param path The path to the image that we are loading
+ * @param flags The decoding flags
+ * @param buffer A scratch buffer that holds the raw file bytes
+ * @param output The image that we are decoding into (reused if the size and type match)
+ */
+void LoadUtils::DecodeImage(const string& path, int flags, vector<uchar>& buffer, Mat& output)
+{
+	auto reader = ifstream(path, ios::binary | ios::ate);
+	if (!reader.is_open()) throw runtime_error("Unable to open file: " + path);
+
+	auto length = (size_t)reader.tellg(); reader.seekg(0, ios::beg);
+	buffer.resize(length); reader.read((char *)buffer.data(), length);
+	reader.close();
+
+	imdecode(buffer, flags, &output);
+	if (output.empty()) throw runtime_error("Unable to decode image: " + path);
+}
+
 //--------------------------------------------------
 // Load Calibration
 //--------------------------------------------------
 
 /**
- * @brief Load calibration details from disk
+ * @brief Load calibration details from disk. Besides the color camera matrix, the file may hold the distortion 
+ * coefficients of the color camera ("distortion") and, for depth that is not registered to the color, the matrix 
+ * and distortion of the depth camera along with the depth to color transform in millimetres ("depth_camera", 
+ * "depth_distortion" and "depth_pose"). Anything that is missing is taken as already corrected
  * @param path The path where the calibration file is located
  * @return Calibration * Returns a Calibration *
  */
@@ -46,8 +101,41 @@ Calibration * LoadUtils::LoadCalibration(const string& path)
 	auto input = (double *) camera.data;
 
 	auto focals = Vec2d(input[0], input[4]); auto center = Point2d(input[2], input[5]);
+	auto calibration = new Calibration(focals, center);
+
+	reader["distortion"] >> calibration->GetDistortion();
+	reader["depth_camera"] >> calibration->GetDepthCamera();
+	reader["depth_distortion"] >> calibration->GetDepthDistortion();
+	reader["depth_pose"] >> calibration->GetDepthPose();
 
 	reader.release();
 
-	return new Calibration(focals, center);
+	// The rectification reads the matrices directly, so they are held in double precision
+	for (auto matrix : { &calibration->GetDistortion(), &calibration->GetDepthCamera(), &calibration->GetDepthDistortion(), &calibration->GetDepthPose() })
+	{
+		if (!matrix->empty()) matrix->convertTo(*matrix, CV_64F);
+	}
+
+	if (calibration->HasDepthCamera() && calibration->GetDepthPose().total() != 16) 
+	{
+		delete calibration; throw runtime_error("A calibration with a depth camera needs a 4x4 depth_pose");
+	}
+
+	return calibration;
+}
+
+//--------------------------------------------------
+// Depth Format
+//--------------------------------------------------
+
+/**
+ * @brief Convert a depth format name into the OpenCV type that holds it
+ * @param format The format name ("float" or "mm16")
+ * @return int The associated OpenCV type
+ */
+int LoadUtils::GetDepthType(const string& format)
+{
+	if (format == "float") return CV_32FC1;
+	if (format == "mm16") return CV_16UC1;
+	throw runtime_error("Unknown depth format: " + format);
 }
\ No newline at end of file
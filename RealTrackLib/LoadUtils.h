@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <fstream>
 #include <iostream>
 using namespace std;
 
@@ -26,6 +27,11 @@ namespace NVL_App
 	{
 	public:
 		static NVLib::DepthFrame * LoadFrame(const string& folder, int index);
+		static void LoadFrame(const string& folder, int index, NVLib::DepthFrame * frame, vector<uchar>& buffer, Mat& depthBuffer);
+		static void ConvertDepth(Mat& input, Mat& output);
 		static Calibration * LoadCalibration(const string& path);
+		static int GetDepthType(const string& format);
+	private:
+		static void DecodeImage(const string& path, int flags, vector<uchar>& buffer, Mat& output);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,290 @@
+//--------------------------------------------------
+// Implementation of class LoopCloser
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "LoopCloser.h"
+using namespace NVL_App;
+
+// The shape of the vocabulary tree (up to 8^4 = 4096 words) and the posting list length beyond which a word is a stop-word
+#define VOCABULARY_BRANCHING 8
+#define VOCABULARY_LEVELS 4
+#define MAX_POSTINGS 4000
+
+// The number of retrieved candidates that are verified, and the ratio test used when matching them
+#define CANDIDATE_COUNT 3
+#define MATCH_RATIO 0.8
+
+// The expected accuracy of the odometry and loop constraints (radians and millimetres)
+#define ROTATION_SIGMA 0.01
+#define TRANSLATION_SIGMA 10.0
+#define GRAPH_ITERATIONS 10
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor (starts the background worker straight away)
+ * @param calibration The calibration of the camera
+ * @param vocabularyPath A vocabulary file to load (or to save the trained vocabulary to), empty for none
+ * @param trainingKeyframes The number of keyframes to gather before training a vocabulary (if none was loaded)
+ * @param features The maximum number of features that describe a keyframe
+ * @param minGap The number of recent keyframes that are excluded from retrieval (also the cooldown after a loop)
+ * @param minInliers The number of PnP inliers that a loop needs to be accepted
+ */
+LoopCloser::LoopCloser(Calibration * calibration, const string& vocabularyPath, int trainingKeyframes, int features, int minGap, int minInliers) :
+	_focals(calibration->GetFocals()), _center(calibration->GetCenter()), _vocabularyPath(vocabularyPath), _trainingKeyframes(trainingKeyframes),
+	_features(features), _minGap(minGap), _minInliers(minInliers), _database(nullptr), _lastLoop(-1), _loops(0), _stop(false)
+{
+	_camera = calibration->GetMatrix();
+	_vocabulary = new BinaryVocabulary();
+	_graph = new PoseGraph(ROTATION_SIGMA, TRANSLATION_SIGMA);
+	_estimator = new PoseEstimator(200);
+	_orb = ORB::create(features);
+
+	if (!vocabularyPath.empty() && _vocabulary->Load(vocabularyPath)) _database = new PlaceDatabase(_vocabulary->GetWordCount(), MAX_POSTINGS);
+	_worker = thread(&LoopCloser::Work, this, PerfCounters::GetSession());
+}
+
+/**
+ * @brief Main Terminator
+ */
+LoopCloser::~LoopCloser()
+{
+	Finish();
+	for (auto keyframe : _incoming) delete keyframe;
+	for (auto entry : _entries) delete entry;
+	delete _estimator; delete _graph; delete _database; delete _vocabulary;
+}
+
+//--------------------------------------------------
+// Tracking Thread Interface
+//--------------------------------------------------
+
+/**
+ * @brief Queue a keyframe for place recognition (the keyframe must carry its color image)
+ * @param keyframe The keyframe that we are adding (ownership passes to the loop closer)
+ */
+void LoopCloser::AddKeyframe(Keyframe * keyframe)
+{
+	{
+		lock_guard<mutex> guard(_lock);
+		_incoming.push_back(keyframe);
+	}
+	_wake.notify_one();
+}
+
+/**
+ * @brief Retrieve the corrected keyframe poses from the last loop closure. This never blocks
+ * @param output The corrected camera to world poses, by keyframe id
+ * @return true If there were corrections to collect
+ * @return false If there was nothing new (or the results were busy)
+ */
+bool LoopCloser::GetCorrections(map<int, SE3>& output)
+{
+	unique_lock<mutex> lock(_resultLock, try_to_lock);
+	if (!lock.owns_lock() || _published.empty()) return false;
+	output.clear(); output.swap(_published);
+	return true;
+}
+
+/**
+ * @brief Process whatever is still queued and then stop the worker
+ */
+void LoopCloser::Finish()
+{
+	{
+		lock_guard<mutex> guard(_lock);
+		_stop = true;
+	}
+	_wake.notify_all();
+	if (_worker.joinable()) _worker.join();
+}
+
+//--------------------------------------------------
+// Worker
+//--------------------------------------------------
+
+/**
+ * @brief The background loop: wait for keyframes and look for loops
+ * @param session The perf session of the thread that started the worker (see PerfCounters)
+ */
+void LoopCloser::Work(PerfSession * session)
+{
+	auto incoming = vector<Keyframe *>(); PerfCounters::SetSession(session); PerfCounters::SetThreadName("loop");
+
+	while (true)
+	{
+		{
+			unique_lock<mutex> lock(_lock);
+			_wake.wait(lock, [this] { return !_incoming.empty() || _stop; });
+			if (_incoming.empty()) break;
+			incoming.swap(_incoming);
+		}
+
+		for (auto keyframe : incoming) { auto perf = PerfScope("process"); Process(keyframe); delete keyframe; }
+		incoming.clear();
+	}
+}
+
+/**
+ * @brief Add a keyframe to the graph and the database, and check it for a loop. The new node starts from its
+ * odometry with the latest graph correction applied, and is tied to the previous node by the odometry between them
+ * @param keyframe The keyframe that we are processing
+ */
+void LoopCloser::Process(Keyframe * keyframe)
+{
+	auto entry = Describe(keyframe);
+
+	if (_entries.empty()) _graph->AddNode(entry->GetOdometry());
+	else
+	{
+		auto previous = _entries.back(); auto& poses = _graph->GetPoses();
+		auto correction = poses.back() * previous->GetOdometry().Inverse();
+		auto node = _graph->AddNode(correction * entry->GetOdometry());
+		_graph->AddEdge(node - 1, node, previous->GetOdometry().Inverse() * entry->GetOdometry());
+	}
+	_entries.push_back(entry);
+
+	if (_database == nullptr) { TrainVocabulary(); return; }
+
+	auto words = vector<int>(); _vocabulary->Quantize(entry->GetDescriptors(), words);
+	auto id = _database->Add(words);
+	Detect(id, words);
+}
+
+/**
+ * @brief Describe the keyframe features that have a depth with ORB (subsampled to the feature budget)
+ * @param keyframe The keyframe that we are describing
+ * @return PlaceEntry * The resultant entry
+ */
+PlaceEntry * LoopCloser::Describe(Keyframe * keyframe)
+{
+	auto entry = new PlaceEntry(keyframe->GetId(), keyframe->GetOdometry());
+	auto& observations = keyframe->GetObservations(); auto& image = keyframe->GetImage();
+	if (image.empty()) return entry;
+
+	auto valid = vector<int>();
+	for (auto i = 0; i < (int)observations.size(); i++) if (observations[i].GetDepth() > 0) valid.push_back(i);
+
+	auto keypoints = vector<KeyPoint>(); auto stride = max((double)valid.size() / _features, 1.0);
+	for (auto position = 0.0; position < valid.size(); position += stride)
+	{
+		auto index = valid[(int)position];
+		keypoints.push_back(KeyPoint(Point2f(observations[index].GetPoint()), 31.0f, -1, 0, 0, index));
+	}
+
+	Mat gray; if (image.channels() == 3) cvtColor(image, gray, COLOR_BGR2GRAY); else gray = image;
+	_orb->compute(gray, keypoints, entry->GetDescriptors());
+
+	// ORB drops keypoints near the border, so the observation is recovered through the class id
+	for (auto& keypoint : keypoints)
+	{
+		auto& observation = observations[keypoint.class_id]; auto& point = observation.GetPoint(); auto Z = observation.GetDepth();
+		entry->GetPoints().push_back(Point3f((point.x - _center.x) * Z / _focals[0], (point.y - _center.y) * Z / _focals[1], Z));
+		entry->GetPixels().push_back(Point2f(point));
+	}
+
+	return entry;
+}
+
+//--------------------------------------------------
+// Vocabulary
+//--------------------------------------------------
+
+/**
+ * @brief Once enough keyframes have been gathered, train the vocabulary on their descriptors and index them
+ */
+void LoopCloser::TrainVocabulary()
+{
+	if ((int)_entries.size() < _trainingKeyframes) return;
+
+	auto descriptors = vector<Mat>();
+	for (auto entry : _entries) if (!entry->GetDescriptors().empty()) descriptors.push_back(entry->GetDescriptors());
+	if (descriptors.empty()) return;
+
+	Mat training; vconcat(descriptors, training);
+	_vocabulary->Train(training, VOCABULARY_BRANCHING, VOCABULARY_LEVELS);
+	if (!_vocabularyPath.empty()) _vocabulary->Save(_vocabularyPath);
+
+	_database = new PlaceDatabase(_vocabulary->GetWordCount(), MAX_POSTINGS);
+	auto words = vector<int>();
+	for (auto entry : _entries) { _vocabulary->Quantize(entry->GetDescriptors(), words); _database->Add(words); }
+}
+
+//--------------------------------------------------
+// Detection
+//--------------------------------------------------
+
+/**
+ * @brief Look for a loop between the given entry and the older entries. The first candidate that survives
+ * verification becomes a loop constraint and the graph is optimized
+ * @param entry The entry that we are checking
+ * @param words The words of the entry
+ */
+void LoopCloser::Detect(int entry, vector<int>& words)
+{
+	if (_lastLoop >= 0 && entry - _lastLoop < _minGap) return;
+
+	auto candidates = vector<PlaceCandidate>();
+	_database->Query(words, entry - _minGap, CANDIDATE_COUNT, candidates);
+
+	for (auto& candidate : candidates)
+	{
+		auto measurement = SE3();
+		if (!Verify(_entries[candidate.GetEntry()], _entries[entry], measurement)) continue;
+
+		_graph->AddEdge(candidate.GetEntry(), entry, measurement);
+		_graph->Optimize(GRAPH_ITERATIONS);
+		Publish();
+
+		_lastLoop = entry; _loops++;
+		break;
+	}
+}
+
+/**
+ * @brief Verify a candidate by matching descriptors and estimating the relative pose with PnP
+ * @param candidate The older entry (whose features are lifted with depth)
+ * @param current The newer entry
+ * @param measurement The relative pose (candidate^-1 * current) if the loop is accepted
+ * @return true If the loop is geometrically consistent
+ * @return false If there were too few inliers
+ */
+bool LoopCloser::Verify(PlaceEntry * candidate, PlaceEntry * current, SE3& measurement)
+{
+	if (candidate->GetDescriptors().empty() || current->GetDescriptors().empty()) return false;
+
+	auto matcher = BFMatcher(NORM_HAMMING); auto matches = vector< vector<DMatch> >();
+	matcher.knnMatch(current->GetDescriptors(), candidate->GetDescriptors(), matches, 2);
+
+	auto scenePoints = vector<Point3f>(); auto imagePoints = vector<Point2f>();
+	for (auto& match : matches)
+	{
+		if (match.size() < 2 || match[0].distance > MATCH_RATIO * match[1].distance) continue;
+		scenePoints.push_back(candidate->GetPoints()[match[0].trainIdx]);
+		imagePoints.push_back(current->GetPixels()[match[0].queryIdx]);
+	}
+	if ((int)scenePoints.size() < _minInliers) return false;
+
+	auto error = Vec2d(); auto pose = _estimator->Estimate(_camera, scenePoints, imagePoints, error);
+	if ((int)_estimator->GetInliers().size() < _minInliers) return false;
+
+	// The estimate maps the candidate camera into the current camera
+	measurement = pose.Inverse();
+	return true;
+}
+
+/**
+ * @brief Publish the optimized poses of every keyframe for the tracking thread
+ */
+void LoopCloser::Publish()
+{
+	lock_guard<mutex> guard(_resultLock);
+	auto& poses = _graph->GetPoses();
+	for (auto i = 0; i < (int)_entries.size(); i++) _published[_entries[i]->GetKeyframeId()] = poses[i];
+}
@@ -0,0 +1,99 @@
+//--------------------------------------------------
+// Detects when the camera returns to a place that it has seen before and closes the loop. Keyframes are
+// described with ORB words and retrieved through an inverted index, candidates are verified with PnP and
+// each verified loop is fed into a pose graph, whose optimized poses are published for the trajectory
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include "SE3.h"
+#include "Keyframe.h"
+#include "Calibration.h"
+#include "PerfCounters.h"
+#include "BinaryVocabulary.h"
+#include "PlaceDatabase.h"
+#include "PoseGraph.h"
+#include "PoseEstimator.h"
+
+namespace NVL_App
+{
+	class PlaceEntry
+	{
+	private:
+		int _keyframeId;
+		SE3 _odometry;
+		Mat _descriptors;
+		vector<Point3f> _points;
+		vector<Point2f> _pixels;
+	public:
+		PlaceEntry(int keyframeId, const SE3& odometry) : _keyframeId(keyframeId), _odometry(odometry) {}
+
+		inline int& GetKeyframeId() { return _keyframeId; }
+		inline SE3& GetOdometry() { return _odometry; }
+		inline Mat& GetDescriptors() { return _descriptors; }
+		inline vector<Point3f>& GetPoints() { return _points; }
+		inline vector<Point2f>& GetPixels() { return _pixels; }
+	};
+
+	class LoopCloser
+	{
+	private:
+		Mat _camera;
+		Vec2d _focals;
+		Point2d _center;
+		string _vocabularyPath;
+		int _trainingKeyframes;
+		int _features;
+		int _minGap;
+		int _minInliers;
+
+		BinaryVocabulary * _vocabulary;
+		PlaceDatabase * _database;
+		PoseGraph * _graph;
+		PoseEstimator * _estimator;
+		Ptr<ORB> _orb;
+		vector<PlaceEntry *> _entries;
+		int _lastLoop;
+
+		vector<Keyframe *> _incoming;
+		map<int, SE3> _published;
+		atomic<int> _loops;
+		bool _stop;
+		thread _worker;
+		mutex _lock;
+		mutex _resultLock;
+		condition_variable _wake;
+	public:
+		LoopCloser(Calibration * calibration, const string& vocabularyPath, int trainingKeyframes, int features, int minGap, int minInliers);
+		~LoopCloser();
+
+		void AddKeyframe(Keyframe * keyframe);
+		bool GetCorrections(map<int, SE3>& output);
+		void Finish();
+
+		inline int GetLoops() { return _loops; }
+	private:
+		void Work(PerfSession * session);
+		void Process(Keyframe * keyframe);
+		PlaceEntry * Describe(Keyframe * keyframe);
+		void TrainVocabulary();
+		void Detect(int entry, vector<int>& words);
+		bool Verify(PlaceEntry * candidate, PlaceEntry * current, SE3& measurement);
+		void Publish();
+	};
+}
@@ -22,16 +22,46 @@ using namespace NVL_App;
  */
 Mat MapMerger::Merge(Mat& map1, Mat& map2, Mat& counters)
 {
-	// Validate the sizes
+	Mat result; Merge(map1, map2, counters, result);
+	return result;
+}
+
+/**
+ * @brief The logic for merging maps into an existing buffer
+ * @param map1 The first map that we are merging
+ * @param map2 The second map that we are merging
+ * @param counters The counters for defining the merge weights
+ * @param output The resultant map (may be the same buffer as map2, since the merge is per-pixel)
+ */
+void MapMerger::Merge(Mat& map1, Mat& map2, Mat& counters, Mat& output)
+{
+	auto perf = PerfScope("map_merge");
+
+	// Validate the sizes and formats
 	assert(map1.rows == map2.rows && map1.cols == map2.cols);
+	if (map1.type() != map2.type()) throw runtime_error("The depth maps being merged must have the same format");
 
+	// Merge in the native format of the maps (16-bit millimetres or float)
+	if (map1.depth() == CV_16U) MergeMaps<ushort>(map1, map2, counters, output);
+	else MergeMaps<float>(map1, map2, counters, output);
+}
+
+/**
+ * @brief The per-pixel merge for a given depth format (values are only promoted to float while averaging)
+ * @param map1 The first map that we are merging
+ * @param map2 The second map that we are merging
+ * @param counters The counters for defining the merge weights
+ * @param output The resultant map
+ */
+template <typename T> void MapMerger::MergeMaps(Mat& map1, Mat& map2, Mat& counters, Mat& output)
+{
 	// Create a result map
-	Mat result = Mat_<float>::zeros(map1.size());
-	auto result_data = (float *) result.data;
+	output.create(map1.size(), map1.type());
+	auto result_data = (T *) output.data;
 
 	// Create the handles for extracting data
-	auto map1_data = (float *) map1.data;
-	auto map2_data = (float *) map2.data;
+	auto map1_data = (T *) map1.data;
+	auto map2_data = (T *) map2.data;
 
 	// Perform update logic	
 	for (auto row = 0; row < map1.rows; row++) 
@@ -54,7 +84,7 @@ Mat MapMerger::Merge(Mat& map1, Mat& map2, Mat& counters)
 			// If neither value is valid then just return
 			if (!valid_1 && !valid_2) 
 			{			
-				continue;
+				result_data[index] = 0; continue;
 			}
 
 			// Handle the various other cases
@@ -62,16 +92,13 @@ Mat MapMerger::Merge(Mat& map1, Mat& map2, Mat& counters)
 			else if (!valid_1 && valid_2) { result_data[index] = Z_2; count = 1; }
 			else 
 			{
-				auto combinedZ = (Z_1 * count + Z_2) / (count + 1);
+				auto combinedZ = ((float)Z_1 * count + Z_2) / (count + 1);
 				count = count + 1;
-				result_data[index] = combinedZ;
+				result_data[index] = saturate_cast<T>(combinedZ);
 			}
 			
 			// Update the counter
 			counters.data[index] = min(count, 20);
 		}
 	}
-
-	// Return the result
-	return result;
 }
@@ -14,13 +14,17 @@ using namespace std;
 #include <opencv2/opencv.hpp>
 using namespace cv;
 
+#include "PerfCounters.h"
+
 namespace NVL_App
 {
 	class MapMerger
 	{
 	public:
 		static Mat Merge(Mat& map1, Mat& map2, Mat& counters);
+		static void Merge(Mat& map1, Mat& map2, Mat& counters, Mat& output);
 	private:
+		template <typename T> static void MergeMaps(Mat& map1, Mat& map2, Mat& counters, Mat& output);
 
 		inline static bool IsValid(float Z) 
 		{
@@ -0,0 +1,570 @@
+//--------------------------------------------------
+// Implementation of class Odometry
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "Odometry.h"
+using namespace NVL_App;
+
+// The number of frames that the feature precompute holds at once (per worker)
+#define PRECOMPUTE_FRAMES 4
+
+// The step sizes of the perturbed refinement seeds (radians and millimetres)
+#define HYPOTHESIS_ROTATION 0.01
+#define HYPOTHESIS_TRANSLATION 10.0
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor
+ * @param logger The logger that we are using for the system
+ * @param parameters The parameters that configure the pipeline
+ * @param calibration The calibration of the camera
+ * @param size The resolution of the frames that will be pushed
+ */
+Odometry::Odometry(NVLib::Logger * logger, NVLib::Parameters * parameters, Calibration * calibration, const Size& size) :
+	_logger(logger), _calibration(calibration), _size(size), _workIndex(0), _tracker(nullptr), _cache(nullptr), _features(nullptr), _held(nullptr), _reference(nullptr),
+	_trackReference(nullptr), _referenceIndex(-1), _trackedCount(0), _pushCount(0)
+{
+	_camera = _calibration->GetMatrix();
+
+	_logger->Log(1, "Setting up the processing resolution");
+	_scale = ArgUtils::GetInteger(parameters, "process_scale");
+	if (_scale < 1 || size.width % _scale != 0 || size.height % _scale != 0) throw runtime_error("The process scale must be a positive divisor of the frame size");
+	_fuseFull = _scale == 1 || ArgUtils::GetBoolean(parameters, "fuse_full_resolution");
+	_workSize = Size(size.width / _scale, size.height / _scale);
+	_workCalibration = _scale == 1 ? _calibration : GetScaledCalibration(_calibration, _scale);
+	_workCamera = _workCalibration->GetMatrix();
+	for (auto i = 0; i < 2; i++) { Mat color, depth; _workFrames[i] = _scale == 1 ? nullptr : new NVLib::DepthFrame(color, depth); }
+
+	_logger->Log(1, "Allocating the frame buffers");
+	auto fusionSize = _fuseFull ? size : _workSize;
+	_poseImage = new PoseImage(_workCamera, _workSize); _refiner = new PhotoMatcher(_poseImage);
+	_fusionImage = _fuseFull && _scale > 1 ? new PoseImage(_camera, size) : _poseImage;
+	_counter = Mat_<uchar>(fusionSize); _counter.setTo(1); _nextCounter = Mat_<uchar>(fusionSize);
+	_controller = new LatencyController(ArgUtils::GetDouble(parameters, "latency_budget_ms"));
+
+	_logger->Log(1, "Starting the local bundle adjustment");
+	auto windowSize = ArgUtils::GetInteger(parameters, "ba_window"); _keyframeInterval = max(ArgUtils::GetInteger(parameters, "keyframe_interval"), 1);
+	_adjuster = windowSize > 0 ? new BundleAdjuster(_workCalibration, windowSize, ArgUtils::GetInteger(parameters, "ba_iterations")) : nullptr;
+
+	_logger->Log(1, "Starting the loop closure");
+	_loopCloser = !ArgUtils::GetBoolean(parameters, "loop_closure") ? nullptr : new LoopCloser(_workCalibration, ArgUtils::GetString(parameters, "place_vocabulary"),
+		ArgUtils::GetInteger(parameters, "place_training_keyframes"), ArgUtils::GetInteger(parameters, "place_features"),
+		ArgUtils::GetInteger(parameters, "place_min_gap"), ArgUtils::GetInteger(parameters, "place_min_inliers"));
+
+	auto referenceCount = ArgUtils::GetInteger(parameters, "reloc_references");
+	_relocalizer = referenceCount <= 0 ? nullptr : new Relocalizer(_workCalibration, referenceCount, ArgUtils::GetInteger(parameters, "reloc_candidates"),
+		ArgUtils::GetDouble(parameters, "reloc_budget_ms"), ArgUtils::GetInteger(parameters, "reloc_min_inliers"));
+
+	_logger->Log(1, "Setting up the tracker");
+	_landmarks = ArgUtils::GetBoolean(parameters, "landmark_map") ? new LandmarkMap(ArgUtils::GetInteger(parameters, "landmark_max_age")) : nullptr;
+	_trackerMode = ArgUtils::GetString(parameters, "tracker_mode");
+	if (_trackerMode != "feature" && _trackerMode != "icp" && _trackerMode != "hybrid") throw runtime_error("Unknown tracker mode: " + _trackerMode);
+	auto schedule = IcpTracker::ParseSchedule(ArgUtils::GetString(parameters, "icp_iterations"));
+	_icp = _trackerMode == "feature" ? nullptr : new IcpTracker(_workCalibration, _workSize, schedule, ArgUtils::GetInteger(parameters, "icp_threads"));
+
+	_logger->Log(1, "Setting up the refiner");
+	auto refineMode = ArgUtils::GetString(parameters, "refine_mode");
+	if (refineMode != "photometric" && refineMode != "joint") throw runtime_error("Unknown refine mode: " + refineMode);
+	_jointRefine = refineMode == "joint"; _jointIterations = ArgUtils::GetInteger(parameters, "refine_joint_iterations");
+	_refiner->SetDepthWeight(_jointRefine ? ArgUtils::GetDouble(parameters, "refine_depth_weight") : 0);
+	_refineSolver = ArgUtils::GetString(parameters, "refine_solver");
+	if (_refineSolver != "lm" && _refineSolver != "ic") throw runtime_error("Unknown refine solver: " + _refineSolver);
+	_alignIterations = ArgUtils::GetInteger(parameters, "refine_ic_iterations");
+	_hypotheses = ArgUtils::GetInteger(parameters, "refine_hypotheses");
+}
+
+/**
+ * @brief Main Terminator
+ */
+Odometry::~Odometry()
+{
+	Finish();
+
+	delete _tracker; delete _refiner; delete _poseImage; delete _controller;
+	if (_relocalizer != nullptr) delete _relocalizer;
+	if (_icp != nullptr) delete _icp;
+	if (_landmarks != nullptr) delete _landmarks;
+	if (_cache != nullptr) 
+	{
+		_logger->Log(1, "Stage cache hits: %i, misses: %i", _cache->GetHits(), _cache->GetMisses());
+		delete _cache;
+	}
+	if (_features != nullptr)
+	{
+		_logger->Log(1, "Precomputed feature hits: %i, misses: %i", _features->GetHits(), _features->GetMisses());
+		delete _features;
+	}
+	if (_trackReference != _reference) delete _trackReference;
+	if (_reference != nullptr) delete _reference;
+	if (_fusionImage != _poseImage) delete _fusionImage;
+	if (_workCalibration != _calibration) delete _workCalibration;
+	for (auto frame : _workFrames) if (frame != nullptr) delete frame;
+}
+
+/**
+ * @brief Cache the feature tracking stages on disk (see StageCache), so that re-runs of the same sequence can skip them.
+ * The processing resolution is added to the sequence, so that a change of scale does not replay stale keypoints
+ * @param folder The folder of the cache
+ * @param sequence A description that identifies the frames (their source, path and calibration)
+ */
+void Odometry::EnableCache(const string& folder, const string& sequence)
+{
+	_logger->Log(1, "Using the stage cache: %s", folder.c_str());
+	if (_cache != nullptr) delete _cache;
+	_cache = new StageCache(folder, GetSequence(sequence));
+	if (_tracker != nullptr) _tracker->SetCache(_cache);
+}
+
+/**
+ * @brief Detect the keypoints of a whole sequence up front, spread across a thread pool, and use them in place of 
+ * the detection within the tracking loop. The keypoints are kept in a feature file, which later runs reuse as long
+ * as it was built from the same sequence, at the same resolution and with the same detection settings (otherwise it 
+ * is rebuilt). Frames whose settings do not match the file (e.g. when the latency controller drops the quality) are
+ * detected as usual
+ * @param source A source of the same frames that will be pushed (which is read to the end)
+ * @param sequence A description that identifies the frames (as given to EnableCache)
+ * @param path The path of the feature file
+ * @param threads The number of worker threads (0 for one per hardware thread)
+ */
+void Odometry::PrecomputeFeatures(FrameSource * source, const string& sequence, const string& path, int threads)
+{
+	auto settings = _controller->GetSettings(); auto key = FastTracker::GetDetectionKey(settings);
+	auto identity = GetSequence(sequence); auto sourceKey = StageCache::Hash(identity.data(), identity.size());
+
+	if (FeatureFile::IsCurrent(path, key, sourceKey, _workSize, source->GetFrameCount())) _logger->Log(1, "Using the feature file: %s", path.c_str());
+	else
+	{
+		_logger->Log(1, "Precomputing the features into: %s", path.c_str());
+		auto start = chrono::steady_clock::now();
+		auto writer = FeatureWriter(path, key, sourceKey, _workSize); auto pool = ThreadPool(threads);
+		auto limit = pool.GetThreadCount() * PRECOMPUTE_FRAMES;
+		auto frames = vector<SourceFrame>(limit); auto keypoints = vector< vector<KeyPoint> >(limit);
+
+		// Detection starts as soon as a frame is loaded, and the batch is written out (in order) once it is full
+		auto more = true;
+		while (more)
+		{
+			auto count = 0;
+			while (count < limit && (more = source->Next(frames[count])))
+			{
+				auto slot = count++;
+				pool.Submit([this, &frames, &keypoints, &settings, slot]() { DetectFeatures(frames[slot].GetFrame(), settings, keypoints[slot]); });
+			}
+			pool.Wait();
+
+			for (auto i = 0; i < count; i++) { writer.Write(frames[i].GetIndex(), keypoints[i]); source->Release(frames[i].GetFrame()); }
+		}
+
+		writer.Close();
+		_logger->Log(1, "Precomputed the features of %i frames in %f ms", writer.GetFrameCount(), GetElapsed(start));
+	}
+
+	if (_features != nullptr) delete _features;
+	_features = new FeatureFile(path);
+	if (_tracker != nullptr) _tracker->SetFeatures(_features);
+}
+
+//--------------------------------------------------
+// Push
+//--------------------------------------------------
+
+/**
+ * @brief Process the next frame of the sequence. The frame is handed back through the release callback once the
+ * session no longer needs it (immediately if it could not be tracked, otherwise when the next frame replaces it)
+ * @param current The frame, along with its index and timestamp
+ * @return OdometryResult& The result (which is only valid until the next push)
+ */
+OdometryResult& Odometry::Push(SourceFrame& current)
+{
+	_pushCount++;
+	auto start = chrono::steady_clock::now();
+	_result = OdometryResult(); _result.GetIndex() = current.GetIndex(); _result.GetTimestamp() = current.GetTimestamp();
+
+	// The first frame just becomes the reference
+	if (_tracker == nullptr) { Start(current); Complete(current, start); return _result; }
+
+	_logger->Log(1, "Processing frame: %i", current.GetIndex());
+	_controller->StartFrame(); _tracker->SetQuality(_controller->GetSettings());
+	if (_cache != nullptr) _cache->Begin(current.GetIndex(), _referenceIndex);
+	if (_features != nullptr) _features->Begin(current.GetIndex());
+
+	auto reduceStart = chrono::steady_clock::now();
+	auto frame = current.GetFrame(); auto work = Reduce(frame); auto pose = SE3(); auto relocalized = false;
+	if (_scale > 1) _controller->AddStage(PipelineStage::DETECT, GetElapsed(reduceStart));
+
+	if (!Track(work, pose, _result.GetError(), relocalized))
+	{
+		_logger->Log(1, "Tracking Failed");
+		_controller->EndFrame();
+		ReleaseFrame(frame); Complete(current, start);
+		return _result;
+	}
+
+	Refine(work, pose, relocalized);
+	Fuse(current, work, pose);
+
+	_result.GetTracked() = true; _result.GetRelocalized() = relocalized; _result.GetPose() = pose;
+	_controller->EndFrame(); Complete(current, start);
+	return _result;
+}
+
+/**
+ * @brief Process the next frame, given as caller owned buffers (which are wrapped, rather than copied). The depth
+ * is only read during the call, but the color is used as the tracking reference, so it must stay valid until the
+ * next push (or Finish) returns
+ * @param color The color image (BGR)
+ * @param depth The depth map (float or 16-bit millimetres)
+ * @param timestamp The time (in seconds) at which the frame was captured
+ * @return OdometryResult& The result (which is only valid until the next push)
+ */
+OdometryResult& Odometry::Push(Mat& color, Mat& depth, double timestamp)
+{
+	auto frame = new NVLib::DepthFrame(color, depth); _owned.insert(frame);
+	auto current = SourceFrame(_pushCount, timestamp, frame);
+	return Push(current);
+}
+
+/**
+ * @brief Wait for the background optimizations, apply their final corrections and hand back the reference frame
+ */
+void Odometry::Finish()
+{
+	if (_adjuster != nullptr)
+	{
+		_logger->Log(1, "Waiting for the final bundle adjustment");
+		_adjuster->Finish();
+		if (_adjuster->GetCorrections(_corrections)) _trajectory.Correct(_corrections);
+		_logger->Log(1, "Bundle adjustment windows optimized: %i", _adjuster->GetOptimizations());
+		delete _adjuster; _adjuster = nullptr;
+	}
+
+	if (_loopCloser != nullptr)
+	{
+		_logger->Log(1, "Waiting for the final loop closure checks");
+		_loopCloser->Finish();
+		if (_loopCloser->GetCorrections(_corrections)) _trajectory.Correct(_corrections);
+		_logger->Log(1, "Loops closed: %i", _loopCloser->GetLoops());
+		delete _loopCloser; _loopCloser = nullptr;
+	}
+
+	if (_held != nullptr) { ReleaseFrame(_held); _held = nullptr; }
+}
+
+//--------------------------------------------------
+// Pipeline Stages
+//--------------------------------------------------
+
+/**
+ * @brief Set up the session from the first frame
+ * @param current The first frame
+ */
+void Odometry::Start(SourceFrame& current)
+{
+	auto frame = current.GetFrame(); auto work = Reduce(frame);
+	auto fusionFrame = _fuseFull ? frame : work;
+	fusionFrame->GetDepth().copyTo(_fusedDepth); _warpedDepth = Mat(_fusedDepth.size(), _fusedDepth.type());
+
+	SetReference(frame, work, SE3());
+	_tracker = new FastTracker(_workCalibration, _trackReference); _tracker->SetCache(_cache); _tracker->SetLandmarks(_landmarks); _tracker->SetFeatures(_features);
+	if (_icp != nullptr) { _icp->SetFrame(work->GetDepth()); _icp->Accept(); }
+	_referenceIndex = current.GetIndex();
+
+	_result.GetTracked() = true;
+}
+
+/**
+ * @brief Build the reduced copy of a frame that tracking and refinement work on. The color is area averaged, while
+ * the depth takes the nearest sample (so that depths are never blended across an edge, or with invalid pixels).
+ * The copy goes into whichever of the two work frames is not holding the current reference
+ * @param frame The full resolution frame
+ * @return NVLib::DepthFrame * The reduced frame (or the frame itself when we are working at full resolution)
+ */
+NVLib::DepthFrame * Odometry::Reduce(NVLib::DepthFrame * frame)
+{
+	if (_scale == 1) return frame;
+
+	auto perf = PerfScope("reduce");
+	auto work = _workFrames[1 - _workIndex];
+	resize(frame->GetColor(), work->GetColor(), _workSize, 0, 0, INTER_AREA);
+	resize(frame->GetDepth(), work->GetDepth(), _workSize, 0, 0, INTER_NEAREST);
+	return work;
+}
+
+/**
+ * @brief Detect the keypoints of a frame as the tracker would (at the processing resolution). This runs on the 
+ * precompute workers, so it works on its own copies rather than the session buffers
+ * @param frame The frame that we are detecting within
+ * @param settings The quality settings that the detection uses
+ * @param keypoints The keypoints that were found
+ */
+void Odometry::DetectFeatures(NVLib::DepthFrame * frame, QualitySettings& settings, vector<KeyPoint>& keypoints)
+{
+	auto perf = PerfScope("precompute");
+
+	Mat color; if (_scale == 1) color = frame->GetColor();
+	else resize(frame->GetColor(), color, _workSize, 0, 0, INTER_AREA);
+
+	auto detector = FastDetector(FastTracker::BLOCK_SIZE); detector.SetQuality(settings);
+	keypoints.clear(); detector.Extract(color, keypoints);
+}
+
+/**
+ * @brief Estimate the pose of the frame relative to the reference (features first, then ICP, then relocalization)
+ * @param frame The frame that we are tracking
+ * @param pose The resultant pose
+ * @param error The reprojection error of the feature tracking
+ * @param relocalized Set if the pose came from relocalization
+ * @return true If the frame was tracked
+ */
+bool Odometry::Track(NVLib::DepthFrame * frame, SE3& pose, Vec2d& error, bool& relocalized)
+{
+	_keypoints.clear(); auto tracked = false;
+	if (_trackerMode != "icp")
+	{
+		pose = _tracker->GetPose(frame, _keypoints, error);
+		_controller->AddStage(PipelineStage::DETECT, _tracker->GetTimings()[0]);
+		_controller->AddStage(PipelineStage::MATCH, _tracker->GetTimings()[1]);
+		_controller->AddStage(PipelineStage::POSE, _tracker->GetTimings()[2]);
+
+		_logger->Log(2, "Reprojection error: %f +/- %f", error[0], error[1]);
+		if (_landmarks != nullptr) _logger->Log(1, "Landmark points: %i of %i", _tracker->GetLandmarkPoints(), _landmarks->GetCount());
+		tracked = error[0] <= 3;
+	}
+
+	if (_icp != nullptr)
+	{
+		auto start = chrono::steady_clock::now(); auto perf = PerfScope("icp"); _icp->SetFrame(frame->GetDepth());
+		if (!tracked && _icp->Track(pose))
+		{
+			_logger->Log(1, "Tracked with ICP (error: %f mm)", _icp->GetError());
+			_tracker->ClearMatches(); tracked = true;
+		}
+		_controller->AddStage(PipelineStage::POSE, GetElapsed(start));
+	}
+
+	if (!tracked && _relocalizer != nullptr)
+	{
+		_logger->Log(1, "Tracking Failed: relocalizing");
+		auto start = chrono::steady_clock::now(); auto perf = PerfScope("relocalize");
+		relocalized = _relocalizer->Relocalize(frame->GetColor(), _keypoints, _trajectory.GetOdometryPose(), pose);
+		_controller->AddStage(PipelineStage::POSE, GetElapsed(start));
+		if (relocalized) { _logger->Log(1, "Relocalized against keyframe: %i", _relocalizer->GetLastMatch()); _tracker->ClearMatches(); }
+	}
+
+	return tracked || relocalized;
+}
+
+/**
+ * @brief Refine the pose against the reference (within what is left of the latency budget) and add it to the trajectory
+ * @param frame The frame that we are tracking
+ * @param pose The pose that we are refining
+ * @param relocalized Whether the pose came from relocalization (in which case it is too far off to refine)
+ */
+void Odometry::Refine(NVLib::DepthFrame * frame, SE3& pose, bool relocalized)
+{
+	_logger->Log(1, "Creating a pose image");
+	auto start = chrono::steady_clock::now(); auto perf = PerfScope("refine");
+	_poseImage->SetFrame(_tracker->GetFrame());
+
+	auto refineSettings = _controller->GetSettings(); refineSettings.GetRefineIterations() = _controller->GetRefineBudget();
+	if (_refineSolver == "ic") refineSettings.GetRefineIterations() = min(refineSettings.GetRefineIterations(), _alignIterations);
+	else if (_jointRefine) refineSettings.GetRefineIterations() = min(refineSettings.GetRefineIterations(), _jointIterations);
+	if (refineSettings.GetRefineIterations() > 0 && !relocalized)
+	{
+		_logger->Log(1, "Refining pose");
+		_refiner->SetQuality(refineSettings);
+		if (_hypotheses > 0) pose = SelectSeed(frame, pose);
+		if (_refineSolver == "ic") pose = _refiner->Align(pose, frame->GetColor());
+		else pose = _refiner->Refine(pose, frame->GetColor(), frame->GetDepth());
+		_controller->AddRefineCost(GetElapsed(start), _refiner->GetEvaluations());
+	}
+	else _logger->Log(1, "Skipping refinement to stay within the latency budget");
+	_trajectory.AddPose(pose); _lastPose = pose;
+	_controller->AddStage(PipelineStage::REFINE, GetElapsed(start));
+}
+
+/**
+ * @brief Choose the pose that the refinement starts from. The tracked pose is scored against the constant velocity
+ * prediction (the motion of the last frame), no motion at all and small perturbations of the tracked pose, and the
+ * best scoring one wins. This catches the frames where the tracker has settled on the wrong side of an ambiguity
+ * @param frame The frame that we are tracking
+ * @param pose The tracked pose
+ * @return SE3 The best candidate
+ */
+SE3 Odometry::SelectSeed(NVLib::DepthFrame * frame, const SE3& pose)
+{
+	auto candidates = vector<SE3> { pose, _lastPose, SE3() };
+	for (auto i = 0; (int)candidates.size() < _hypotheses; i++)
+	{
+		auto delta = Vec6d(); auto magnitude = (i / 12 + 1) * ((i / 6) % 2 == 0 ? 1.0 : -1.0);
+		delta[i % 6] = magnitude * (i % 6 < 3 ? HYPOTHESIS_ROTATION : HYPOTHESIS_TRANSLATION);
+		candidates.push_back(pose * SE3::Exp(delta));
+	}
+	candidates.resize(_hypotheses);
+
+	auto best = _refiner->Select(candidates, frame->GetColor(), frame->GetDepth());
+	if (best > 0) _logger->Log(1, "Refining from hypothesis %i of %i", best, (int)candidates.size());
+	return best < 0 ? pose : candidates[best];
+}
+
+/**
+ * @brief Fuse the warped reference depth with the frame and make the frame the new reference. The fused depth is
+ * written into the session buffer, so the depth of the frame itself is left untouched
+ * @param current The frame that we are fusing
+ * @param work The reduced copy of the frame (or the frame itself when we are working at full resolution)
+ * @param pose The pose of the frame relative to the reference
+ */
+void Odometry::Fuse(SourceFrame& current, NVLib::DepthFrame * work, const SE3& pose)
+{
+	_logger->Log(1, "Setting the new frame");
+	auto start = chrono::steady_clock::now(); auto perf = PerfScope("fuse"); auto frame = current.GetFrame();
+	auto fusionFrame = _fuseFull ? frame : work;
+	if (_fusionImage != _poseImage) _fusionImage->SetFrame(_reference);
+	_fusionImage->Warp(pose, _counter, _warpedDepth, _nextCounter); swap(_counter, _nextCounter);
+	MapMerger::Merge(_warpedDepth, fusionFrame->GetDepth(), _counter, _fusedDepth);
+
+	SetReference(frame, work, pose);
+	if (_icp != nullptr) _icp->Accept();
+	_referenceIndex = current.GetIndex(); _trackedCount++;
+
+	if (_trackedCount % _keyframeInterval == 0) AddKeyframes(work);
+	ApplyCorrections();
+	_controller->AddStage(PipelineStage::FUSE, GetElapsed(start));
+}
+
+/**
+ * @brief Make the frame the new reference: the full resolution reference (which is handed out) pairs the fused
+ * depth with the color that it was fused at, while the tracker gets the work resolution version of it. When fusion
+ * runs at the work resolution the full resolution frame is not needed any more, so it is released straight away
+ * @param frame The full resolution frame
+ * @param work The reduced copy of the frame (or the frame itself when we are working at full resolution)
+ * @param pose The pose of the frame relative to the previous reference
+ */
+void Odometry::SetReference(NVLib::DepthFrame * frame, NVLib::DepthFrame * work, const SE3& pose)
+{
+	auto previous = _reference; auto previousTrack = _trackReference; auto previousHeld = _held;
+
+	_reference = new NVLib::DepthFrame(_fuseFull ? frame->GetColor() : work->GetColor(), _fusedDepth);
+	if (work == frame || !_fuseFull) _trackReference = _reference;
+	else
+	{
+		resize(_fusedDepth, _workDepth, _workSize, 0, 0, INTER_NEAREST);
+		_trackReference = new NVLib::DepthFrame(work->GetColor(), _workDepth);
+	}
+	if (work != frame) _workIndex = 1 - _workIndex;
+
+	_held = _fuseFull ? frame : nullptr;
+	if (_tracker != nullptr) _tracker->UpdateNextFrame(_trackReference, _keypoints, pose, false);
+
+	if (previousTrack != previous) delete previousTrack;
+	if (previous != nullptr) delete previous;
+	if (previousHeld != nullptr) ReleaseFrame(previousHeld);
+	if (!_fuseFull) ReleaseFrame(frame);
+}
+
+/**
+ * @brief Hand the current reference to the background optimizers and the relocalizer as a keyframe
+ * @param frame The frame that has just become the reference
+ */
+void Odometry::AddKeyframes(NVLib::DepthFrame * frame)
+{
+	auto keyframeId = _trajectory.GetPoseCount() - 1;
+	if (_adjuster != nullptr) _adjuster->AddKeyframe(_tracker->CreateKeyframe(keyframeId, _trajectory.GetOdometryPose()));
+	if (_loopCloser != nullptr)
+	{
+		auto keyframe = _tracker->CreateKeyframe(keyframeId, _trajectory.GetOdometryPose());
+		keyframe->GetImage() = frame->GetColor().clone(); _loopCloser->AddKeyframe(keyframe);
+	}
+	if (_relocalizer != nullptr)
+	{
+		auto keyframe = _tracker->CreateKeyframe(keyframeId, _trajectory.GetOdometryPose());
+		keyframe->GetImage() = frame->GetColor(); _relocalizer->AddKeyframe(keyframe);
+	}
+}
+
+/**
+ * @brief Apply any corrections that the background optimizers have published
+ */
+void Odometry::ApplyCorrections()
+{
+	if (_adjuster != nullptr && _adjuster->GetCorrections(_corrections)) _trajectory.Correct(_corrections);
+	if (_loopCloser != nullptr && _loopCloser->GetCorrections(_corrections))
+	{
+		_logger->Log(1, "Closing a loop");
+		_trajectory.Correct(_corrections);
+		if (_adjuster != nullptr) _adjuster->Realign(_corrections);
+	}
+}
+
+//--------------------------------------------------
+// Helpers
+//--------------------------------------------------
+
+/**
+ * @brief Fill in the remaining details of the result and pass it to the callback
+ * @param current The frame that was processed
+ * @param start The time at which the processing started
+ */
+void Odometry::Complete(SourceFrame& current, chrono::steady_clock::time_point& start)
+{
+	_result.GetOdometry() = _trajectory.GetOdometryPose();
+	_result.GetQuality() = _controller->GetQuality();
+	_result.GetElapsed() = GetElapsed(start);
+	if (_callback) _callback(_result);
+}
+
+/**
+ * @brief Hand a frame back to its owner (frames that were wrapped around raw buffers are just deleted)
+ * @param frame The frame that we are releasing
+ */
+void Odometry::ReleaseFrame(NVLib::DepthFrame * frame)
+{
+	if (_owned.erase(frame) > 0) { delete frame; return; }
+	if (_release) _release(frame);
+}
+
+/**
+ * @brief Build the calibration of a reduced image (the focal lengths shrink with the image, and the principal point
+ * is mapped through the pixel centers, which is where area averaging puts the samples)
+ * @param calibration The full resolution calibration
+ * @param scale The factor that the image was reduced by
+ * @return Calibration * The reduced calibration (which the caller owns)
+ */
+Calibration * Odometry::GetScaledCalibration(Calibration * calibration, int scale)
+{
+	auto& focals = calibration->GetFocals(); auto& center = calibration->GetCenter();
+	auto scaledFocals = Vec2d(focals[0] / scale, focals[1] / scale);
+	auto scaledCenter = Point2d((center.x + 0.5) / scale - 0.5, (center.y + 0.5) / scale - 0.5);
+	return new Calibration(scaledFocals, scaledCenter);
+}
+
+/**
+ * @brief Extend a description of the frames with the resolution that they are processed at, so that the cached stages
+ * of one processing scale are not replayed at another
+ * @param sequence A description that identifies the frames
+ * @return string The description of the processed frames
+ */
+string Odometry::GetSequence(const string& sequence)
+{
+	auto result = stringstream(); result << sequence << "@" << _workSize.width << "x" << _workSize.height << "/" << _scale;
+	return result.str();
+}
+
+/**
+ * @brief Determine the time since the given start point, and reset the start point
+ * @param start The start point (updated to now)
+ * @return double The elapsed time in milliseconds
+ */
+double Odometry::GetElapsed(chrono::steady_clock::time_point& start)
+{
+	auto now = chrono::steady_clock::now();
+	auto elapsed = chrono::duration<double, milli>(now - start).count();
+	start = now; return elapsed;
+}
@@ -0,0 +1,179 @@
+//--------------------------------------------------
+// An embeddable odometry session: frames are pushed in one at a time and each push tracks, refines and fuses the
+// frame, returning the pose synchronously (and through an optional callback).
+//
+// Frames are used in place rather than copied. The color of the last tracked frame is kept as the tracking
+// reference, so the frame (or color buffer) that was pushed must stay valid until the session hands it back
+// through the release callback (for frames pushed as raw buffers: until the next push, or Finish, returns)
+//
+// Tracking and refinement can run on a reduced copy of each frame (process_scale), with the intrinsics scaled to
+// match. Fusion, and so the reference frame that is handed out, either stays at full resolution or drops to the
+// reduced one as well (fuse_full_resolution)
+//
+// For offline runs, the keypoints of the whole sequence can be detected up front, in parallel, into a feature file
+// (PrecomputeFeatures), which leaves matching, pose estimation, refinement and fusion on the sequential path
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <set>
+#include <chrono>
+#include <functional>
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include <NVLib/Logger.h>
+#include <NVLib/Model/DepthFrame.h>
+
+#include "ArgUtils.h"
+#include "Calibration.h"
+#include "FrameSource.h"
+#include "FastTracker.h"
+#include "PoseImage.h"
+#include "PhotoMatcher.h"
+#include "MapMerger.h"
+#include "Trajectory.h"
+#include "LatencyController.h"
+#include "BundleAdjuster.h"
+#include "LoopCloser.h"
+#include "Relocalizer.h"
+#include "IcpTracker.h"
+#include "StageCache.h"
+#include "LandmarkMap.h"
+#include "ThreadPool.h"
+#include "FeatureFile.h"
+#include "FeatureWriter.h"
+#include "PerfCounters.h"
+
+namespace NVL_App
+{
+	class OdometryResult
+	{
+	private:
+		int _index;
+		double _timestamp;
+		bool _tracked;
+		bool _relocalized;
+		SE3 _pose;
+		SE3 _odometry;
+		Vec2d _error;
+		double _quality;
+		double _elapsed;
+	public:
+		OdometryResult() : _index(-1), _timestamp(0), _tracked(false), _relocalized(false), _quality(1), _elapsed(0) {}
+
+		inline int& GetIndex() { return _index; }
+		inline double& GetTimestamp() { return _timestamp; }
+		inline bool& GetTracked() { return _tracked; }
+		inline bool& GetRelocalized() { return _relocalized; }
+		inline SE3& GetPose() { return _pose; }
+		inline SE3& GetOdometry() { return _odometry; }
+		inline Vec2d& GetError() { return _error; }
+		inline double& GetQuality() { return _quality; }
+		inline double& GetElapsed() { return _elapsed; }
+	};
+
+	class Odometry
+	{
+	private:
+		NVLib::Logger * _logger;
+		Calibration * _calibration;
+		Mat _camera;
+		Size _size;
+
+		int _scale;
+		bool _fuseFull;
+		Size _workSize;
+		Mat _workCamera;
+		Calibration * _workCalibration;
+		NVLib::DepthFrame * _workFrames[2];
+		int _workIndex;
+
+		string _trackerMode;
+		string _refineSolver;
+		bool _jointRefine;
+		int _jointIterations;
+		int _alignIterations;
+		int _hypotheses;
+		SE3 _lastPose;
+		int _keyframeInterval;
+
+		FastTracker * _tracker;
+		PoseImage * _poseImage;
+		PoseImage * _fusionImage;
+		PhotoMatcher * _refiner;
+		LatencyController * _controller;
+		BundleAdjuster * _adjuster;
+		LoopCloser * _loopCloser;
+		Relocalizer * _relocalizer;
+		IcpTracker * _icp;
+		StageCache * _cache;
+		LandmarkMap * _landmarks;
+		FeatureFile * _features;
+
+		Trajectory _trajectory;
+		map<int, SE3> _corrections;
+		vector<KeyPoint> _keypoints;
+		Mat _counter;
+		Mat _nextCounter;
+		Mat _warpedDepth;
+		Mat _fusedDepth;
+		Mat _workDepth;
+
+		NVLib::DepthFrame * _held;
+		NVLib::DepthFrame * _reference;
+		NVLib::DepthFrame * _trackReference;
+		set<NVLib::DepthFrame *> _owned;
+		int _referenceIndex;
+		int _trackedCount;
+		int _pushCount;
+
+		OdometryResult _result;
+		function<void(OdometryResult&)> _callback;
+		function<void(NVLib::DepthFrame *)> _release;
+	public:
+		Odometry(NVLib::Logger * logger, NVLib::Parameters * parameters, Calibration * calibration, const Size& size);
+		~Odometry();
+
+		void EnableCache(const string& folder, const string& sequence);
+		void PrecomputeFeatures(FrameSource * source, const string& sequence, const string& path, int threads);
+
+		OdometryResult& Push(SourceFrame& frame);
+		OdometryResult& Push(Mat& color, Mat& depth, double timestamp);
+		void Finish();
+
+		inline void SetCallback(function<void(OdometryResult&)> callback) { _callback = callback; }
+		inline void SetRelease(function<void(NVLib::DepthFrame *)> release) { _release = release; }
+
+		inline const Mat& GetFusedDepth() const { return _fusedDepth; }
+		inline NVLib::DepthFrame * GetFrame() { return _reference; }
+		inline Trajectory& GetTrajectory() { return _trajectory; }
+		inline LatencyController& GetController() { return *_controller; }
+		inline int GetTrackedCount() { return _trackedCount; }
+		inline int GetScale() { return _scale; }
+		inline Size& GetWorkSize() { return _workSize; }
+	private:
+		void Start(SourceFrame& frame);
+		NVLib::DepthFrame * Reduce(NVLib::DepthFrame * frame);
+		void DetectFeatures(NVLib::DepthFrame * frame, QualitySettings& settings, vector<KeyPoint>& keypoints);
+		bool Track(NVLib::DepthFrame * frame, SE3& pose, Vec2d& error, bool& relocalized);
+		void Refine(NVLib::DepthFrame * frame, SE3& pose, bool relocalized);
+		SE3 SelectSeed(NVLib::DepthFrame * frame, const SE3& pose);
+		void Fuse(SourceFrame& current, NVLib::DepthFrame * work, const SE3& pose);
+		void SetReference(NVLib::DepthFrame * frame, NVLib::DepthFrame * work, const SE3& pose);
+		void AddKeyframes(NVLib::DepthFrame * frame);
+		void ApplyCorrections();
+		void Complete(SourceFrame& frame, chrono::steady_clock::time_point& start);
+		void ReleaseFrame(NVLib::DepthFrame * frame);
+		string GetSequence(const string& sequence);
+		static Calibration * GetScaledCalibration(Calibration * calibration, int scale);
+		static double GetElapsed(chrono::steady_clock::time_point& start);
+	};
+}
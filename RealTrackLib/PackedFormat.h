@@ -0,0 +1,64 @@
+//--------------------------------------------------
+// Describes the layout of a packed sequence file
+//
+// A packed file is a PackedHeader followed by FrameCount fixed-size records.
+// Each record is a double timestamp (seconds), the raw color pixels
+// (Width x Height x 3 bytes) and then the raw depth pixels, so any frame can be
+// found with a single seek.
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+namespace NVL_App
+{
+	struct PackedHeader
+	{
+		char Magic[4];
+		uint32_t Version;
+		uint32_t Width;
+		uint32_t Height;
+		uint32_t ColorType;
+		uint32_t DepthType;
+		uint32_t FrameCount;
+		uint32_t Reserved;
+		double FrameRate;
+	};
+
+	class PackedFormat
+	{
+	public:
+		static constexpr uint32_t VERSION = 1;
+
+		/**
+		 * @brief Determine whether the header is one that we know how to read
+		 * @param header The header that we are validating
+		 * @return true If the header is valid
+		 */
+		static inline bool IsValid(const PackedHeader& header) 
+		{
+			return header.Magic[0] == 'R' && header.Magic[1] == 'T' && header.Magic[2] == 'P' && header.Magic[3] == 'K' && header.Version == VERSION;
+		}
+
+		/**
+		 * @brief Determine the number of bytes occupied by a single frame record
+		 * @param header The header describing the file
+		 * @return size_t The size of the record in bytes
+		 */
+		static inline size_t GetRecordSize(const PackedHeader& header) 
+		{
+			auto pixels = (size_t)header.Width * header.Height;
+			return sizeof(double) + pixels * CV_ELEM_SIZE(header.ColorType) + pixels * CV_ELEM_SIZE(header.DepthType);
+		}
+	};
+}
@@ -0,0 +1,84 @@
+//--------------------------------------------------
+// Implementation of class PackedSource
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "PackedSource.h"
+using namespace NVL_App;
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor
+ * @param path The path to the packed file
+ * @param poolSize The number of frame buffers that we allocate up front
+ * @param depthType The depth type that the frames hold (records stored in another format are converted)
+ */
+PackedSource::PackedSource(const string& path, int poolSize, int depthType) : _next(0)
+{
+	_reader.open(path, ios::binary);
+	if (!_reader.is_open()) throw runtime_error("Unable to open file: " + path);
+
+	_reader.read((char *)&_header, sizeof(PackedHeader));
+	if (!_reader || !PackedFormat::IsValid(_header)) throw runtime_error("The file is not a valid packed sequence: " + path);
+	if (_header.ColorType != CV_8UC3) throw runtime_error("Packed sequences are expected to hold 8-bit BGR color images");
+
+	_pool = new FramePool(GetSize(), poolSize, depthType);
+}
+
+/**
+ * @brief Main Terminator
+ */
+PackedSource::~PackedSource()
+{
+	delete _pool;
+}
+
+//--------------------------------------------------
+// Frame Retrieval
+//--------------------------------------------------
+
+/**
+ * @brief Read the next record straight into a pooled frame
+ * @param output The frame that was loaded
+ * @return true If a frame was loaded
+ * @return false If we have run out of frames
+ */
+bool PackedSource::Next(SourceFrame& output)
+{
+	if (_next >= (int)_header.FrameCount) return false;
+
+	auto frame = _pool->Acquire();
+	auto& color = frame->GetColor();
+
+	// Records in the pool format are read in place, anything else goes through the scratch buffer
+	auto direct = (int)_header.DepthType == _pool->GetDepthType();
+	auto& depth = direct ? frame->GetDepth() : _depthBuffer;
+	depth.create(GetSize(), _header.DepthType);
+
+	auto timestamp = 0.0;
+	_reader.read((char *)&timestamp, sizeof(double));
+	_reader.read((char *)color.data, color.total() * color.elemSize());
+	_reader.read((char *)depth.data, depth.total() * depth.elemSize());
+	if (!_reader) { _pool->Release(frame); throw runtime_error("The packed sequence ended unexpectedly"); }
+	if (!direct) depth.convertTo(frame->GetDepth(), _pool->GetDepthType());
+
+	output = SourceFrame(_next, timestamp, frame);
+	_next++;
+
+	return true;
+}
+
+/**
+ * @brief Hand the frame back to the pool
+ * @param frame The frame that we are releasing
+ */
+void PackedSource::Release(NVLib::DepthFrame * frame)
+{
+	_pool->Release(frame);
+}
@@ -0,0 +1,43 @@
+//--------------------------------------------------
+// A frame source that reads frames from a packed sequence file
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <fstream>
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include "FramePool.h"
+#include "FrameSource.h"
+#include "PackedFormat.h"
+
+namespace NVL_App
+{
+	class PackedSource : public FrameSource
+	{
+	private:
+		ifstream _reader;
+		PackedHeader _header;
+		int _next;
+		FramePool * _pool;
+		Mat _depthBuffer;
+	public:
+		PackedSource(const string& path, int poolSize, int depthType);
+		~PackedSource();
+
+		bool Next(SourceFrame& output) override;
+		void Release(NVLib::DepthFrame * frame) override;
+
+		inline Size GetSize() override { return Size(_header.Width, _header.Height); }
+		inline int GetFrameCount() override { return (int)_header.FrameCount; }
+		inline double GetFrameRate() { return _header.FrameRate; }
+	};
+}
@@ -0,0 +1,79 @@
+//--------------------------------------------------
+// Implementation of class PackedWriter
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "PackedWriter.h"
+using namespace NVL_App;
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor
+ * @param path The path to the file that we are writing
+ * @param size The resolution of the frames
+ * @param depthType The OpenCV type of the depth maps
+ * @param frameRate The rate at which the frames were recorded
+ */
+PackedWriter::PackedWriter(const string& path, const Size& size, int depthType, double frameRate)
+{
+	_writer.open(path, ios::binary | ios::trunc);
+	if (!_writer.is_open()) throw runtime_error("Unable to open file: " + path);
+
+	_header = PackedHeader();
+	_header.Magic[0] = 'R'; _header.Magic[1] = 'T'; _header.Magic[2] = 'P'; _header.Magic[3] = 'K';
+	_header.Version = PackedFormat::VERSION;
+	_header.Width = size.width; _header.Height = size.height;
+	_header.ColorType = CV_8UC3; _header.DepthType = depthType;
+	_header.FrameCount = 0; _header.FrameRate = frameRate;
+
+	_writer.write((char *)&_header, sizeof(PackedHeader));
+}
+
+/**
+ * @brief Main Terminator
+ */
+PackedWriter::~PackedWriter()
+{
+	Close();
+}
+
+//--------------------------------------------------
+// Write
+//--------------------------------------------------
+
+/**
+ * @brief Append a frame to the file
+ * @param frame The frame that we are writing
+ * @param timestamp The time (in seconds) at which the frame was captured
+ */
+void PackedWriter::Write(NVLib::DepthFrame * frame, double timestamp)
+{
+	auto& color = frame->GetColor(); auto& depth = frame->GetDepth();
+
+	if (color.cols != (int)_header.Width || color.rows != (int)_header.Height || color.type() != (int)_header.ColorType) throw runtime_error("The color image does not match the packed file layout");
+	if (depth.cols != (int)_header.Width || depth.rows != (int)_header.Height || depth.type() != (int)_header.DepthType) throw runtime_error("The depth map does not match the packed file layout");
+	if (!color.isContinuous() || !depth.isContinuous()) throw runtime_error("Only continuous images can be written to a packed file");
+
+	_writer.write((char *)&timestamp, sizeof(double));
+	_writer.write((char *)color.data, color.total() * color.elemSize());
+	_writer.write((char *)depth.data, depth.total() * depth.elemSize());
+	_header.FrameCount++;
+}
+
+/**
+ * @brief Patch the frame count into the header and close the file
+ */
+void PackedWriter::Close()
+{
+	if (!_writer.is_open()) return;
+
+	_writer.seekp(0, ios::beg);
+	_writer.write((char *)&_header, sizeof(PackedHeader));
+	_writer.close();
+}
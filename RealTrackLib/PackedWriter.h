@@ -0,0 +1,38 @@
+//--------------------------------------------------
+// Writes a sequence of frames to a packed sequence file
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <fstream>
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include <NVLib/Model/DepthFrame.h>
+
+#include "PackedFormat.h"
+
+namespace NVL_App
+{
+	class PackedWriter
+	{
+	private:
+		ofstream _writer;
+		PackedHeader _header;
+	public:
+		PackedWriter(const string& path, const Size& size, int depthType, double frameRate);
+		~PackedWriter();
+
+		void Write(NVLib::DepthFrame * frame, double timestamp);
+		void Close();
+
+		inline int GetFrameCount() { return (int)_header.FrameCount; }
+	};
+}
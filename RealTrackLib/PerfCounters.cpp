@@ -0,0 +1,205 @@
+//--------------------------------------------------
+// Implementation of class PerfCounters
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "PerfCounters.h"
+using namespace NVL_App;
+
+//--------------------------------------------------
+// PerfGroup
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor: opens the counters of the calling thread as a group led by the cycle counter, so that
+ * they are scheduled together. A counter that the hardware does not provide is left out of the group
+ */
+PerfGroup::PerfGroup() : _count(0)
+{
+	for (auto i = 0; i < (int)PerfCounter::COUNT; i++) { _handles[i] = -1; _slots[i] = -1; }
+
+	_handles[0] = Open(PerfCounter::CYCLES, -1);
+	if (_handles[0] < 0) return;
+	_slots[0] = _count++;
+
+	for (auto i = 1; i < (int)PerfCounter::COUNT; i++)
+	{
+		_handles[i] = Open((PerfCounter)i, _handles[0]);
+		if (_handles[i] >= 0) _slots[i] = _count++;
+	}
+}
+
+/**
+ * @brief Main Terminator
+ */
+PerfGroup::~PerfGroup()
+{
+	for (auto handle : _handles) if (handle >= 0) close(handle);
+}
+
+/**
+ * @brief Read the current counts of the group (scaled up if the group was multiplexed with other events)
+ * @param sample The counts (counters that are not available read as zero)
+ * @return true If the group could be read
+ */
+bool PerfGroup::Read(PerfSample& sample)
+{
+	if (_count == 0) return false;
+
+	// The layout of a group read: count, time enabled, time running and then a value for each member
+	uint64_t buffer[3 + (int)PerfCounter::COUNT];
+	auto expected = (ssize_t)((3 + _count) * sizeof(uint64_t));
+	if (read(_handles[0], buffer, sizeof(buffer)) != expected) return false;
+
+	auto scale = buffer[2] > 0 && buffer[2] < buffer[1] ? (double)buffer[1] / buffer[2] : 1.0;
+	for (auto i = 0; i < (int)PerfCounter::COUNT; i++)
+	{
+		sample.GetValue((PerfCounter)i) = _slots[i] < 0 ? 0 : buffer[3 + _slots[i]] * scale;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Open a counter for the calling thread (user space only, so that it works under perf_event_paranoid 2)
+ * @param counter The counter that we are opening
+ * @param leader The handle of the group leader (or -1 to open a leader)
+ * @return int The handle (or -1 if the counter is not available)
+ */
+int PerfGroup::Open(PerfCounter counter, int leader)
+{
+	uint64_t configs[] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+
+	auto attributes = perf_event_attr(); memset(&attributes, 0, sizeof(perf_event_attr));
+	attributes.size = sizeof(perf_event_attr);
+	attributes.type = PERF_TYPE_HARDWARE;
+	attributes.config = configs[(int)counter];
+	attributes.exclude_kernel = 1; attributes.exclude_hv = 1;
+	attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	return (int)syscall(SYS_perf_event_open, &attributes, 0, -1, leader, 0);
+}
+
+//--------------------------------------------------
+// PerfSession
+//--------------------------------------------------
+
+/**
+ * @brief Add a measurement to the totals of the session
+ * @param key The key of the totals ("<stage>_<thread>")
+ * @param start The counts at the start of the measurement
+ * @param end The counts at the end of the measurement
+ */
+void PerfSession::Add(const string& key, PerfSample& start, PerfSample& end)
+{
+	lock_guard<mutex> guard(_lock);
+
+	auto& total = _totals[key];
+	for (auto i = 0; i < (int)PerfCounter::COUNT; i++)
+	{
+		auto counter = (PerfCounter)i;
+		total.GetValue(counter) += end.GetValue(counter) - start.GetValue(counter);
+	}
+	total.GetCalls()++;
+}
+
+/**
+ * @brief Retrieve a copy of the totals, keyed by "<stage>_<thread>"
+ * @return map<string, PerfSample> The totals
+ */
+map<string, PerfSample> PerfSession::GetTotals()
+{
+	lock_guard<mutex> guard(_lock);
+	return _totals;
+}
+
+//--------------------------------------------------
+// PerfCounters
+//--------------------------------------------------
+
+/**
+ * @brief Turn the instrumentation on (for every thread)
+ */
+void PerfCounters::Enable()
+{
+	_enabled = true;
+}
+
+/**
+ * @brief Determine whether the counters could be opened on the calling thread
+ * @return true If the counters are available
+ */
+bool PerfCounters::IsAvailable()
+{
+	return GetGroup()->IsOpen();
+}
+
+/**
+ * @brief Set the name that the measurements of the calling thread are totalled under
+ * @param name The name of the thread (e.g. "pool" for the workers of a thread pool)
+ */
+void PerfCounters::SetThreadName(const string& name)
+{
+	_threadName = name;
+}
+
+/**
+ * @brief Set the session that the measurements of the calling thread go into (see PerfSessionScope)
+ * @param session The session (or nullptr to stop collecting on the thread)
+ */
+void PerfCounters::SetSession(PerfSession * session)
+{
+	_session = session;
+}
+
+/**
+ * @brief Read the counters of the calling thread
+ * @param sample The current counts
+ * @return true If the counters are available
+ */
+bool PerfCounters::Read(PerfSample& sample)
+{
+	return GetGroup()->Read(sample);
+}
+
+/**
+ * @brief Add a measurement to the totals of a stage, within the session of the calling thread
+ * @param stage The name of the stage
+ * @param start The counts at the start of the measurement
+ * @param end The counts at the end of the measurement
+ */
+void PerfCounters::Add(const char * stage, PerfSample& start, PerfSample& end)
+{
+	if (_session != nullptr) _session->Add(string(stage) + "_" + _threadName, start, end);
+}
+
+/**
+ * @brief Retrieve a short name for a counter (used within the report keys)
+ * @param counter The counter that we want the name of
+ * @return const char * The name of the counter
+ */
+const char * PerfCounters::GetCounterName(PerfCounter counter)
+{
+	switch (counter)
+	{
+		case PerfCounter::CYCLES: return "cycles";
+		case PerfCounter::INSTRUCTIONS: return "instructions";
+		case PerfCounter::CACHE_MISSES: return "llc_misses";
+		case PerfCounter::BRANCH_MISSES: return "branch_misses";
+		default: return "unknown";
+	}
+}
+
+/**
+ * @brief Retrieve the counter group of the calling thread, opening it the first time round. The group lives for
+ * as long as the thread does
+ * @return PerfGroup * The group
+ */
+PerfGroup * PerfCounters::GetGroup()
+{
+	static thread_local auto group = PerfGroup();
+	return &group;
+}
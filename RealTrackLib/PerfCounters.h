@@ -0,0 +1,151 @@
+//--------------------------------------------------
+// Optional hardware counter instrumentation (cycles, instructions, last level cache misses and branch misses),
+// collected through perf_event_open for each thread and totalled per stage and per thread name.
+//
+// Each thread opens its own counter group the first time that it is measured, and a PerfScope measures the calling
+// thread between its construction and destruction. When the counters cannot be opened (e.g. within containers, or with a
+// restrictive perf_event_paranoid) the scopes do nothing, so the instrumentation can be left in place. Scopes can
+// nest (the kernels are measured within their stages).
+//
+// The totals go into the PerfSession that is current on the measuring thread, so that sessions that run side by side
+// (the sequences of a batch) each report only their own work. A session is made current with a PerfSessionScope, and 
+// the threads that a session starts (its pools and background workers) inherit the session of the thread that 
+// created them. Scopes on a thread without a session do nothing
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+using namespace std;
+
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+namespace NVL_App
+{
+	enum class PerfCounter { CYCLES = 0, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, COUNT };
+
+	class PerfSample
+	{
+	private:
+		double _values[(int)PerfCounter::COUNT];
+		int _calls;
+	public:
+		PerfSample() : _values{}, _calls(0) {}
+
+		inline double& GetValue(PerfCounter counter) { return _values[(int)counter]; }
+		inline int& GetCalls() { return _calls; }
+	};
+
+	class PerfGroup
+	{
+	private:
+		int _handles[(int)PerfCounter::COUNT];
+		int _slots[(int)PerfCounter::COUNT];
+		int _count;
+	public:
+		PerfGroup();
+		~PerfGroup();
+
+		bool Read(PerfSample& sample);
+
+		inline bool IsOpen() { return _count > 0; }
+	private:
+		static int Open(PerfCounter counter, int leader);
+	};
+
+	class PerfSession
+	{
+	private:
+		mutex _lock;
+		map<string, PerfSample> _totals;
+	public:
+		void Add(const string& key, PerfSample& start, PerfSample& end);
+		map<string, PerfSample> GetTotals();
+	};
+
+	class PerfCounters
+	{
+	private:
+		inline static atomic<bool> _enabled = false;
+		inline static thread_local string _threadName = "main";
+		inline static thread_local PerfSession * _session = nullptr;
+	public:
+		static void Enable();
+		static bool IsAvailable();
+		static void SetThreadName(const string& name);
+		static void SetSession(PerfSession * session);
+
+		static bool Read(PerfSample& sample);
+		static void Add(const char * stage, PerfSample& start, PerfSample& end);
+
+		static const char * GetCounterName(PerfCounter counter);
+
+		inline static bool IsEnabled() { return _enabled; }
+		inline static string& GetThreadName() { return _threadName; }
+		inline static PerfSession * GetSession() { return _session; }
+	private:
+		static PerfGroup * GetGroup();
+	};
+
+	class PerfSessionScope
+	{
+	private:
+		PerfSession * _previous;
+		string _previousName;
+	public:
+		/**
+		 * @brief Make a session current on the calling thread (until the scope ends)
+		 * @param session The session that the measurements of the thread go into
+		 * @param threadName The name that the measurements of the thread are totalled under
+		 */
+		inline PerfSessionScope(PerfSession * session, const string& threadName) : _previous(PerfCounters::GetSession()), _previousName(PerfCounters::GetThreadName())
+		{
+			PerfCounters::SetSession(session); PerfCounters::SetThreadName(threadName);
+		}
+
+		/**
+		 * @brief Restore the session (and the name) that the thread had before
+		 */
+		inline ~PerfSessionScope()
+		{
+			PerfCounters::SetSession(_previous); PerfCounters::SetThreadName(_previousName);
+		}
+	};
+
+	class PerfScope
+	{
+	private:
+		const char * _stage;
+		bool _active;
+		PerfSample _start;
+	public:
+		/**
+		 * @brief Start measuring the calling thread (nothing happens if the instrumentation is off)
+		 * @param stage The name of the stage that we are measuring
+		 */
+		inline PerfScope(const char * stage) : _stage(stage), _active(false)
+		{
+			if (PerfCounters::IsEnabled() && PerfCounters::GetSession() != nullptr) _active = PerfCounters::Read(_start);
+		}
+
+		/**
+		 * @brief Add what the thread has done since the start of the scope to the stage totals of its session
+		 */
+		inline ~PerfScope()
+		{
+			if (!_active) return;
+			auto end = PerfSample(); if (PerfCounters::Read(end)) PerfCounters::Add(_stage, _start, end);
+		}
+	};
+}
@@ -9,6 +9,10 @@
 #include "PhotoMatcher.h"
 using namespace NVL_App;
 
+// The alignment stops once an update is smaller than this (radians and millimetres)
+#define ALIGN_ROTATION_EPSILON 1e-5
+#define ALIGN_TRANSLATION_EPSILON 0.01
+
 //--------------------------------------------------
 // Constructors and Terminators
 //--------------------------------------------------
@@ -17,10 +21,7 @@ using namespace NVL_App;
  * @brief Custom Constructor
  * @param poseImage The photo image that we are tracking against
  */
-PhotoMatcher::PhotoMatcher(PoseImage * poseImage) : _poseImage(poseImage)
-{
-	_staticLink = this;
-}
+PhotoMatcher::PhotoMatcher(PoseImage * poseImage) : _depthWeight(0), _poseImage(poseImage), _stride(1), _evaluations(0) {}
 
 //--------------------------------------------------
 // Refinement
@@ -30,33 +31,104 @@ PhotoMatcher::PhotoMatcher(PoseImage * poseImage) : _poseImage(poseImage)
  * @brief Refine a pose estimation
  * @param initialPose The initial pose guess
  * @param matchImage The image that we are matching against
- * @return Mat Returns a Mat
+ * @return SE3 The refined pose
  */
-Mat PhotoMatcher::Refine(Mat& initialPose, Mat& matchImage)
+SE3 PhotoMatcher::Refine(const SE3& initialPose, Mat& matchImage)
 {
-	// Set the given start image
-	_testImage = matchImage;
+	Mat matchDepth; return Refine(initialPose, matchImage, matchDepth);
+}
 
-	// Setup descent parameters
-	int j, m, n, info, lwa, iwa[_poseImage->GetPixelCount()], one = 1;
+/**
+ * @brief Refine a pose estimation against both the color and the depth of the match frame (the depth residual is 
+ * only used when a depth weight has been set). The depth widens the basin of convergence, so that the refinement
+ * needs fewer evaluations and can recover from a poorer initial guess
+ * @param initialPose The initial pose guess
+ * @param matchImage The color image that we are matching against
+ * @param matchDepth The depth map that we are matching against (empty for a purely photometric refinement)
+ * @return SE3 The refined pose
+ */
+SE3 PhotoMatcher::Refine(const SE3& initialPose, Mat& matchImage, Mat& matchDepth)
+{
+	// Set the given start frame
+	_testDepth = matchDepth; _evaluations = 0;
+	if (matchImage.channels() == 3) cvtColor(matchImage, _testLuma, COLOR_BGR2GRAY); else _testLuma = matchImage;
 
-	m = 6; n = 6; lwa = (m * n) + (5 * n) + m;
+	// Setup descent parameters
+	int m = 6, n = 6, info, nfev, one = 1, mode = 1, nprint = 0, ipvt[6];
+	double x[6], fvec[6], diag[6], fjac[36], qtf[6], wa1[6], wa2[6], wa3[6], wa4[6];
+	double factor = 100, epsfcn = 0, gtol = 0;
 
-  	double x[n], fvec[m], wa[lwa]; 
-	  
 	// Initialize the variables  
 	Pose2Vector(initialPose, x);
 
 	// Generate tol
 	auto tol = sqrt(dpmpar_(&one));
 
-	// Perform the levenberg marquardt descent
-  	lmdif1_(&Callback, &m, &n, x, fvec, &tol, &info, iwa, wa, &lwa);
+	// Perform the levenberg marquardt descent (coarse to fine, splitting the evaluation budget across levels)
+	auto levels = max(_settings.GetPyramidLevels(), 1);
+	auto budget = _settings.GetRefineIterations();
+	for (auto level = levels - 1; level >= 0; level--) 
+	{
+		auto maxfev = budget / (level + 1); if (maxfev <= 0) continue;
+		_stride = _settings.GetPixelStride() << level;
+		_staticLink = this;
+		lmdif_(&Callback, &m, &n, x, fvec, &tol, &tol, &gtol, &maxfev, &epsfcn, diag, &mode, &factor, &nprint, &info, &nfev, fjac, &m, ipvt, qtf, wa1, wa2, wa3, wa4);
+		budget -= nfev;
+	}
 
 	// Final update of the result
-	Mat pose; 
-	Vector2Pose(x, pose);
-	return pose;
+	return Vector2Pose(x);
+}
+
+/**
+ * @brief Refine a pose estimation with an inverse compositional (photometric) alignment. The Jacobians and the 
+ * Hessian are precomputed by the pose image for its reference frame, so an iteration is a single cheap evaluation
+ * and the refinement iterations setting is used directly as the iteration cap
+ * @param initialPose The initial pose guess
+ * @param matchImage The color image that we are matching against
+ * @return SE3 The refined pose (the best that was seen, should an update overshoot)
+ */
+SE3 PhotoMatcher::Align(const SE3& initialPose, Mat& matchImage)
+{
+	_poseImage->PrepareAlignment(); _evaluations = 0;
+	PoseImage::GetIntensity(matchImage, _testIntensity);
+
+	auto pose = initialPose; auto best = initialPose; auto bestError = DBL_MAX;
+	for (auto iteration = 0; iteration < _settings.GetRefineIterations(); iteration++)
+	{
+		auto delta = Vec6d(); auto error = 0.0;
+		if (!_poseImage->GetAlignmentStep(pose, _testIntensity, delta, error)) break;
+		_evaluations++;
+
+		if (error < bestError) { bestError = error; best = pose; }
+		pose = pose * SE3::Exp(delta).Inverse();
+
+		auto rotation = sqrt(delta[0] * delta[0] + delta[1] * delta[1] + delta[2] * delta[2]);
+		auto translation = sqrt(delta[3] * delta[3] + delta[4] * delta[4] + delta[5] * delta[5]);
+		if (rotation < ALIGN_ROTATION_EPSILON && translation < ALIGN_TRANSLATION_EPSILON) { best = pose; break; }
+	}
+
+	return best;
+}
+
+/**
+ * @brief Pick the best of a set of candidate poses, so that the refinement starts from it. The candidates are scored
+ * together in a single pass at the coarsest sampling of the refinement (see PoseImage::GetScores)
+ * @param candidates The candidate poses
+ * @param matchImage The color image that we are matching against
+ * @param matchDepth The depth map that we are matching against (empty for a purely photometric score)
+ * @return int The index of the best candidate (or -1 if there are none)
+ */
+int PhotoMatcher::Select(const vector<SE3>& candidates, Mat& matchImage, Mat& matchDepth)
+{
+	if (matchImage.channels() == 3) cvtColor(matchImage, _testLuma, COLOR_BGR2GRAY); else _testLuma = matchImage;
+
+	auto stride = _settings.GetPixelStride() << (max(_settings.GetPyramidLevels(), 1) - 1);
+	_poseImage->GetScores(candidates, _testLuma, matchDepth, _depthWeight, stride, _scores);
+
+	auto best = -1;
+	for (auto i = 0; i < (int)_scores.size(); i++) if (best < 0 || _scores[i] < _scores[best]) best = i;
+	return best;
 }
 
 //--------------------------------------------------
@@ -71,16 +143,13 @@ Mat PhotoMatcher::Refine(Mat& initialPose, Mat& matchImage)
 void PhotoMatcher::GetErrors(double * inputs, double * errors)
 {
 	// Retrieve the pose
-	Mat pose; Vector2Pose(inputs, pose);
+	auto pose = Vector2Pose(inputs);
 
 	// Attempt to match the warp image
-	auto errorVector = vector<double>(); auto score = _poseImage->GetScore(pose, _testImage, errorVector);
+	auto score = _poseImage->GetLumaScore(pose, _testLuma, _testDepth, _depthWeight, _stride); _evaluations++;
 
 	// Copy the errors back
 	for (auto i = 0; i < 6; i++) errors[i] = score;
-
-	// Show the current score
-	cout << "Error Score: " << score << endl;
 }
 
 /**
@@ -105,23 +174,23 @@ void PhotoMatcher::Callback(int * m, int * n, double * x, double * fvec, int * i
  * @param pose The pose that we are converting
  * @param parameters The parameters that we have converted to
  */
-void PhotoMatcher::Pose2Vector(Mat& pose, double * parameters) 
+void PhotoMatcher::Pose2Vector(const SE3& pose, double * parameters) 
 {
 	auto rvec = Vec3d(); auto tvec = Vec3d();
-	NVLib::PoseUtils::Pose2Vectors(pose, rvec, tvec);
+	pose.ToVectors(rvec, tvec);
 
 	parameters[0] = rvec[0]; parameters[1] = rvec[1]; parameters[2] = rvec[2];
 	parameters[3] = tvec[0]; parameters[4] = tvec[1]; parameters[5] = tvec[2]; 
 }
 
 /**
- * @brief Convert a vector to a given pose
+ * @brief Convert a vector to a given pose (on the stack, since this runs once per evaluation)
  * @param parameters The parameters that we have converted
- * @param pose The pose that we have obtained
+ * @return SE3 The pose that we have obtained
  */
-void PhotoMatcher::Vector2Pose(double * parameters, Mat& pose) 
+SE3 PhotoMatcher::Vector2Pose(double * parameters) 
 {
 	auto rvec = Vec3d(parameters[0], parameters[1], parameters[2]);
 	auto tvec = Vec3d(parameters[3], parameters[4], parameters[5]);
-	pose = NVLib::PoseUtils::Vectors2Pose(rvec, tvec);
+	return SE3::FromVectors(rvec, tvec);
 }
\ No newline at end of file
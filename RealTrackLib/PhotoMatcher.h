@@ -8,34 +8,50 @@
 
 #pragma once
 
+#include <cfloat>
 #include <iostream>
 using namespace std;
 
-#include <NVLib/PoseUtils.h>
-
 #include <opencv2/opencv.hpp>
 using namespace cv;
 
 #include <minpack.h>
+#include "SE3.h"
 #include "PoseImage.h"
+#include "QualitySettings.h"
 
 namespace NVL_App
 {
 	class PhotoMatcher
 	{
 	private:
-		Mat _testImage;
+		Mat _testDepth;
+		Mat _testIntensity;
+		Mat _testLuma;
+		double _depthWeight;
 		PoseImage * _poseImage;
-		inline static PhotoMatcher * _staticLink = nullptr;
+		QualitySettings _settings;
+		int _stride;
+		int _evaluations;
+		vector<double> _scores;
+		inline static thread_local PhotoMatcher * _staticLink = nullptr;
 	public:
 		PhotoMatcher(PoseImage * photoImage);
 
-		Mat Refine(Mat& initialPose, Mat& matchImage);
+		SE3 Refine(const SE3& initialPose, Mat& matchImage);
+		SE3 Refine(const SE3& initialPose, Mat& matchImage, Mat& matchDepth);
+		SE3 Align(const SE3& initialPose, Mat& matchImage);
+		int Select(const vector<SE3>& candidates, Mat& matchImage, Mat& matchDepth);
+
+		inline void SetQuality(QualitySettings& settings) { _settings = settings; }
+		inline void SetDepthWeight(double weight) { _depthWeight = weight; }
+		inline int GetEvaluations() { return _evaluations; }
+		inline vector<double>& GetScores() { return _scores; }
 	private:
 		void GetErrors(double * inputs, double * errors);
 		static void Callback(int * m, int * n, double * x, double * fvec, int * iflag);
 
-		void Pose2Vector(Mat& pose, double * parameters);
-		void Vector2Pose(double * parameters, Mat& pose);
+		void Pose2Vector(const SE3& pose, double * parameters);
+		SE3 Vector2Pose(double * parameters);
 	};
 }
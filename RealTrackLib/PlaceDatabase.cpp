@@ -0,0 +1,103 @@
+//--------------------------------------------------
+// Implementation of class PlaceDatabase
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "PlaceDatabase.h"
+using namespace NVL_App;
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor
+ * @param wordCount The number of words in the vocabulary
+ * @param maxPostings The posting list length beyond which a word is considered a stop-word
+ */
+PlaceDatabase::PlaceDatabase(int wordCount, int maxPostings) : _maxPostings(maxPostings), _entryCount(0)
+{
+	_index.resize(wordCount);
+}
+
+//--------------------------------------------------
+// Add
+//--------------------------------------------------
+
+/**
+ * @brief Add a keyframe signature to the database
+ * @param words The words of the keyframe features
+ * @return int The entry id (entries are numbered in the order that they are added)
+ */
+int PlaceDatabase::Add(vector<int>& words)
+{
+	auto entry = _entryCount++;
+	BuildSignature(words);
+	for (auto& term : _signature) _index[term.first].push_back(make_pair(entry, term.second));
+	return entry;
+}
+
+//--------------------------------------------------
+// Query
+//--------------------------------------------------
+
+/**
+ * @brief Find the entries that share the most (idf weighted) words with the query. Only the posting lists of
+ * the query words are visited, and stop-words are skipped
+ * @param words The words of the query features
+ * @param maxEntry The newest entry that may be returned (so that recent keyframes are excluded)
+ * @param count The maximum number of candidates to return
+ * @param output The candidates, best first
+ */
+void PlaceDatabase::Query(vector<int>& words, int maxEntry, int count, vector<PlaceCandidate>& output)
+{
+	output.clear(); if (_entryCount == 0 || maxEntry < 0) return;
+	if ((int)_scores.size() < _entryCount) _scores.resize(_entryCount, 0);
+
+	BuildSignature(words);
+	for (auto& term : _signature)
+	{
+		auto& postings = _index[term.first];
+		if (postings.empty() || (int)postings.size() > _maxPostings) continue;
+
+		auto idf = log((double)_entryCount / postings.size()); if (idf <= 0) continue;
+		for (auto& posting : postings)
+		{
+			if (posting.first > maxEntry) break;
+			if (_scores[posting.first] == 0) _touched.push_back(posting.first);
+			_scores[posting.first] += idf * min(term.second, posting.second);
+		}
+	}
+
+	for (auto entry : _touched) { output.push_back(PlaceCandidate(entry, _scores[entry])); _scores[entry] = 0; }
+	_touched.clear();
+
+	auto keep = min(count, (int)output.size());
+	partial_sort(output.begin(), output.begin() + keep, output.end(), [](PlaceCandidate& a, PlaceCandidate& b) { return a.GetScore() > b.GetScore(); });
+	output.resize(keep);
+}
+
+//--------------------------------------------------
+// Helpers
+//--------------------------------------------------
+
+/**
+ * @brief Convert a list of words into normalized term frequencies (sorted by word)
+ * @param words The words that we are converting
+ */
+void PlaceDatabase::BuildSignature(vector<int>& words)
+{
+	_signature.clear(); if (words.empty()) return;
+
+	auto sorted = words; sort(sorted.begin(), sorted.end());
+	auto weight = 1.0f / sorted.size();
+	for (auto word : sorted)
+	{
+		if (word < 0 || word >= (int)_index.size()) continue;
+		if (!_signature.empty() && _signature.back().first == word) _signature.back().second += weight;
+		else _signature.push_back(make_pair(word, weight));
+	}
+}
@@ -0,0 +1,54 @@
+//--------------------------------------------------
+// An inverted index over bag-of-words keyframe signatures, used to retrieve loop closure candidates. Words
+// whose posting lists grow past a cap are treated as stop-words, so a query touches a bounded number of
+// postings no matter how large the database gets
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <cmath>
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+namespace NVL_App
+{
+	class PlaceCandidate
+	{
+	private:
+		int _entry;
+		double _score;
+	public:
+		PlaceCandidate() : _entry(-1), _score(0) {}
+		PlaceCandidate(int entry, double score) : _entry(entry), _score(score) {}
+
+		inline int& GetEntry() { return _entry; }
+		inline double& GetScore() { return _score; }
+	};
+
+	class PlaceDatabase
+	{
+	private:
+		int _maxPostings;
+		int _entryCount;
+		vector< vector< pair<int, float> > > _index;
+		vector<double> _scores;
+		vector<int> _touched;
+		vector< pair<int, float> > _signature;
+	public:
+		PlaceDatabase(int wordCount, int maxPostings);
+
+		int Add(vector<int>& words);
+		void Query(vector<int>& words, int maxEntry, int count, vector<PlaceCandidate>& output);
+
+		inline int GetEntryCount() { return _entryCount; }
+	private:
+		void BuildSignature(vector<int>& words);
+	};
+}
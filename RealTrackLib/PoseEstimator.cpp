@@ -0,0 +1,87 @@
+//--------------------------------------------------
+// Implementation of class PoseEstimator
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "PoseEstimator.h"
+using namespace NVL_App;
+
+//--------------------------------------------------
+// Estimate
+//--------------------------------------------------
+
+/**
+ * @brief Perform the pose estimation logic
+ * @param camera The given camera matrix
+ * @param scenePoints The list of scene points
+ * @param imagePoints The list of image points
+ * @param error The reprojection error (mean and standard deviation) of the estimated pose
+ * @return SE3 The pose that was estimated (maps scene points into the camera of the image points)
+ */
+SE3 PoseEstimator::Estimate(Mat& camera, vector<Point3f>& scenePoints, vector<Point2f>& imagePoints, Vec2d& error) 
+{
+	// Convert the scene points and image points to doubles
+	ConvertPoints(scenePoints, imagePoints);
+
+	// Perform the pose estimation
+	auto nodistortion = Vec4d(0, 0, 0, 0); _inliers.clear();
+	Vec3d rvec, tvec; solvePnPRansac(_dscene, _dimage, camera, nodistortion, rvec, tvec, false, _ransacIterations, 10, 0.9, _inliers, SOLVEPNP_DLS);
+
+	// Determine the reprojection value
+	auto pose = SE3::FromVectors(rvec, tvec);
+	EstimateError(camera, pose, error);
+
+	// Return the result
+	return pose;
+}
+
+//--------------------------------------------------
+// Helpers
+//--------------------------------------------------
+
+/**
+ * @brief Copy the points into the double precision buffers that OpenCV wants for pose estimation
+ * @param scenePoints The list of scene points
+ * @param imagePoints The list of image points
+ */
+void PoseEstimator::ConvertPoints(vector<Point3f>& scenePoints, vector<Point2f>& imagePoints) 
+{
+	_dscene.clear(); _dimage.clear();
+	for (auto i = 0; i < scenePoints.size(); i++) 
+	{
+		_dscene.push_back(Point3d(scenePoints[i].x, scenePoints[i].y, scenePoints[i].z)); 
+		_dimage.push_back(Point2d(imagePoints[i].x, imagePoints[i].y));
+	}
+}
+
+/**
+ * @brief Determine the reprojection error associated with the pose
+ * @param camera The given camera matrix
+ * @param pose The estimated pose
+ * @param error The error point that we are getting
+ */
+void PoseEstimator::EstimateError(Mat& camera, const SE3& pose, Vec2d& error) 
+{
+	// Convert the pose to some vectors (the double precision points were prepared by Estimate)
+	auto rvec = Vec3d(); auto tvec = Vec3d(); pose.ToVectors(rvec, tvec);
+
+	// Project 3D points to get "estimated points"
+	auto nodistortion = Vec4d(0, 0, 0, 0);
+	projectPoints(_dscene, rvec, tvec, camera, nodistortion, _estimated);
+
+	// Calculate the error "summaries" in a single pass
+	auto sum = 0.0; auto squareSum = 0.0;
+	for (auto i = 0; i < _estimated.size(); i++) 
+	{
+		auto xDiff = _dimage[i].x - _estimated[i].x;
+		auto yDiff = _dimage[i].y - _estimated[i].y;
+		auto length = sqrt(xDiff * xDiff + yDiff * yDiff);
+		sum += length; squareSum += length * length;
+	}
+
+	auto count = max((int)_estimated.size(), 1);
+	error[0] = sum / count; error[1] = sqrt(max(squareSum / count - error[0] * error[0], 0.0));
+}
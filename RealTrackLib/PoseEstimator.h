@@ -0,0 +1,40 @@
+//--------------------------------------------------
+// Estimates a pose from 3D scene to 2D image correspondences (RANSAC PnP), along with its reprojection error
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include "SE3.h"
+
+namespace NVL_App
+{
+	class PoseEstimator
+	{
+	private:
+		int _ransacIterations;
+		vector<Point3d> _dscene;
+		vector<Point2d> _dimage;
+		vector<Point2d> _estimated;
+		vector<int> _inliers;
+	public:
+		PoseEstimator(int ransacIterations) : _ransacIterations(ransacIterations) {}
+
+		SE3 Estimate(Mat& camera, vector<Point3f>& scenePoints, vector<Point2f>& imagePoints, Vec2d& error);
+
+		inline int& GetRansacIterations() { return _ransacIterations; }
+		inline vector<int>& GetInliers() { return _inliers; }
+	private:
+		void ConvertPoints(vector<Point3f>& scenePoints, vector<Point2f>& imagePoints);
+		void EstimateError(Mat& camera, const SE3& pose, Vec2d& error);
+	};
+}
@@ -0,0 +1,241 @@
+//--------------------------------------------------
+// Implementation of class PoseGraph
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "PoseGraph.h"
+using namespace NVL_App;
+
+#define PCG_ITERATIONS 200
+#define PCG_TOLERANCE 1e-8
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor
+ * @param rotationSigma The expected error of a relative rotation measurement (radians)
+ * @param translationSigma The expected error of a relative translation measurement (millimetres)
+ */
+PoseGraph::PoseGraph(double rotationSigma, double translationSigma)
+{
+	for (auto i = 0; i < 3; i++) { _weights[i] = 1.0 / (rotationSigma * rotationSigma); _weights[i + 3] = 1.0 / (translationSigma * translationSigma); }
+}
+
+//--------------------------------------------------
+// Build
+//--------------------------------------------------
+
+/**
+ * @brief Add a node to the graph (the first node is held fixed to anchor the gauge)
+ * @param pose The initial camera to world pose
+ * @return int The index of the node
+ */
+int PoseGraph::AddNode(const SE3& pose)
+{
+	_poses.push_back(pose);
+	return (int)_poses.size() - 1;
+}
+
+/**
+ * @brief Add a relative pose constraint between two nodes
+ * @param from The first node
+ * @param to The second node
+ * @param measurement The measured relative pose (from^-1 * to)
+ */
+void PoseGraph::AddEdge(int from, int to, const SE3& measurement)
+{
+	if (from < 0 || to < 0 || from >= (int)_poses.size() || to >= (int)_poses.size()) throw runtime_error("A pose graph edge refers to a missing node");
+	_edges.push_back(GraphEdge(from, to, measurement));
+}
+
+//--------------------------------------------------
+// Optimize
+//--------------------------------------------------
+
+/**
+ * @brief Run Gauss-Newton on the graph, with updates applied on the right (T <- T * Exp(delta))
+ * @param iterations The maximum number of iterations
+ * @return int The number of iterations that were performed
+ */
+int PoseGraph::Optimize(int iterations)
+{
+	if (_poses.size() < 2 || _edges.empty()) return 0;
+
+	auto iteration = 0;
+	while (iteration < iterations)
+	{
+		Linearize(); SolvePCG(PCG_ITERATIONS, PCG_TOLERANCE); iteration++;
+
+		auto largest = 0.0;
+		for (auto i = 1; i < (int)_poses.size(); i++)
+		{
+			auto delta = Vec6d(&_x[i * 6]);
+			_poses[i] = _poses[i] * SE3::Exp(delta);
+			for (auto j = 0; j < 6; j++) largest = max(largest, fabs(delta[j]));
+		}
+		if (largest < 1e-6) break;
+	}
+
+	return iteration;
+}
+
+/**
+ * @brief Build the blocks of the normal equations. For an edge with error e = Log(Z^-1 * Ti^-1 * Tj), the
+ * Jacobians are approximately -Ad(Tj^-1 * Ti) for Ti and the identity for Tj
+ * @return double The weighted squared error of the graph
+ */
+double PoseGraph::Linearize()
+{
+	auto nodes = (int)_poses.size();
+	_diagonal.assign(nodes * 36, 0); _offDiagonal.assign(_edges.size() * 36, 0); _gradient.assign(nodes * 6, 0);
+	auto cost = 0.0;
+
+	for (auto k = 0; k < (int)_edges.size(); k++)
+	{
+		auto& edge = _edges[k]; auto i = edge.GetFrom(); auto j = edge.GetTo();
+		auto relative = _poses[i].Inverse() * _poses[j];
+		auto e = (edge.GetMeasurement().Inverse() * relative).Log();
+		double ad[36]; relative.Inverse().Adjoint(ad);
+
+		auto Hii = &_diagonal[i * 36]; auto Hjj = &_diagonal[j * 36]; auto Hij = &_offDiagonal[k * 36];
+		auto gi = &_gradient[i * 6]; auto gj = &_gradient[j * 6];
+
+		for (auto a = 0; a < 6; a++)
+		{
+			for (auto b = 0; b < 6; b++)
+			{
+				auto sum = 0.0;
+				for (auto c = 0; c < 6; c++) sum += ad[c * 6 + a] * _weights[c] * ad[c * 6 + b];
+				Hii[a * 6 + b] += sum;
+				Hij[a * 6 + b] = -ad[b * 6 + a] * _weights[b];
+				gi[a] += ad[b * 6 + a] * _weights[b] * e[b];
+			}
+			Hjj[a * 6 + a] += _weights[a];
+			gj[a] -= _weights[a] * e[a];
+			cost += _weights[a] * e[a] * e[a];
+		}
+	}
+
+	// Factor the diagonal blocks for the block-Jacobi preconditioner
+	_factors.assign(nodes * 36, 0);
+	for (auto n = 1; n < nodes; n++)
+	{
+		auto H = &_diagonal[n * 36]; auto L = &_factors[n * 36];
+		for (auto a = 0; a < 6; a++)
+		{
+			for (auto b = 0; b <= a; b++)
+			{
+				auto sum = H[a * 6 + b];
+				for (auto c = 0; c < b; c++) sum -= L[a * 6 + c] * L[b * 6 + c];
+				if (a == b) L[a * 6 + a] = sqrt(max(sum, 1e-12));
+				else L[a * 6 + b] = sum / L[b * 6 + b];
+			}
+		}
+	}
+
+	for (auto a = 0; a < 6; a++) _gradient[a] = 0;
+	return cost;
+}
+
+//--------------------------------------------------
+// Linear Solver
+//--------------------------------------------------
+
+/**
+ * @brief Solve H x = g with preconditioned conjugate gradients
+ * @param maxIterations The maximum number of iterations
+ * @param tolerance The relative residual at which we stop
+ * @return int The number of iterations that were performed
+ */
+int PoseGraph::SolvePCG(int maxIterations, double tolerance)
+{
+	auto size = _gradient.size();
+	_x.assign(size, 0); _r = _gradient; _z.resize(size); _p.resize(size); _q.resize(size);
+
+	auto dot = [](vector<double>& a, vector<double>& b) { auto sum = 0.0; for (auto i = 0; i < (int)a.size(); i++) sum += a[i] * b[i]; return sum; };
+
+	auto target = tolerance * tolerance * dot(_r, _r);
+	Precondition(_r, _z); _p = _z;
+	auto rz = dot(_r, _z);
+
+	auto iteration = 0;
+	for (; iteration < maxIterations && rz > 0; iteration++)
+	{
+		Multiply(_p, _q);
+		auto pq = dot(_p, _q); if (pq <= 0) break;
+		auto alpha = rz / pq;
+		for (auto i = 0; i < (int)size; i++) { _x[i] += alpha * _p[i]; _r[i] -= alpha * _q[i]; }
+		if (dot(_r, _r) <= target) { iteration++; break; }
+
+		Precondition(_r, _z);
+		auto nextRz = dot(_r, _z); auto beta = nextRz / rz; rz = nextRz;
+		for (auto i = 0; i < (int)size; i++) _p[i] = _z[i] + beta * _p[i];
+	}
+
+	return iteration;
+}
+
+/**
+ * @brief Multiply by the block sparse normal matrix (the fixed first node contributes nothing)
+ * @param input The vector that we are multiplying
+ * @param output The result
+ */
+void PoseGraph::Multiply(vector<double>& input, vector<double>& output)
+{
+	auto nodes = (int)_poses.size();
+	output.assign(input.size(), 0);
+
+	for (auto n = 1; n < nodes; n++)
+	{
+		auto H = &_diagonal[n * 36];
+		for (auto a = 0; a < 6; a++) for (auto b = 0; b < 6; b++) output[n * 6 + a] += H[a * 6 + b] * input[n * 6 + b];
+	}
+
+	for (auto k = 0; k < (int)_edges.size(); k++)
+	{
+		auto i = _edges[k].GetFrom(); auto j = _edges[k].GetTo(); auto H = &_offDiagonal[k * 36];
+		for (auto a = 0; a < 6; a++)
+		{
+			for (auto b = 0; b < 6; b++)
+			{
+				output[i * 6 + a] += H[a * 6 + b] * input[j * 6 + b];
+				output[j * 6 + b] += H[a * 6 + b] * input[i * 6 + a];
+			}
+		}
+	}
+
+	for (auto a = 0; a < 6; a++) output[a] = 0;
+}
+
+/**
+ * @brief Apply the block-Jacobi preconditioner (a Cholesky solve with each node's diagonal block)
+ * @param input The vector that we are preconditioning
+ * @param output The result
+ */
+void PoseGraph::Precondition(vector<double>& input, vector<double>& output)
+{
+	auto nodes = (int)_poses.size();
+	for (auto a = 0; a < 6; a++) output[a] = 0;
+
+	for (auto n = 1; n < nodes; n++)
+	{
+		auto L = &_factors[n * 36]; auto b = &input[n * 6]; auto x = &output[n * 6];
+		for (auto a = 0; a < 6; a++)
+		{
+			auto sum = b[a];
+			for (auto c = 0; c < a; c++) sum -= L[a * 6 + c] * x[c];
+			x[a] = sum / L[a * 6 + a];
+		}
+		for (auto a = 5; a >= 0; a--)
+		{
+			auto sum = x[a];
+			for (auto c = a + 1; c < 6; c++) sum -= L[c * 6 + a] * x[c];
+			x[a] = sum / L[a * 6 + a];
+		}
+	}
+}
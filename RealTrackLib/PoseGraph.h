@@ -0,0 +1,61 @@
+//--------------------------------------------------
+// A pose graph over keyframe poses (camera to world), optimized with Gauss-Newton. The normal equations are
+// block sparse (one 6x6 block per node and per edge), so they are solved with preconditioned conjugate
+// gradients rather than being formed densely
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include "SE3.h"
+
+namespace NVL_App
+{
+	class GraphEdge
+	{
+	private:
+		int _from;
+		int _to;
+		SE3 _measurement;
+	public:
+		GraphEdge(int from, int to, const SE3& measurement) : _from(from), _to(to), _measurement(measurement) {}
+
+		inline int& GetFrom() { return _from; }
+		inline int& GetTo() { return _to; }
+		inline SE3& GetMeasurement() { return _measurement; }
+	};
+
+	class PoseGraph
+	{
+	private:
+		double _weights[6];
+		vector<SE3> _poses;
+		vector<GraphEdge> _edges;
+
+		vector<double> _diagonal, _offDiagonal, _gradient, _factors;
+		vector<double> _x, _r, _z, _p, _q;
+	public:
+		PoseGraph(double rotationSigma, double translationSigma);
+
+		int AddNode(const SE3& pose);
+		void AddEdge(int from, int to, const SE3& measurement);
+		int Optimize(int iterations);
+
+		inline vector<SE3>& GetPoses() { return _poses; }
+		inline int GetEdgeCount() { return (int)_edges.size(); }
+	private:
+		double Linearize();
+		int SolvePCG(int maxIterations, double tolerance);
+		void Multiply(vector<double>& input, vector<double>& output);
+		void Precondition(vector<double>& input, vector<double>& output);
+	};
+}
@@ -9,6 +9,28 @@
 #include "PoseImage.h"
 using namespace NVL_App;
 
+// The inverse depth residual is scaled to millimetres at a range of one metre, and truncated so that occlusions 
+// and disocclusions (which the depth handles poorly) cannot dominate the score
+#define INVERSE_DEPTH_SCALE 1e6
+#define DEPTH_TRUNCATION 50.0
+
+// Only pixels with a strong enough gradient constrain the alignment, and residuals beyond the limit are treated as
+// occlusions rather than misalignment
+#define ALIGN_MIN_GRADIENT 5.0
+#define ALIGN_MAX_RESIDUAL 60.0
+
+// The number of fractional bits used by the fixed point bilinear sampling of the luma score
+#define FIXED_BITS 8
+#define FIXED_ONE (1 << FIXED_BITS)
+
+// Splatted samples within this fraction of the nearest depth at a pixel are blended as the same surface, and pixels 
+// with less than the minimum total weight are left as holes (so that silhouettes do not bleed outwards)
+#define SPLAT_TOLERANCE 0.02f
+#define SPLAT_MIN_WEIGHT 0.1f
+
+// The number of poses that a batched score projects together (the projections are held in stack buffers of this size)
+#define BATCH_LANES 32
+
 //--------------------------------------------------
 // Constructors and Terminators
 //--------------------------------------------------
@@ -18,26 +40,131 @@ using namespace NVL_App;
  * @param camera The camera matrix associated with the system
  * @param frame The given depth frame
  */
-PoseImage::PoseImage(Mat &camera, NVLib::DepthFrame *frame) : _camera(camera)
+PoseImage::PoseImage(Mat &camera, NVLib::DepthFrame *frame) : PoseImage(camera, frame->GetColor().size())
+{
+	SetFrame(frame);
+}
+
+/**
+ * @brief Custom Constructor that allocates the buffers up front (the frame is provided later through SetFrame)
+ * @param camera The camera matrix associated with the system
+ * @param size The resolution of the frames that will be provided
+ */
+PoseImage::PoseImage(Mat& camera, const Size& size) : _camera(camera), _alignReady(false), _lumaReady(false)
+{
+	auto K = (double *)_camera.data;
+	_fx = K[0]; _fy = K[4]; _cx = K[2]; _cy = K[5];
+
+	_pixelCount = size.width * size.height;
+	BuildRays(size); SelectKernels();
+}
+
+//--------------------------------------------------
+// SetFrame
+//--------------------------------------------------
+
+/**
+ * @brief Point the image at the given frame. The depth stays in its native format (float or 16-bit millimetres) 
+ * and is back-projected on the fly within the kernels, so nothing is copied here
+ * @param frame The given depth frame (must outlive its use within this image)
+ */
+void PoseImage::SetFrame(NVLib::DepthFrame * frame)
+{
+	_depth = frame->GetDepth(); _color = frame->GetColor();
+	_pixelCount = _depth.rows * _depth.cols; _alignReady = false; _lumaReady = false;
+	if ((int)_rayX.size() != _depth.cols || (int)_rayY.size() != _depth.rows) BuildRays(_depth.size());
+	SelectKernels();
+}
+
+/**
+ * @brief Precompute the normalized ray components ((u - cx) / fx and (v - cy) / fy) for each column and row
+ * @param size The resolution of the frames
+ */
+void PoseImage::BuildRays(const Size& size)
+{
+	_rayX.resize(size.width); _rayY.resize(size.height);
+	for (auto column = 0; column < size.width; column++) _rayX[column] = (column - _cx) / _fx;
+	for (auto row = 0; row < size.height; row++) _rayY[row] = (row - _cy) / _fy;
+}
+
+/**
+ * @brief Pick the kernels that are specialized for the depth format (float or 16-bit millimetres) and the color 
+ * format (BGR or gray) of the frame. Within a kernel the depth is read through a typed pointer and the channel loop 
+ * has a fixed length, so that there are no per-pixel format branches left for the compiler to work around. The 
+ * frames of a session share their formats, so the same kernels are picked for every frame
+ */
+void PoseImage::SelectKernels()
+{
+	auto depth16 = _depth.depth() == CV_16U; auto gray = _color.channels() == 1;
+
+	if (depth16) _scoreKernel = gray ? &PoseImage::Score<ushort, 1> : &PoseImage::Score<ushort, 3>;
+	else _scoreKernel = gray ? &PoseImage::Score<float, 1> : &PoseImage::Score<float, 3>;
+
+	_lumaKernel = depth16 ? &PoseImage::LumaScore<ushort> : &PoseImage::LumaScore<float>;
+	_batchKernel = depth16 ? &PoseImage::BatchScores<ushort> : &PoseImage::BatchScores<float>;
+	_splatKernel = depth16 ? &PoseImage::Splat<ushort> : &PoseImage::Splat<float>;
+}
+
+/**
+ * @brief Build the luma image of the reference frame on first use (a gray frame is used as it is)
+ */
+void PoseImage::PrepareLuma()
 {
-	Mat depth;
-	frame->GetDepth().convertTo(depth, CV_64F);
-	_cloud = NVLib::CloudUtils::BuildColorCloud(camera, frame->GetColor(), depth);
-	_pixelCount = depth.rows * depth.cols;
+	if (_lumaReady) return;
+	if (_color.channels() == 1) _luma = _color; else cvtColor(_color, _luma, COLOR_BGR2GRAY);
+	_lumaReady = true;
+}
+
+/**
+ * @brief Confirm that the depth of a match frame has the format that the kernels were picked for
+ * @param matchDepth The depth map that we are matching with
+ * @param depthWeight The weight of the depth residual (the depth is not used, and so not checked, when this is zero)
+ */
+void PoseImage::CheckDepth(Mat& matchDepth, double depthWeight)
+{
+	if (depthWeight > 0 && !matchDepth.empty() && matchDepth.depth() != _depth.depth()) throw runtime_error("The match depth must have the same format as the reference depth");
 }
 
 //--------------------------------------------------
 // GetImage
 //--------------------------------------------------
 
+/**
+ * @brief Build the color cloud (X, Y, Z, B, G, R) for the current frame (only used for rendering, and a gray frame
+ * is repeated across the color channels)
+ * @return Mat The resultant cloud
+ */
+Mat PoseImage::GetCloud()
+{
+	Mat result = Mat(_depth.size(), CV_64FC(6), Scalar());
+	auto cloudData = (double *)result.data; auto channels = _color.channels();
+
+	for (auto row = 0; row < _depth.rows; row++)
+	{
+		for (auto column = 0; column < _depth.cols; column++)
+		{
+			auto index = column + row * _depth.cols;
+			auto Z = GetZ(index);
+
+			cloudData[index * 6 + 0] = _rayX[column] * Z;
+			cloudData[index * 6 + 1] = _rayY[row] * Z;
+			cloudData[index * 6 + 2] = Z;
+			for (auto channel = 0; channel < 3; channel++) cloudData[index * 6 + 3 + channel] = _color.data[index * channels + min(channel, channels - 1)];
+		}
+	}
+
+	return result;
+}
+
 /**
  * @brief Get Image
  * @param pose The pose of the image we are getting
  * @return Mat Returns a Mat
  */
-Mat PoseImage::GetImage(Mat &pose)
+Mat PoseImage::GetImage(const SE3& pose)
 {
-	return NVLib::CloudUtils::RenderImage(_cloud, _camera, pose);
+	Mat cloud = GetCloud(); Mat poseMatrix = pose.ToMat();
+	return NVLib::CloudUtils::RenderImage(cloud, _camera, poseMatrix);
 }
 
 //--------------------------------------------------
@@ -49,100 +176,178 @@ Mat PoseImage::GetImage(Mat &pose)
  * @param pose The pose that we are finding
  * @return Mat The given depth map
  */
-Mat PoseImage::GetDepth(Mat &pose)
+Mat PoseImage::GetDepth(const SE3& pose)
 {
-	Mat tcloud = NVLib::CloudUtils::TransformCloud(_cloud, pose);
-	auto cloudData = (double *)tcloud.data;
+	Mat result; GetDepth(pose, result);
+	return result;
+}
 
-	Mat result = Mat_<float>::zeros(_cloud.size());
-	auto output = (float *)result.data;
+/**
+ * @brief Warp the depth map into the given pose, writing into an existing buffer. Each pixel is splatted onto the 
+ * 2x2 neighbourhood around its projection (see Splat), which closes the cracks without blurring the depth edges
+ * @param pose The pose that we are finding
+ * @param output The output depth map (only allocated if it does not have the right layout)
+ */
+void PoseImage::GetDepth(const SE3& pose, Mat& output)
+{
+	(this->*_splatKernel)(pose, nullptr);
+	WriteDepth(output);
+}
 
-	for (auto row = 0; row < result.rows; row++)
-	{
-		for (auto column = 0; column < result.cols; column++)
-		{
-			// Get the index
-			auto index = column + row * _cloud.cols;
+//--------------------------------------------------
+// WarpCounter
+//--------------------------------------------------
 
-			// Get 3D image
-			auto X = cloudData[index * 6 + 0];
-			auto Y = cloudData[index * 6 + 1];
-			auto Z = cloudData[index * 6 + 2];
-			if (Z < 300 || Z > 2500) continue;
+/**
+ * @brief Add the logic to warp the counter to the new "pose"
+ * @param pose The pose that we are warping the counter to
+ * @param counter The counter we are warping
+ * @return Mat The resultant new counter location
+ */
+Mat PoseImage::WarpCounter(const SE3& pose, Mat& counter) 
+{
+	Mat result; WarpCounter(pose, counter, result);
+	return result;
+}
+
+/**
+ * @brief Warp the counter to the new "pose", writing into an existing buffer. The counter is splatted along with 
+ * the depth, and each pixel takes the value of the sample of the visible surface that lands closest to it
+ * @param pose The pose that we are warping the counter to
+ * @param counter The counter we are warping
+ * @param output The resultant new counter (must not be the same buffer as counter)
+ */
+void PoseImage::WarpCounter(const SE3& pose, Mat& counter, Mat& output) 
+{
+	(this->*_splatKernel)(pose, &counter);
+	WriteCounter(output);
+}
 
-			// Get the image location
-			auto imagePoint = NVLib::Math3D::Project(_camera, Point3d(X, Y, Z));
+//--------------------------------------------------
+// Warp
+//--------------------------------------------------
 
-			// Round Location
-			auto u = (int)round(imagePoint.x); auto v = (int)round(imagePoint.y);
-			if (u < 0 || v < 0 || u >= result.cols || v >= result.rows) continue;
-			auto imageIndex = u + v * result.cols;
+/**
+ * @brief Warp both the depth and the counter to the new "pose" with a single splat (the counter does not change how
+ * the depth is blended, so this gives the same result as calling GetDepth and WarpCounter for half the cost)
+ * @param pose The pose that we are warping to
+ * @param counter The counter we are warping
+ * @param depthOutput The output depth map
+ * @param counterOutput The resultant new counter (must not be the same buffer as counter)
+ */
+void PoseImage::Warp(const SE3& pose, Mat& counter, Mat& depthOutput, Mat& counterOutput)
+{
+	(this->*_splatKernel)(pose, &counter);
+	WriteDepth(depthOutput); WriteCounter(counterOutput);
+}
 
-			// Perform Updates
-			auto existingZ = output[imageIndex];
-			if (existingZ < 300 || existingZ > 2500) existingZ = 3000;
-			output[imageIndex] = (Z < existingZ) ? Z : existingZ; // This formulation is hoped to avoid occlusions
-		}
-	}
+/**
+ * @brief Resolve the splat buffers into a depth map
+ * @param output The output depth map (only allocated if it does not have the right layout)
+ */
+void PoseImage::WriteDepth(Mat& output)
+{
+	// The warped map keeps the format of the source depth
+	output.create(_depth.size(), _depth.type());
+	auto depth16 = _depth.depth() == CV_16U;
+	auto output_16 = (ushort *)output.data; auto output_32 = (float *)output.data;
 
-	// Add a median blur to get rid of some of the holes
-	medianBlur(result, result, 5);
+	for (auto i = 0; i < _pixelCount; i++)
+	{
+		auto weight = _splatWeight[i];
+		auto Z = weight < SPLAT_MIN_WEIGHT ? 0.0f : _splatDepth[i] / weight;
+		if (depth16) output_16[i] = (ushort)lround(Z); else output_32[i] = Z;
+	}
+}
 
-	// Return the result
-	return result;
+/**
+ * @brief Resolve the splat labels into a counter
+ * @param output The output counter (only allocated if it does not have the right layout)
+ */
+void PoseImage::WriteCounter(Mat& output)
+{
+	output.create(_depth.size(), CV_8UC1);
+	for (auto i = 0; i < _pixelCount; i++) output.data[i] = _splatWeight[i] < SPLAT_MIN_WEIGHT ? 0 : _splatLabel[i];
 }
 
 //--------------------------------------------------
-// WarpCounter
+// Splatting
 //--------------------------------------------------
 
 /**
- * @brief Add the logic to warp the counter to the new "pose"
- * @param pose The pose that we are warping the counter to
- * @param counter The counter we are warping
- * @return Mat The resultant new counter location
+ * @brief Forward warp the depth into the given pose, spreading each pixel over the 2x2 neighbourhood around its 
+ * projection with bilinear weights. A depth test keeps the nearest surface at each pixel, and the samples of that
+ * surface are blended (leaving the weighted depth sums in the splat buffers)
+ * @param pose The pose that we are warping to
+ * @param counter If given, the counter values are carried along with the samples
  */
-Mat PoseImage::WarpCounter(Mat& pose, Mat& counter) 
+template <typename TDepth> void PoseImage::Splat(const SE3& pose, Mat * counter)
 {
-	// Warp the point cloud wrt the pose
-	Mat tcloud = NVLib::CloudUtils::TransformCloud(_cloud, pose);
-	auto cloudData = (double *)tcloud.data;
+	auto perf = PerfScope("splat");
+	auto fx = _fx; auto fy = _fy; auto cx = _cx; auto cy = _cy;
+	auto depth = (TDepth *)_depth.data;
 
-	// Create handles to the remap locations
-	Mat result = Mat_<uchar>::zeros(counter.size());
+	auto labels = counter != nullptr;
+	_splatDepth.assign(_pixelCount, 0); _splatWeight.assign(_pixelCount, 0); _splatNearest.assign(_pixelCount, FLT_MAX);
+	if (labels) { _splatLabel.assign(_pixelCount, 0); _splatLabelWeight.assign(_pixelCount, 0); }
 
-	// Populate the remap tables
-	for (auto row = 0; row < counter.rows; row++)
+	for (auto row = 0; row < _depth.rows; row++)
 	{
-		for (auto column = 0; column < counter.cols; column++)
+		for (auto column = 0; column < _depth.cols; column++)
 		{
-			// Get the index
-			auto index = column + row * _cloud.cols;
-
 			// Get 3D image
-			auto X = cloudData[index * 6 + 0];
-			auto Y = cloudData[index * 6 + 1];
-			auto Z = cloudData[index * 6 + 2];
-			if (Z < 300 || Z > 2500) continue;
+			auto index = column + row * _depth.cols;
+			auto z = (double)depth[index]; if (z <= 0) continue;
+			auto x = _rayX[column] * z;
+			auto y = _rayY[row] * z;
 
-			// Get the image location
-			auto imagePoint = NVLib::Math3D::Project(_camera, Point3d(X, Y, Z));
+			// Transform into the new pose
+			double X, Y, Z; pose.Transform(x, y, z, X, Y, Z);
+			if (Z < 300 || Z > 2500) continue;
 
-			// Round Location
-			auto u = (int)round(imagePoint.x); auto v = (int)round(imagePoint.y);
-			if (u < 0 || v < 0 || u >= result.cols || v >= result.rows) continue;
-			auto imageIndex = u + v * result.cols;
+			// Find the neighbourhood (which may hang over the border by a pixel)
+			auto u = fx * X / Z + cx; auto v = fy * Y / Z + cy;
+			if (u <= -1 || v <= -1 || u >= _depth.cols || v >= _depth.rows) continue;
+			auto u0 = (int)floor(u); auto v0 = (int)floor(v);
+			auto a = (float)(u - u0); auto b = (float)(v - v0);
+			auto label = labels ? counter->data[index] : (uchar)0;
 
-			// Perform Updates
-			result.data[imageIndex] = counter.data[index];
+			float weights[4] = { (1 - a) * (1 - b), a * (1 - b), (1 - a) * b, a * b };
+			for (auto corner = 0; corner < 4; corner++)
+			{
+				auto tu = u0 + (corner & 1); auto tv = v0 + (corner >> 1);
+				if (tu < 0 || tv < 0 || tu >= _depth.cols || tv >= _depth.rows) continue;
+				SplatSample(tu + tv * _depth.cols, (float)Z, weights[corner], label, labels);
+			}
 		}
 	}
+}
+
+/**
+ * @brief Add a sample to a pixel of the splat buffers
+ * @param target The index of the pixel
+ * @param Z The depth of the sample
+ * @param weight The weight of the sample at this pixel
+ * @param label The counter value that the sample carries
+ * @param labels Whether the counter values are being tracked
+ */
+void PoseImage::SplatSample(int target, float Z, float weight, uchar label, bool labels)
+{
+	auto& nearest = _splatNearest[target];
+	auto tolerance = SPLAT_TOLERANCE * min(Z, nearest);
 
-	// Add a median blur to get rid of some of the holes
-	medianBlur(result, result, 5);
+	// A nearer surface replaces whatever was there
+	if (Z < nearest - tolerance) 
+	{
+		_splatDepth[target] = Z * weight; _splatWeight[target] = weight; nearest = Z;
+		if (labels) { _splatLabel[target] = label; _splatLabelWeight[target] = weight; }
+		return;
+	}
 
-	// Return the result
-	return result;
+	// A sample of the same surface is blended in (and a surface that is further away is occluded)
+	if (Z > nearest + tolerance) return;
+	_splatDepth[target] += Z * weight; _splatWeight[target] += weight; nearest = min(nearest, Z);
+	if (labels && weight > _splatLabelWeight[target]) { _splatLabel[target] = label; _splatLabelWeight[target] = weight; }
 }
 
 //--------------------------------------------------
@@ -154,64 +359,506 @@ Mat PoseImage::WarpCounter(Mat& pose, Mat& counter)
  * @param pose The pose of the image we are getting
  * @param match The image we are matching with
  * @param errors The errors that we are dealing with
+ * @param stride The sampling stride over the reference pixels (1 uses every pixel)
  * @return Mat Returns a Mat
  */
-double PoseImage::GetScore(Mat &pose, Mat &matchImage, vector<double> &errors)
-{
-	Mat tcloud = NVLib::CloudUtils::TransformCloud(_cloud, pose);
-	Mat imagePoints = NVLib::CloudUtils::ProjectImagePoints(_camera, tcloud);
-	auto parts = vector<Mat>();
-	split(imagePoints, parts);
-	Mat mapx;
-	parts[0].convertTo(mapx, CV_32FC1);
-	Mat mapy;
-	parts[1].convertTo(mapy, CV_32FC1);
-	Mat samples;
-	remap(matchImage, samples, mapx, mapy, INTER_LINEAR);
-
-	auto cinput = (double *)_cloud.data;
-	auto pinput = (double *)imagePoints.data;
-	errors.clear();
-	for (auto row = 0; row < matchImage.rows; row++)
-	{
-		for (auto column = 0; column < matchImage.cols; column++)
+double PoseImage::GetScore(const SE3& pose, Mat &matchImage, vector<double> &errors, int stride)
+{
+	Mat matchDepth; return GetScore(pose, matchImage, matchDepth, 0, errors, stride);
+}
+
+/**
+ * @brief Get the joint photometric and geometric score of the image against a match frame. The geometric part
+ * compares the inverse of the warped depth with the inverse of the match depth at the same pixel, and is computed 
+ * within the same pass as the color (so it adds little to the cost of an evaluation)
+ * @param pose The pose of the image we are getting
+ * @param matchImage The color image we are matching with
+ * @param matchDepth The depth map we are matching with (empty for a purely photometric score)
+ * @param depthWeight The weight of the depth residual relative to the color residual
+ * @param errors The per-pixel errors that were found
+ * @param stride The sampling stride over the reference pixels (1 uses every pixel)
+ * @return double The average score
+ */
+double PoseImage::GetScore(const SE3& pose, Mat &matchImage, Mat& matchDepth, double depthWeight, vector<double> &errors, int stride)
+{
+	auto perf = PerfScope("pose_score");
+	if (matchImage.channels() != _color.channels()) throw runtime_error("The match image must have the same format as the reference image");
+	CheckDepth(matchDepth, depthWeight);
+
+	return (this->*_scoreKernel)(pose, matchImage, matchDepth, depthWeight, errors, stride);
+}
+
+/**
+ * @brief The scoring kernel of GetScore, for a given depth format and number of color channels
+ * @param pose The pose of the image we are getting
+ * @param matchImage The color image we are matching with
+ * @param matchDepth The depth map we are matching with
+ * @param depthWeight The weight of the depth residual relative to the color residual
+ * @param errors The per-pixel errors that were found
+ * @param stride The sampling stride over the reference pixels
+ * @return double The average score
+ */
+template <typename TDepth, int Channels> double PoseImage::Score(const SE3& pose, Mat& matchImage, Mat& matchDepth, double depthWeight, vector<double>& errors, int stride)
+{
+	auto fx = _fx; auto fy = _fy; auto cx = _cx; auto cy = _cy;
+	auto depth = (TDepth *)_depth.data; auto color = _color.data;
+	auto match = (TDepth *)matchDepth.data;
+
+	auto step = (int)matchImage.step[0];
+	auto useDepth = depthWeight > 0 && !matchDepth.empty();
+	errors.clear(); auto total = 0.0;
+
+	for (auto row = 0; row < matchImage.rows; row += stride)
+	{
+		for (auto column = 0; column < matchImage.cols; column += stride)
 		{
 			// Get the index
 			auto index = column + row * matchImage.cols;
 
+			// Back-project the reference pixel and transform it into the match image
+			auto z = (double)depth[index];
+			if (z <= 0) continue;
+			auto x = _rayX[column] * z;
+			auto y = _rayY[row] * z;
+
+			double X, Y, Z; pose.Transform(x, y, z, X, Y, Z);
+
 			// Figure out if we are within range
-			auto x = pinput[index * 2 + 0];
-			auto y = pinput[index * 2 + 1];
-			if (x < 0 || x >= matchImage.cols || y < 0 || y >= matchImage.rows)
+			auto u = fx * X / Z + cx; auto v = fy * Y / Z + cy;
+			if (!(u >= 0 && u < matchImage.cols - 1 && v >= 0 && v < matchImage.rows - 1)) continue;
+
+			// Bilinear sample of the match color
+			auto u0 = (int)u; auto v0 = (int)v; auto a = u - u0; auto b = v - v0;
+			auto s00 = matchImage.data + v0 * step + u0 * Channels; auto s10 = s00 + Channels;
+			auto s01 = s00 + step; auto s11 = s01 + Channels;
+
+			auto score = 0.0;
+			for (auto channel = 0; channel < Channels; channel++) 
+			{
+				auto top = s00[channel] + a * (s10[channel] - s00[channel]);
+				auto bottom = s01[channel] + a * (s11[channel] - s01[channel]);
+				auto sample = (int)round(top + b * (bottom - top));
+				auto difference = sample - (int)color[index * Channels + channel];
+				if constexpr (Channels == 1) score = abs(difference); else score += difference * difference;
+			}
+
+			// Calculate the score (the distance between the colors, which needs no root for a single channel)
+			if constexpr (Channels > 1) score = sqrt(score);
+
+			// Add the inverse depth residual (nearest sample, since interpolating across depth edges invents surfaces)
+			if (useDepth && Z > 0) 
+			{
+				auto D = (double)match[(int)(u + 0.5) + (int)(v + 0.5) * matchDepth.cols];
+				if (D > 0) score += depthWeight * min(abs(1.0 / D - 1.0 / Z) * INVERSE_DEPTH_SCALE, DEPTH_TRUNCATION);
+			}
+
+			errors.push_back(score); total += score;
+		}
+	}
+
+	// Return the average score
+	return errors.size() == 0 ? 0 : total / errors.size();
+}
+
+//--------------------------------------------------
+// Luma Score
+//--------------------------------------------------
+
+/**
+ * @brief Score the image against a match frame using single channel (luma) images and fixed point bilinear sampling. 
+ * Each row is first projected in a branch-free pass (which the compiler can vectorize), after which the samples are 
+ * gathered and the absolute errors are accumulated in integers, so the cost is dominated by the memory accesses
+ * @param pose The pose of the image we are getting
+ * @param matchLuma The 8-bit luma image that we are matching with (see COLOR_BGR2GRAY)
+ * @param matchDepth The depth map we are matching with (empty for a purely photometric score)
+ * @param depthWeight The weight of the depth residual relative to the photometric residual
+ * @param stride The sampling stride over the reference pixels (1 uses every pixel)
+ * @param errors If given, the per-pixel errors are written here as well
+ * @return double The average score
+ */
+double PoseImage::GetLumaScore(const SE3& pose, Mat& matchLuma, Mat& matchDepth, double depthWeight, int stride, vector<double> * errors)
+{
+	auto perf = PerfScope("luma_score");
+	PrepareLuma(); CheckDepth(matchDepth, depthWeight);
+
+	return (this->*_lumaKernel)(pose, matchLuma, matchDepth, depthWeight, stride, errors);
+}
+
+/**
+ * @brief The scoring kernel of GetLumaScore, for a given depth format (of both the reference and the match depth)
+ * @param pose The pose of the image we are getting
+ * @param matchLuma The 8-bit luma image that we are matching with
+ * @param matchDepth The depth map we are matching with
+ * @param depthWeight The weight of the depth residual relative to the photometric residual
+ * @param stride The sampling stride over the reference pixels
+ * @param errors If given, the per-pixel errors are written here as well
+ * @return double The average score
+ */
+template <typename TDepth> double PoseImage::LumaScore(const SE3& pose, Mat& matchLuma, Mat& matchDepth, double depthWeight, int stride, vector<double> * errors)
+{
+	if (errors != nullptr) errors->clear();
+
+	auto step = matchLuma.cols;
+	auto useDepth = depthWeight > 0 && !matchDepth.empty();
+	auto match = (TDepth *)matchDepth.data;
+
+	int64_t photometric = 0; auto geometric = 0.0; auto count = 0;
+	for (auto row = 0; row < _depth.rows; row += stride)
+	{
+		auto samples = ProjectRow<TDepth>(pose, row, stride);
+		auto reference = _luma.data + row * _luma.cols;
+
+		for (auto i = 0; i < samples; i++)
+		{
+			auto u = _rowU[i]; if (u < 0) continue;
+			auto v = _rowV[i];
+
+			// Fixed point bilinear sample (the result carries 2 * FIXED_BITS fractional bits)
+			auto u0 = u >> FIXED_BITS; auto a = u & (FIXED_ONE - 1);
+			auto v0 = v >> FIXED_BITS; auto b = v & (FIXED_ONE - 1);
+			auto s00 = matchLuma.data + v0 * step + u0; auto s01 = s00 + step;
+			auto top = (s00[0] << FIXED_BITS) + a * (s00[1] - s00[0]);
+			auto bottom = (s01[0] << FIXED_BITS) + a * (s01[1] - s01[0]);
+			auto value = (top << FIXED_BITS) + b * (bottom - top);
+
+			auto residual = abs(((value + (FIXED_ONE >> 1)) >> FIXED_BITS) - (reference[i * stride] << FIXED_BITS));
+			photometric += residual; count++;
+
+			auto error = 0.0;
+			if (useDepth) 
 			{
-				// errors.push_back(0);
-				continue;
+				auto D = (double)match[(u0 + (a >> (FIXED_BITS - 1))) + (v0 + (b >> (FIXED_BITS - 1))) * matchDepth.cols];
+				if (D > 0) error = depthWeight * min(abs(1.0 / D - 1.0 / _rowZ[i]) * INVERSE_DEPTH_SCALE, DEPTH_TRUNCATION);
+				geometric += error;
 			}
 
-			// Get the match color
-			auto c11 = (int)samples.data[index * 3 + 0];
-			auto c12 = (int)samples.data[index * 3 + 1];
-			auto c13 = (int)samples.data[index * 3 + 2];
-
-			// Get the cloud color
-			auto c21 = (int)cinput[index * 6 + 3];
-			auto c22 = (int)cinput[index * 6 + 4];
-			auto c23 = (int)cinput[index * 6 + 5];
-
-			// Calculate the score
-			auto d1 = c11 - c21;
-			auto d2 = c12 - c22;
-			auto d3 = c13 - c23;
-			auto score = sqrt(d1 * d1 + d2 * d2 + d3 * d3);
-			errors.push_back(score);
+			if (errors != nullptr) errors->push_back((double)residual / FIXED_ONE + error);
+		}
+	}
+
+	// Return the average score
+	return count == 0 ? 0 : ((double)photometric / FIXED_ONE + geometric) / count;
+}
+
+/**
+ * @brief Score a batch of candidate poses in a single sweep over the (sub-sampled) reference pixels. The camera is 
+ * folded into each pose and the coefficients are stored coefficient by coefficient, so that projecting a pixel under 
+ * every pose is a branch-free loop over contiguous memory (which the compiler vectorizes across the poses). The poses
+ * that miss the match image are masked rather than skipped, so the gather, the bilinear interpolation and the depth 
+ * term are each a separate branch-free pass over lane arrays, with only the gathers left as scalar loads. Each 
+ * reference pixel is read once for the whole batch, and since the candidates are usually close to each other their 
+ * samples fall within the same few cache lines of the match image. The scores match GetLumaScore (up to the single 
+ * precision of the projection)
+ * @param poses The candidate poses
+ * @param matchLuma The 8-bit luma image that we are matching with (see COLOR_BGR2GRAY)
+ * @param matchDepth The depth map we are matching with (empty for a purely photometric score)
+ * @param depthWeight The weight of the depth residual relative to the photometric residual
+ * @param stride The sampling stride over the reference pixels (1 uses every pixel)
+ * @param scores The average score of each pose
+ */
+void PoseImage::GetScores(const vector<SE3>& poses, Mat& matchLuma, Mat& matchDepth, double depthWeight, int stride, vector<double>& scores)
+{
+	auto perf = PerfScope("batch_score");
+	PrepareLuma(); CheckDepth(matchDepth, depthWeight);
+
+	(this->*_batchKernel)(poses, matchLuma, matchDepth, depthWeight, stride, scores);
+}
+
+/**
+ * @brief The scoring kernel of GetScores, for a given depth format (of both the reference and the match depth)
+ * @param poses The candidate poses
+ * @param matchLuma The 8-bit luma image that we are matching with
+ * @param matchDepth The depth map we are matching with
+ * @param depthWeight The weight of the depth residual relative to the photometric residual
+ * @param stride The sampling stride over the reference pixels
+ * @param scores The average score of each pose
+ */
+template <typename TDepth> void PoseImage::BatchScores(const vector<SE3>& poses, Mat& matchLuma, Mat& matchDepth, double depthWeight, int stride, vector<double>& scores)
+{
+	auto count = (int)poses.size(); scores.assign(count, 0);
+	if (count == 0) return;
+
+	auto fx = _fx; auto fy = _fy; auto cx = _cx; auto cy = _cy;
+
+	// Fold the camera into each pose, so that (u, v) = (U / Z, V / Z) where each of U, V and Z is a dot product
+	_batchPoses.resize(12 * count);
+	for (auto j = 0; j < count; j++)
+	{
+		auto R = poses[j].GetRotation(); auto T = poses[j].GetTranslation();
+		for (auto k = 0; k < 3; k++)
+		{
+			_batchPoses[k * count + j] = (float)(fx * R[k] + cx * R[6 + k]);
+			_batchPoses[(4 + k) * count + j] = (float)(fy * R[3 + k] + cy * R[6 + k]);
+			_batchPoses[(8 + k) * count + j] = (float)R[6 + k];
 		}
+		_batchPoses[3 * count + j] = (float)(fx * T[0] + cx * T[2]);
+		_batchPoses[7 * count + j] = (float)(fy * T[1] + cy * T[2]);
+		_batchPoses[11 * count + j] = (float)T[2];
 	}
 
-	// Determine the average score
-	auto mean = Scalar();
-	auto stddev = Scalar();
-	meanStdDev(errors, mean, stddev);
+	_batchPhotometric.assign(count, 0); _batchGeometric.assign(count, 0); _batchCount.assign(count, 0);
+
+	float * c[12]; for (auto k = 0; k < 12; k++) c[k] = _batchPoses.data() + k * count;
+	float Zs[BATCH_LANES]; int mask[BATCH_LANES], offset[BATCH_LANES], A[BATCH_LANES], B[BATCH_LANES], index[BATCH_LANES];
+	int s00[BATCH_LANES], s01[BATCH_LANES], s10[BATCH_LANES], s11[BATCH_LANES]; double D[BATCH_LANES];
+
+	auto step = matchLuma.cols;
+	auto useDepth = depthWeight > 0 && !matchDepth.empty();
+	auto depth = (TDepth *)_depth.data; auto match = (TDepth *)matchDepth.data;
+	auto width = (float)(_depth.cols - 1); auto height = (float)(_depth.rows - 1);
 
-	// Return the result
-	return mean[0];
-}
\ No newline at end of file
+	for (auto row = 0; row < _depth.rows; row += stride)
+	{
+		auto reference = _luma.data + row * _luma.cols;
+
+		for (auto column = 0; column < _depth.cols; column += stride)
+		{
+			auto z = (float)depth[column + row * _depth.cols]; if (z <= 0) continue;
+			auto x = (float)_rayX[column] * z; auto y = (float)_rayY[row] * z;
+
+			auto target = reference[column] << FIXED_BITS;
+
+			for (auto first = 0; first < count; first += BATCH_LANES)
+			{
+				auto lanes = min(count - first, BATCH_LANES);
+
+				// Project the pixel under each pose of the group, and mask the poses that it misses under (the coordinates 
+				// of a masked lane are clamped to the origin, so that every lane can be gathered without a branch)
+				for (auto l = 0; l < lanes; l++)
+				{
+					auto j = first + l;
+					auto Z = c[8][j] * x + c[9][j] * y + c[10][j] * z + c[11][j];
+					auto U = (c[0][j] * x + c[1][j] * y + c[2][j] * z + c[3][j]) / Z;
+					auto V = (c[4][j] * x + c[5][j] * y + c[6][j] * z + c[7][j]) / Z;
+
+					auto valid = (Z > 0) & (U >= 0) & (U < width) & (V >= 0) & (V < height);
+					auto u = (int)((valid ? U : 0.0f) * FIXED_ONE); auto v = (int)((valid ? V : 0.0f) * FIXED_ONE);
+					A[l] = u & (FIXED_ONE - 1); B[l] = v & (FIXED_ONE - 1);
+					offset[l] = (u >> FIXED_BITS) + (v >> FIXED_BITS) * step;
+					index[l] = ((u >> FIXED_BITS) + (A[l] >> (FIXED_BITS - 1))) + ((v >> FIXED_BITS) + (B[l] >> (FIXED_BITS - 1))) * matchDepth.cols;
+					mask[l] = valid; Zs[l] = valid ? Z : 1.0f;
+				}
+
+				// Gather the four samples of each lane
+				for (auto l = 0; l < lanes; l++)
+				{
+					auto sample = matchLuma.data + offset[l];
+					s00[l] = sample[0]; s01[l] = sample[1]; s10[l] = sample[step]; s11[l] = sample[step + 1];
+				}
+
+				// Interpolate and accumulate the photometric errors of each pose (masked lanes add nothing)
+				for (auto l = 0; l < lanes; l++)
+				{
+					auto top = (s00[l] << FIXED_BITS) + A[l] * (s01[l] - s00[l]);
+					auto bottom = (s10[l] << FIXED_BITS) + A[l] * (s11[l] - s10[l]);
+					auto value = (top << FIXED_BITS) + B[l] * (bottom - top);
+					_batchPhotometric[first + l] += mask[l] * abs(((value + (FIXED_ONE >> 1)) >> FIXED_BITS) - target); 
+					_batchCount[first + l] += mask[l];
+				}
+
+				if (!useDepth) continue;
+
+				// Gather the match depths, and accumulate the depth errors of the lanes that hit a valid depth
+				for (auto l = 0; l < lanes; l++) D[l] = (double)match[index[l]];
+				for (auto l = 0; l < lanes; l++)
+				{
+					auto hit = mask[l] && D[l] > 0;
+					auto error = min(abs(1.0 / (hit ? D[l] : 1.0) - 1.0 / Zs[l]) * INVERSE_DEPTH_SCALE, DEPTH_TRUNCATION);
+					_batchGeometric[first + l] += hit ? depthWeight * error : 0.0;
+				}
+			}
+		}
+	}
+
+	for (auto j = 0; j < count; j++)
+	{
+		scores[j] = _batchCount[j] == 0 ? 0 : ((double)_batchPhotometric[j] / FIXED_ONE + _batchGeometric[j]) / _batchCount[j];
+	}
+}
+
+/**
+ * @brief Project the sampled pixels of a reference row into the match image, writing fixed point coordinates into
+ * the row buffers (with -1 marking the pixels that are invalid or that fall outside the image)
+ * @param pose The pose of the image we are getting
+ * @param row The row of the reference image
+ * @param stride The sampling stride over the reference pixels
+ * @return int The number of samples within the row
+ */
+template <typename TDepth> int PoseImage::ProjectRow(const SE3& pose, int row, int stride)
+{
+	auto fx = _fx; auto fy = _fy; auto cx = _cx; auto cy = _cy;
+	auto R = pose.GetRotation(); auto T = pose.GetTranslation();
+
+	auto samples = (_depth.cols + stride - 1) / stride;
+	_rowZ.resize(samples); _rowU.resize(samples); _rowV.resize(samples);
+
+	// Widen the depth first, so that the projection loop below is the same for both depth formats
+	auto depth = (TDepth *)_depth.data + row * _depth.cols;
+	for (auto i = 0; i < samples; i++) _rowZ[i] = depth[i * stride];
+
+	auto width = (double)(_depth.cols - 1); auto height = (double)(_depth.rows - 1); auto ray = _rayY[row];
+	for (auto i = 0; i < samples; i++)
+	{
+		auto z = (double)_rowZ[i]; auto x = _rayX[i * stride] * z; auto y = ray * z;
+		auto X = R[0] * x + R[1] * y + R[2] * z + T[0];
+		auto Y = R[3] * x + R[4] * y + R[5] * z + T[1];
+		auto Z = R[6] * x + R[7] * y + R[8] * z + T[2];
+
+		auto u = fx * X / Z + cx; auto v = fy * Y / Z + cy;
+		auto valid = z > 0 && Z > 0 && u >= 0 && u < width && v >= 0 && v < height;
+		_rowU[i] = valid ? (int)(u * FIXED_ONE) : -1;
+		_rowV[i] = valid ? (int)(v * FIXED_ONE) : 0;
+		_rowZ[i] = (float)Z;
+	}
+
+	return samples;
+}
+
+//--------------------------------------------------
+// Alignment
+//--------------------------------------------------
+
+/**
+ * @brief Precompute the steepest descent images and the Gauss-Newton Hessian of the reference frame for an inverse 
+ * compositional alignment. These only depend on the reference, so they are built once per frame (on first use) and
+ * then reused by every iteration and every frame that is aligned against it
+ */
+void PoseImage::PrepareAlignment()
+{
+	if (_alignReady) return;
+	_alignReady = true;
+
+	auto fx = _fx; auto fy = _fy;
+
+	GetIntensity(_color, _intensity);
+	auto intensity = (float *)_intensity.data; auto width = _intensity.cols;
+
+	_alignPoints.clear(); _alignValues.clear(); _alignJacobians.clear();
+	for (auto i = 0; i < 36; i++) _alignFactor[i] = 0;
+
+	for (auto row = 1; row < _intensity.rows - 1; row++)
+	{
+		for (auto column = 1; column < width - 1; column++)
+		{
+			auto index = column + row * width;
+			auto z = GetZ(index); if (z < 300 || z > 2500) continue;
+
+			auto gx = 0.5 * (intensity[index + 1] - intensity[index - 1]);
+			auto gy = 0.5 * (intensity[index + width] - intensity[index - width]);
+			if (gx * gx + gy * gy < ALIGN_MIN_GRADIENT * ALIGN_MIN_GRADIENT) continue;
+
+			// Chain the image gradient through the projection, and then through the twist (w, v) at the identity
+			auto x = _rayX[column] * z; auto y = _rayY[row] * z;
+			auto dX = gx * fx / z; auto dY = gy * fy / z; auto dZ = -(dX * x + dY * y) / z;
+			double J[6] = { y * dZ - z * dY, z * dX - x * dZ, x * dY - y * dX, dX, dY, dZ };
+
+			for (auto r = 0; r < 6; r++) for (auto c = 0; c <= r; c++) _alignFactor[r * 6 + c] += J[r] * J[c];
+			for (auto i = 0; i < 6; i++) _alignJacobians.push_back((float)J[i]);
+			_alignPoints.push_back((float)x); _alignPoints.push_back((float)y); _alignPoints.push_back((float)z);
+			_alignValues.push_back(intensity[index]);
+		}
+	}
+
+	// The factorization is kept rather than the Hessian, so that each step is just a pair of triangular solves
+	if (_alignValues.size() < 6 || !Factorize(_alignFactor)) { _alignPoints.clear(); _alignValues.clear(); _alignJacobians.clear(); }
+}
+
+/**
+ * @brief Find the inverse compositional update for the given pose. This is just a warp, a residual and a 6-vector
+ * accumulation per pixel, since the Jacobians and the Hessian belong to the reference
+ * @param pose The current estimate of the pose of the match frame
+ * @param matchIntensity The intensity image of the match frame (see GetIntensity)
+ * @param delta The update, which should be applied as pose * Exp(delta)^-1
+ * @param error The RMS photometric error at the given pose (with the outliers truncated, so that dropping pixels is not rewarded)
+ * @return true If the step was found
+ * @return false If no pixels could be aligned
+ */
+bool PoseImage::GetAlignmentStep(const SE3& pose, Mat& matchIntensity, Vec6d& delta, double& error)
+{
+	auto perf = PerfScope("align_step");
+	auto fx = _fx; auto fy = _fy; auto cx = _cx; auto cy = _cy;
+
+	auto intensity = (float *)matchIntensity.data; auto width = matchIntensity.cols;
+	double b[6] = { 0, 0, 0, 0, 0, 0 }; auto total = 0.0; auto count = 0;
+
+	for (auto i = 0; i < (int)_alignValues.size(); i++)
+	{
+		auto point = &_alignPoints[i * 3];
+		double X, Y, Z; pose.Transform(point[0], point[1], point[2], X, Y, Z);
+		if (Z <= 0) continue;
+
+		auto u = fx * X / Z + cx; auto v = fy * Y / Z + cy;
+		if (!(u >= 0 && u < width - 1 && v >= 0 && v < matchIntensity.rows - 1)) continue;
+
+		// Bilinear sample of the match intensity
+		auto u0 = (int)u; auto v0 = (int)v; auto a = u - u0; auto c = v - v0;
+		auto s00 = intensity + u0 + v0 * width; auto s01 = s00 + width;
+		auto top = s00[0] + a * (s00[1] - s00[0]); auto bottom = s01[0] + a * (s01[1] - s01[0]);
+		auto residual = top + c * (bottom - top) - _alignValues[i]; count++;
+		if (abs(residual) > ALIGN_MAX_RESIDUAL) { total += ALIGN_MAX_RESIDUAL * ALIGN_MAX_RESIDUAL; continue; }
+
+		auto J = &_alignJacobians[i * 6];
+		for (auto j = 0; j < 6; j++) b[j] += J[j] * residual;
+		total += residual * residual;
+	}
+	if (count == 0) return false;
+	error = sqrt(total / count);
+
+	// Solve L L^T delta = b
+	for (auto r = 0; r < 6; r++) 
+	{
+		for (auto c = 0; c < r; c++) b[r] -= _alignFactor[r * 6 + c] * b[c];
+		b[r] /= _alignFactor[r * 6 + r];
+	}
+	for (auto r = 5; r >= 0; r--) 
+	{
+		for (auto c = r + 1; c < 6; c++) b[r] -= _alignFactor[c * 6 + r] * b[c];
+		b[r] /= _alignFactor[r * 6 + r];
+	}
+	for (auto i = 0; i < 6; i++) delta[i] = b[i];
+
+	return true;
+}
+
+/**
+ * @brief Convert a color image into a floating point intensity image (a single channel image is just converted)
+ * @param color The color image (BGR)
+ * @param output The resultant intensity image
+ */
+void PoseImage::GetIntensity(Mat& color, Mat& output)
+{
+	if (color.channels() == 1) { color.convertTo(output, CV_32F); return; }
+
+	output.create(color.size(), CV_32FC1);
+	auto result = (float *)output.data; auto count = color.rows * color.cols;
+	for (auto i = 0; i < count; i++) 
+	{
+		auto pixel = color.data + i * 3;
+		result[i] = 0.114f * pixel[0] + 0.587f * pixel[1] + 0.299f * pixel[2];
+	}
+}
+
+/**
+ * @brief Factorize a symmetric positive definite 6x6 matrix (only the lower triangle is used) in place
+ * @param matrix The matrix, which is replaced by its lower triangular Cholesky factor
+ * @return true If the matrix was positive definite
+ * @return false If the factorization failed
+ */
+bool PoseImage::Factorize(double * matrix)
+{
+	for (auto c = 0; c < 6; c++)
+	{
+		auto diagonal = matrix[c * 6 + c];
+		for (auto k = 0; k < c; k++) diagonal -= matrix[c * 6 + k] * matrix[c * 6 + k];
+		if (diagonal <= 1e-12) return false;
+		matrix[c * 6 + c] = sqrt(diagonal);
+
+		for (auto r = c + 1; r < 6; r++)
+		{
+			auto value = matrix[r * 6 + c];
+			for (auto k = 0; k < c; k++) value -= matrix[r * 6 + k] * matrix[c * 6 + k];
+			matrix[r * 6 + c] = value / matrix[c * 6 + c];
+		}
+	}
+	return true;
+}
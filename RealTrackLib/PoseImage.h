@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <cfloat>
 #include <iostream>
 using namespace std;
 
@@ -18,25 +19,102 @@ using namespace std;
 #include <opencv2/opencv.hpp>
 using namespace cv;
 
+#include "SE3.h"
+#include "PerfCounters.h"
+
 namespace NVL_App
 {
 	class PoseImage
 	{
 	private:
+		typedef double (PoseImage::*ScoreKernel)(const SE3& pose, Mat& matchImage, Mat& matchDepth, double depthWeight, vector<double>& errors, int stride);
+		typedef double (PoseImage::*LumaKernel)(const SE3& pose, Mat& matchLuma, Mat& matchDepth, double depthWeight, int stride, vector<double> * errors);
+		typedef void (PoseImage::*BatchKernel)(const vector<SE3>& poses, Mat& matchLuma, Mat& matchDepth, double depthWeight, int stride, vector<double>& scores);
+		typedef void (PoseImage::*SplatKernel)(const SE3& pose, Mat * counter);
+
 		Mat _camera;
-		Mat _cloud;
+		double _fx, _fy, _cx, _cy;
+		Mat _depth;
+		Mat _color;
+		vector<double> _rayX;
+		vector<double> _rayY;
 		int _pixelCount;
+
+		vector<float> _splatDepth;
+		vector<float> _splatWeight;
+		vector<float> _splatNearest;
+		vector<uchar> _splatLabel;
+		vector<float> _splatLabelWeight;
+
+		Mat _intensity;
+		vector<float> _alignPoints;
+		vector<float> _alignValues;
+		vector<float> _alignJacobians;
+		double _alignFactor[36];
+		bool _alignReady;
+
+		Mat _luma;
+		bool _lumaReady;
+		vector<float> _rowZ;
+		vector<int> _rowU;
+		vector<int> _rowV;
+
+		vector<float> _batchPoses;
+		vector<int64_t> _batchPhotometric;
+		vector<double> _batchGeometric;
+		vector<int> _batchCount;
+
+		ScoreKernel _scoreKernel;
+		LumaKernel _lumaKernel;
+		BatchKernel _batchKernel;
+		SplatKernel _splatKernel;
 	public:
 		PoseImage(Mat& camera, NVLib::DepthFrame * frame);
+		PoseImage(Mat& camera, const Size& size);
 
-		Mat GetImage(Mat& pose);
-		Mat GetDepth(Mat& pose);
+		void SetFrame(NVLib::DepthFrame * frame);
 
-		Mat WarpCounter(Mat& pose, Mat& counter);
+		Mat GetImage(const SE3& pose);
+		Mat GetDepth(const SE3& pose);
+		void GetDepth(const SE3& pose, Mat& output);
 
-		double GetScore(Mat& pose, Mat& matchImage, vector<double>& errors);
+		Mat WarpCounter(const SE3& pose, Mat& counter);
+		void WarpCounter(const SE3& pose, Mat& counter, Mat& output);
+		void Warp(const SE3& pose, Mat& counter, Mat& depthOutput, Mat& counterOutput);
 
-		inline Mat& GetCloud() { return _cloud; }
+		double GetScore(const SE3& pose, Mat& matchImage, vector<double>& errors, int stride = 1);
+		double GetScore(const SE3& pose, Mat& matchImage, Mat& matchDepth, double depthWeight, vector<double>& errors, int stride = 1);
+		double GetLumaScore(const SE3& pose, Mat& matchLuma, Mat& matchDepth, double depthWeight, int stride = 1, vector<double> * errors = nullptr);
+		void GetScores(const vector<SE3>& poses, Mat& matchLuma, Mat& matchDepth, double depthWeight, int stride, vector<double>& scores);
+
+		void PrepareAlignment();
+		bool GetAlignmentStep(const SE3& pose, Mat& matchIntensity, Vec6d& delta, double& error);
+
+		Mat GetCloud();
 		inline int GetPixelCount() { return _pixelCount; }
+		inline int GetAlignmentCount() { return (int)_alignValues.size(); }
+
+		static void GetIntensity(Mat& color, Mat& output);
+	private:
+		void BuildRays(const Size& size);
+		void SelectKernels();
+		void PrepareLuma();
+		void CheckDepth(Mat& matchDepth, double depthWeight);
+		static bool Factorize(double * matrix);
+		void SplatSample(int target, float Z, float weight, uchar label, bool labels);
+		void WriteDepth(Mat& output);
+		void WriteCounter(Mat& output);
+
+		template <typename TDepth, int Channels> double Score(const SE3& pose, Mat& matchImage, Mat& matchDepth, double depthWeight, vector<double>& errors, int stride);
+		template <typename TDepth> double LumaScore(const SE3& pose, Mat& matchLuma, Mat& matchDepth, double depthWeight, int stride, vector<double> * errors);
+		template <typename TDepth> void BatchScores(const vector<SE3>& poses, Mat& matchLuma, Mat& matchDepth, double depthWeight, int stride, vector<double>& scores);
+		template <typename TDepth> int ProjectRow(const SE3& pose, int row, int stride);
+		template <typename TDepth> void Splat(const SE3& pose, Mat * counter);
+
+		inline double GetZ(int index) 
+		{
+			if (_depth.depth() == CV_16U) return ((ushort *)_depth.data)[index];
+			return ((float *)_depth.data)[index];
+		}
 	};
 }
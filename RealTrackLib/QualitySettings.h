@@ -0,0 +1,59 @@
+//--------------------------------------------------
+// The set of quality "knobs" that trade accuracy against latency within the pipeline
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+namespace NVL_App
+{
+	class QualitySettings
+	{
+	private:
+		int _keypointTarget;
+		int _lkWindow;
+		int _lkLevels;
+		int _ransacIterations;
+		int _pixelStride;
+		int _pyramidLevels;
+		int _refineIterations;
+	public:
+		QualitySettings() : 
+			_keypointTarget(0), _lkWindow(21), _lkLevels(3), _ransacIterations(10000), _pixelStride(1), _pyramidLevels(1), _refineIterations(1400) {}
+
+		QualitySettings(int keypointTarget, int lkWindow, int lkLevels, int ransacIterations, int pixelStride, int pyramidLevels, int refineIterations) :
+			_keypointTarget(keypointTarget), _lkWindow(lkWindow), _lkLevels(lkLevels), _ransacIterations(ransacIterations), _pixelStride(pixelStride), _pyramidLevels(pyramidLevels), _refineIterations(refineIterations) {}
+
+		/**
+		 * @brief Blend between two sets of settings
+		 * @param low The settings used at the lowest quality
+		 * @param high The settings used at the highest quality
+		 * @param quality The quality level (0 to 1)
+		 * @return QualitySettings The blended settings
+		 */
+		static inline QualitySettings Interpolate(QualitySettings& low, QualitySettings& high, double quality) 
+		{
+			auto blend = [quality](int a, int b) { return (int)round(a + (b - a) * quality); };
+			auto window = blend(low._lkWindow, high._lkWindow) | 1;
+			auto stride = (int)round(low._pixelStride * pow((double)high._pixelStride / low._pixelStride, quality));
+			return QualitySettings(blend(low._keypointTarget, high._keypointTarget), window, blend(low._lkLevels, high._lkLevels), blend(low._ransacIterations, high._ransacIterations), stride, blend(low._pyramidLevels, high._pyramidLevels), blend(low._refineIterations, high._refineIterations));
+		}
+
+		inline int& GetKeypointTarget() { return _keypointTarget; }
+		inline int& GetLKWindow() { return _lkWindow; }
+		inline int& GetLKLevels() { return _lkLevels; }
+		inline int& GetRansacIterations() { return _ransacIterations; }
+		inline int& GetPixelStride() { return _pixelStride; }
+		inline int& GetPyramidLevels() { return _pyramidLevels; }
+		inline int& GetRefineIterations() { return _refineIterations; }
+	};
+}
@@ -0,0 +1,58 @@
+//--------------------------------------------------
+// Implementation of class RectifiedSource
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "RectifiedSource.h"
+using namespace NVL_App;
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor (takes ownership of the wrapped source, and builds the lookup tables up front)
+ * @param source The source that provides the raw frames
+ * @param calibration The calibration of the sequence
+ */
+RectifiedSource::RectifiedSource(FrameSource * source, Calibration * calibration) : _source(source)
+{
+	_rectifier = new FrameRectifier(calibration, source->GetSize());
+}
+
+/**
+ * @brief Main Terminator
+ */
+RectifiedSource::~RectifiedSource()
+{
+	delete _rectifier; delete _source;
+}
+
+//--------------------------------------------------
+// Frame Retrieval
+//--------------------------------------------------
+
+/**
+ * @brief Load the next frame from the wrapped source and correct it
+ * @param output The corrected frame
+ * @return true If a frame was loaded
+ * @return false If the sequence has ended
+ */
+bool RectifiedSource::Next(SourceFrame& output)
+{
+	if (!_source->Next(output)) return false;
+	_rectifier->Apply(output.GetFrame());
+	return true;
+}
+
+/**
+ * @brief Hand the frame back to the wrapped source
+ * @param frame The frame that we are releasing
+ */
+void RectifiedSource::Release(NVLib::DepthFrame * frame)
+{
+	_source->Release(frame);
+}
@@ -0,0 +1,39 @@
+//--------------------------------------------------
+// Wraps another frame source, correcting each frame for lens distortion (see FrameRectifier) as it is loaded. When
+// the frames are replayed, this happens on the producer thread of the replay along with the rest of the loading
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include "FrameSource.h"
+#include "FrameRectifier.h"
+
+namespace NVL_App
+{
+	class RectifiedSource : public FrameSource
+	{
+	private:
+		FrameSource * _source;
+		FrameRectifier * _rectifier;
+	public:
+		RectifiedSource(FrameSource * source, Calibration * calibration);
+		~RectifiedSource();
+
+		bool Next(SourceFrame& output) override;
+		void Release(NVLib::DepthFrame * frame) override;
+
+		inline Size GetSize() override { return _source->GetSize(); }
+		inline int GetFrameCount() override { return _source->GetFrameCount(); }
+		inline int GetDropped() override { return _source->GetDropped(); }
+	};
+}
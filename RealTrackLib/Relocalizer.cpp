@@ -0,0 +1,180 @@
+//--------------------------------------------------
+// Implementation of class Relocalizer
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "Relocalizer.h"
+using namespace NVL_App;
+
+// The size of the thumbnail that summarizes a frame, and the ratio test used when matching candidates
+#define THUMBNAIL_WIDTH 40
+#define THUMBNAIL_HEIGHT 30
+#define MATCH_RATIO 0.8
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor
+ * @param calibration The calibration of the camera
+ * @param referenceCount The number of recent keyframes that are kept for relocalization
+ * @param candidateCount The maximum number of candidates that are verified per frame
+ * @param budget The time (in milliseconds) that a relocalization attempt may take
+ * @param minInliers The number of PnP inliers that a relocalization needs to be accepted
+ */
+Relocalizer::Relocalizer(Calibration * calibration, int referenceCount, int candidateCount, double budget, int minInliers) :
+	_focals(calibration->GetFocals()), _center(calibration->GetCenter()), _referenceCount(referenceCount), _candidateCount(candidateCount),
+	_budget(budget), _minInliers(minInliers), _matcher(NORM_HAMMING), _lastMatch(-1)
+{
+	_camera = calibration->GetMatrix();
+	_estimator = new PoseEstimator(200);
+	_orb = ORB::create();
+}
+
+/**
+ * @brief Main Terminator
+ */
+Relocalizer::~Relocalizer()
+{
+	for (auto reference : _references) delete reference;
+	delete _estimator;
+}
+
+//--------------------------------------------------
+// Add
+//--------------------------------------------------
+
+/**
+ * @brief Add a keyframe as a relocalization reference. Only the thumbnail is built here, the ORB descriptors are
+ * left until the reference is first needed, so that this stays cheap on the tracking thread
+ * @param keyframe The keyframe (which must carry its color image), ownership passes to the relocalizer
+ */
+void Relocalizer::AddKeyframe(Keyframe * keyframe)
+{
+	auto reference = new RelocalizationReference(keyframe->GetId(), keyframe->GetOdometry());
+
+	auto& image = keyframe->GetImage();
+	if (image.channels() == 3) cvtColor(image, reference->GetGray(), COLOR_BGR2GRAY); else reference->GetGray() = image.clone();
+	BuildThumbnail(reference->GetGray(), reference->GetThumbnail());
+
+	for (auto& observation : keyframe->GetObservations())
+	{
+		if (observation.GetDepth() <= 0) continue;
+		auto& point = observation.GetPoint(); auto Z = observation.GetDepth();
+		reference->GetKeypoints().push_back(KeyPoint(Point2f(point), 31.0f, -1, 0, 0, (int)reference->GetPoints().size()));
+		reference->GetPoints().push_back(Point3f((point.x - _center.x) * Z / _focals[0], (point.y - _center.y) * Z / _focals[1], Z));
+	}
+	delete keyframe;
+
+	_references.push_back(reference);
+	while ((int)_references.size() > _referenceCount) { delete _references.front(); _references.pop_front(); }
+}
+
+//--------------------------------------------------
+// Relocalize
+//--------------------------------------------------
+
+/**
+ * @brief Attempt to recover the pose of a frame that could not be tracked. The references are ranked by thumbnail
+ * similarity and the best ones are verified in turn, until one succeeds or the time budget runs out
+ * @param image The color image of the frame
+ * @param keypoints The keypoints that were detected in the frame
+ * @param reference The odometry pose (camera to world) of the frame that the tracker is matching against
+ * @param pose The pose of the frame relative to that reference, in the form that the tracker returns
+ * @return true If the frame was relocalized
+ * @return false If no candidate could be verified within the budget
+ */
+bool Relocalizer::Relocalize(Mat& image, vector<KeyPoint>& keypoints, const SE3& reference, SE3& pose)
+{
+	auto start = chrono::steady_clock::now(); _lastMatch = -1;
+	if (_references.empty() || keypoints.empty()) return false;
+
+	if (image.channels() == 3) cvtColor(image, _gray, COLOR_BGR2GRAY); else _gray = image;
+	BuildThumbnail(_gray, _thumbnail);
+
+	// Rank the references by the correlation of their thumbnails
+	auto scores = vector< pair<double, int> >();
+	for (auto i = 0; i < (int)_references.size(); i++) scores.push_back(make_pair(-_thumbnail.dot(_references[i]->GetThumbnail()), i));
+	sort(scores.begin(), scores.end());
+
+	// Describe the frame (the keypoints remember their index, since ORB drops those near the border)
+	_keypoints.clear();
+	for (auto i = 0; i < (int)keypoints.size(); i++) { _keypoints.push_back(keypoints[i]); _keypoints.back().class_id = i; }
+	_orb->compute(_gray, _keypoints, _descriptors);
+	if (_descriptors.empty()) return false;
+
+	for (auto i = 0; i < min(_candidateCount, (int)scores.size()); i++)
+	{
+		if (chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() > _budget) break;
+
+		auto candidate = _references[scores[i].second]; auto relative = SE3();
+		if (!Verify(candidate, relative)) continue;
+
+		// The estimate maps the candidate camera into the frame, so chain it back to the tracking reference
+		pose = relative * candidate->GetOdometry().Inverse() * reference;
+		_lastMatch = candidate->GetKeyframeId();
+		return true;
+	}
+
+	return false;
+}
+
+//--------------------------------------------------
+// Helpers
+//--------------------------------------------------
+
+/**
+ * @brief Build the global descriptor of an image: a small, blurred, zero mean and unit length thumbnail
+ * @param gray The grayscale image
+ * @param output The resultant thumbnail
+ */
+void Relocalizer::BuildThumbnail(Mat& gray, Mat& output)
+{
+	Mat small; resize(gray, small, Size(THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT), 0, 0, INTER_AREA);
+	GaussianBlur(small, small, Size(5, 5), 2.5);
+	small.convertTo(output, CV_32F);
+	output -= mean(output)[0];
+	normalize(output, output);
+}
+
+/**
+ * @brief Compute the ORB descriptors of a reference (once), after which its image is no longer needed
+ * @param reference The reference that we are describing
+ */
+void Relocalizer::Describe(RelocalizationReference * reference)
+{
+	if (reference->GetDescribed()) return;
+	_orb->compute(reference->GetGray(), reference->GetKeypoints(), reference->GetDescriptors());
+	reference->GetGray().release(); reference->GetDescribed() = true;
+}
+
+/**
+ * @brief Match a reference against the frame and estimate the relative pose with PnP
+ * @param reference The reference that we are verifying
+ * @param pose The pose that maps the reference camera into the frame camera
+ * @return true If there were enough inliers
+ * @return false If the reference does not match the frame
+ */
+bool Relocalizer::Verify(RelocalizationReference * reference, SE3& pose)
+{
+	Describe(reference);
+	if (reference->GetDescriptors().empty()) return false;
+
+	_matches.clear(); _matcher.knnMatch(reference->GetDescriptors(), _descriptors, _matches, 2);
+
+	_scenePoints.clear(); _imagePoints.clear();
+	for (auto& match : _matches)
+	{
+		if (match.size() < 2 || match[0].distance > MATCH_RATIO * match[1].distance) continue;
+		_scenePoints.push_back(reference->GetPoints()[reference->GetKeypoints()[match[0].queryIdx].class_id]);
+		_imagePoints.push_back(_keypoints[match[0].trainIdx].pt);
+	}
+	if ((int)_scenePoints.size() < _minInliers) return false;
+
+	auto error = Vec2d(); pose = _estimator->Estimate(_camera, _scenePoints, _imagePoints, error);
+	return (int)_estimator->GetInliers().size() >= _minInliers;
+}
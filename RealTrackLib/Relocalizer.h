@@ -0,0 +1,89 @@
+//--------------------------------------------------
+// Recovers the pose after a tracking failure. Recent keyframes are summarized by a tiny blurred thumbnail, so
+// that the closest ones can be found with a handful of dot products, and the best candidates are then matched
+// with ORB and verified with PnP until the time budget runs out
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <deque>
+#include <chrono>
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include "SE3.h"
+#include "Keyframe.h"
+#include "Calibration.h"
+#include "PoseEstimator.h"
+
+namespace NVL_App
+{
+	class RelocalizationReference
+	{
+	private:
+		int _keyframeId;
+		SE3 _odometry;
+		Mat _thumbnail;
+		Mat _gray;
+		vector<Point3f> _points;
+		vector<KeyPoint> _keypoints;
+		Mat _descriptors;
+		bool _described;
+	public:
+		RelocalizationReference(int keyframeId, const SE3& odometry) : _keyframeId(keyframeId), _odometry(odometry), _described(false) {}
+
+		inline int& GetKeyframeId() { return _keyframeId; }
+		inline SE3& GetOdometry() { return _odometry; }
+		inline Mat& GetThumbnail() { return _thumbnail; }
+		inline Mat& GetGray() { return _gray; }
+		inline vector<Point3f>& GetPoints() { return _points; }
+		inline vector<KeyPoint>& GetKeypoints() { return _keypoints; }
+		inline Mat& GetDescriptors() { return _descriptors; }
+		inline bool& GetDescribed() { return _described; }
+	};
+
+	class Relocalizer
+	{
+	private:
+		Mat _camera;
+		Vec2d _focals;
+		Point2d _center;
+		int _referenceCount;
+		int _candidateCount;
+		double _budget;
+		int _minInliers;
+
+		deque<RelocalizationReference *> _references;
+		PoseEstimator * _estimator;
+		Ptr<ORB> _orb;
+		BFMatcher _matcher;
+		int _lastMatch;
+
+		Mat _gray;
+		Mat _thumbnail;
+		vector<KeyPoint> _keypoints;
+		Mat _descriptors;
+		vector< vector<DMatch> > _matches;
+		vector<Point3f> _scenePoints;
+		vector<Point2f> _imagePoints;
+	public:
+		Relocalizer(Calibration * calibration, int referenceCount, int candidateCount, double budget, int minInliers);
+		~Relocalizer();
+
+		void AddKeyframe(Keyframe * keyframe);
+		bool Relocalize(Mat& image, vector<KeyPoint>& keypoints, const SE3& reference, SE3& pose);
+
+		inline int GetLastMatch() { return _lastMatch; }
+	private:
+		void BuildThumbnail(Mat& gray, Mat& output);
+		void Describe(RelocalizationReference * reference);
+		bool Verify(RelocalizationReference * reference, SE3& pose);
+	};
+}
@@ -0,0 +1,165 @@
+//--------------------------------------------------
+// Implementation of class ReplaySource
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "ReplaySource.h"
+using namespace NVL_App;
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor (takes ownership of the wrapped source and starts releasing frames straight away)
+ * @param source The source that we are replaying
+ * @param frameRate The rate at which frames are released (0 to use the recorded timestamps)
+ * @param policy What to do when the queue is full because the consumer has fallen behind
+ * @param queueSize The number of released frames that may wait for the consumer
+ */
+ReplaySource::ReplaySource(FrameSource * source, double frameRate, DropPolicy policy, int queueSize) : 
+	_source(source), _frameRate(frameRate), _policy(policy), _head(0), _count(0), _dropped(0), _finished(false), _stop(false)
+{
+	if (queueSize <= 0) throw runtime_error("The replay queue size must be positive");
+	_queue.resize(queueSize);
+	_producer = thread(&ReplaySource::Produce, this, PerfCounters::GetSession());
+}
+
+/**
+ * @brief Main Terminator
+ */
+ReplaySource::~ReplaySource()
+{
+	{
+		lock_guard<mutex> guard(_lock);
+		_stop = true;
+	}
+	_available.notify_all(); _space.notify_all();
+	if (_producer.joinable()) _producer.join();
+
+	for (auto i = 0; i < _count; i++) _source->Release(_queue[(_head + i) % _queue.size()].GetFrame());
+	delete _source;
+}
+
+//--------------------------------------------------
+// Consumer
+//--------------------------------------------------
+
+/**
+ * @brief Wait for the next released frame
+ * @param output The frame that was released
+ * @return true If a frame was retrieved
+ * @return false If the replay has finished
+ */
+bool ReplaySource::Next(SourceFrame& output)
+{
+	unique_lock<mutex> lock(_lock);
+	_available.wait(lock, [this] { return _count > 0 || _finished || _stop; });
+	if (_count == 0) return false;
+
+	output = _queue[_head]; _head = (_head + 1) % _queue.size(); _count--;
+	_space.notify_one();
+
+	return true;
+}
+
+/**
+ * @brief Hand the frame back to the wrapped source
+ * @param frame The frame that we are releasing
+ */
+void ReplaySource::Release(NVLib::DepthFrame * frame)
+{
+	_source->Release(frame);
+}
+
+/**
+ * @brief Retrieve the number of frames that were dropped because the consumer fell behind
+ * @return int The number of dropped frames
+ */
+int ReplaySource::GetDropped()
+{
+	lock_guard<mutex> guard(_lock);
+	return _dropped;
+}
+
+//--------------------------------------------------
+// Producer
+//--------------------------------------------------
+
+/**
+ * @brief The producer loop, which loads frames ahead of time and releases them on schedule
+ * @param session The perf session of the thread that started the worker (see PerfCounters)
+ */
+void ReplaySource::Produce(PerfSession * session)
+{
+	PerfCounters::SetSession(session); PerfCounters::SetThreadName("replay");
+	auto start = chrono::steady_clock::now(); auto firstTimestamp = 0.0; auto count = 0;
+
+	while (!_stop)
+	{
+		auto frame = SourceFrame(); 
+		if (!_source->Next(frame)) break;
+		if (count == 0) firstTimestamp = frame.GetTimestamp();
+
+		// Wait until the frame is "captured"
+		auto offset = _frameRate > 0 ? count / _frameRate : frame.GetTimestamp() - firstTimestamp;
+		this_thread::sleep_until(start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(offset)));
+
+		frame.GetArrival() = chrono::steady_clock::now();
+		Push(frame); count++;
+	}
+
+	lock_guard<mutex> guard(_lock);
+	_finished = true; _available.notify_all();
+}
+
+/**
+ * @brief Place a frame onto the queue, applying the drop policy if the consumer has fallen behind
+ * @param frame The frame that we are pushing
+ */
+void ReplaySource::Push(SourceFrame& frame)
+{
+	unique_lock<mutex> lock(_lock);
+
+	if (_count == (int)_queue.size())
+	{
+		if (_policy == DropPolicy::BLOCK) 
+		{
+			_space.wait(lock, [this] { return _count < (int)_queue.size() || _stop; });
+			if (_stop) { _source->Release(frame.GetFrame()); return; }
+		}
+		else if (_policy == DropPolicy::DROP_NEWEST) 
+		{
+			_dropped++; _source->Release(frame.GetFrame());
+			return;
+		}
+		else 
+		{
+			_dropped++; _source->Release(_queue[_head].GetFrame());
+			_head = (_head + 1) % _queue.size(); _count--;
+		}
+	}
+
+	_queue[(_head + _count) % _queue.size()] = frame; _count++;
+	_available.notify_one();
+}
+
+//--------------------------------------------------
+// Helpers
+//--------------------------------------------------
+
+/**
+ * @brief Convert a configuration string into a drop policy
+ * @param value The value from the configuration (oldest, newest or block)
+ * @return DropPolicy The resultant policy
+ */
+DropPolicy ReplaySource::ParsePolicy(const string& value)
+{
+	if (value == "oldest") return DropPolicy::DROP_OLDEST;
+	if (value == "newest") return DropPolicy::DROP_NEWEST;
+	if (value == "block") return DropPolicy::BLOCK;
+	throw runtime_error("Unknown drop policy: " + value);
+}
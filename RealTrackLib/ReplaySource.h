@@ -0,0 +1,62 @@
+//--------------------------------------------------
+// Replays another frame source at a real-time cadence, dropping frames when the consumer falls behind
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include "FrameSource.h"
+#include "PerfCounters.h"
+
+namespace NVL_App
+{
+	enum class DropPolicy { DROP_OLDEST, DROP_NEWEST, BLOCK };
+
+	class ReplaySource : public FrameSource
+	{
+	private:
+		FrameSource * _source;
+		double _frameRate;
+		DropPolicy _policy;
+
+		vector<SourceFrame> _queue;
+		int _head;
+		int _count;
+		int _dropped;
+		bool _finished;
+		atomic<bool> _stop;
+
+		mutex _lock;
+		condition_variable _available;
+		condition_variable _space;
+		thread _producer;
+	public:
+		ReplaySource(FrameSource * source, double frameRate, DropPolicy policy, int queueSize);
+		~ReplaySource();
+
+		bool Next(SourceFrame& output) override;
+		void Release(NVLib::DepthFrame * frame) override;
+
+		inline Size GetSize() override { return _source->GetSize(); }
+		inline int GetFrameCount() override { return _source->GetFrameCount(); }
+		int GetDropped() override;
+
+		static DropPolicy ParsePolicy(const string& value);
+	private:
+		void Produce(PerfSession * session);
+		void Push(SourceFrame& frame);
+	};
+}
@@ -0,0 +1,131 @@
+//--------------------------------------------------
+// Implementation of class RunReport
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "RunReport.h"
+using namespace NVL_App;
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor
+ * @param expectedFrames The number of frames we expect (so that the latency buffer is allocated once)
+ */
+RunReport::RunReport(int expectedFrames) : _frameCount(0), _trackedCount(0), _failedCount(0), _relocalizedCount(0), _droppedCount(0), _qualitySum(0), _countersAvailable(-1)
+{
+	_latencies.reserve(max(expectedFrames, 0));
+}
+
+//--------------------------------------------------
+// Add Results
+//--------------------------------------------------
+
+/**
+ * @brief Record a frame that was tracked successfully
+ * @param latency The time (in milliseconds) from frame arrival until the result was ready
+ */
+void RunReport::AddTracked(double latency)
+{
+	_frameCount++; _trackedCount++; _latencies.push_back(latency);
+}
+
+/**
+ * @brief Record a frame for which tracking failed
+ * @param latency The time (in milliseconds) from frame arrival until the failure was known
+ */
+void RunReport::AddFailed(double latency)
+{
+	_frameCount++; _failedCount++; _latencies.push_back(latency);
+}
+
+/**
+ * @brief Record the time that a pipeline stage took for a frame
+ * @param name The name of the stage
+ * @param milliseconds The time that the stage took
+ */
+void RunReport::AddStage(const string& name, double milliseconds)
+{
+	auto& stage = _stages[name];
+	stage[0] += milliseconds; stage[1]++; stage[2] = max(stage[2], milliseconds);
+}
+
+/**
+ * @brief Set the hardware counter totals of the run (only written to the report once this has been called)
+ * @param available Whether the counters could be opened (if not, only this is written)
+ * @param counters The totals, keyed by "<stage>_<thread>"
+ */
+void RunReport::SetCounters(bool available, const map<string, PerfSample>& counters)
+{
+	_countersAvailable = available ? 1 : 0; _counters = counters;
+}
+
+//--------------------------------------------------
+// Save
+//--------------------------------------------------
+
+/**
+ * @brief Write the report to disk
+ * @param path The path that we are writing to
+ */
+void RunReport::Save(const string& path)
+{
+	auto sorted = _latencies; sort(sorted.begin(), sorted.end());
+	auto mean = 0.0; for (auto latency : sorted) mean += latency;
+	if (sorted.size() > 0) mean /= sorted.size();
+	auto total = _frameCount + _droppedCount;
+
+	auto writer = FileStorage(path, FileStorage::FORMAT_XML | FileStorage::WRITE);
+	if (!writer.isOpened()) throw runtime_error("Unable to open file: " + path);
+
+	writer << "frames" << _frameCount;
+	writer << "tracked" << _trackedCount;
+	writer << "failed" << _failedCount;
+	writer << "relocalized" << _relocalizedCount;
+	writer << "dropped" << _droppedCount;
+	writer << "drop_rate" << (total == 0 ? 0.0 : (double)_droppedCount / total);
+	writer << "latency_mean_ms" << mean;
+	writer << "latency_p50_ms" << GetPercentile(sorted, 0.5);
+	writer << "latency_p95_ms" << GetPercentile(sorted, 0.95);
+	writer << "latency_p99_ms" << GetPercentile(sorted, 0.99);
+	writer << "latency_max_ms" << (sorted.size() == 0 ? 0.0 : sorted.back());
+	writer << "quality_mean" << (_frameCount == 0 ? 0.0 : _qualitySum / _frameCount);
+
+	for (auto& stage : _stages) 
+	{
+		writer << ("stage_" + stage.first + "_mean_ms") << (stage.second[1] == 0 ? 0.0 : stage.second[0] / stage.second[1]);
+		writer << ("stage_" + stage.first + "_max_ms") << stage.second[2];
+	}
+
+	if (_countersAvailable >= 0) writer << "perf_available" << _countersAvailable;
+	for (auto& entry : _counters) 
+	{
+		auto& sample = entry.second; auto prefix = "perf_" + entry.first;
+		writer << (prefix + "_calls") << sample.GetCalls();
+		for (auto i = 0; i < (int)PerfCounter::COUNT; i++) writer << (prefix + "_" + PerfCounters::GetCounterName((PerfCounter)i)) << sample.GetValue((PerfCounter)i);
+
+		auto cycles = sample.GetValue(PerfCounter::CYCLES); auto instructions = sample.GetValue(PerfCounter::INSTRUCTIONS);
+		writer << (prefix + "_ipc") << (cycles == 0 ? 0.0 : instructions / cycles);
+		writer << (prefix + "_llc_mpki") << (instructions == 0 ? 0.0 : sample.GetValue(PerfCounter::CACHE_MISSES) * 1000 / instructions);
+	}
+
+	writer.release();
+}
+
+/**
+ * @brief Retrieve a percentile from a sorted list
+ * @param sorted The sorted values
+ * @param percentile The percentile (0 to 1)
+ * @return double The value at the percentile
+ */
+double RunReport::GetPercentile(vector<double>& sorted, double percentile)
+{
+	if (sorted.size() == 0) return 0;
+	auto index = (int)round(percentile * (sorted.size() - 1));
+	return sorted[index];
+}
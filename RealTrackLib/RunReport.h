@@ -0,0 +1,57 @@
+//--------------------------------------------------
+// Collects the per-run statistics (latency, drops, failures) and writes them to disk
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <map>
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include "PerfCounters.h"
+
+namespace NVL_App
+{
+	class RunReport
+	{
+	private:
+		int _frameCount;
+		int _trackedCount;
+		int _failedCount;
+		int _relocalizedCount;
+		int _droppedCount;
+		vector<double> _latencies;
+		map<string, Vec3d> _stages;
+		double _qualitySum;
+		int _countersAvailable;
+		map<string, PerfSample> _counters;
+	public:
+		RunReport(int expectedFrames);
+
+		void AddTracked(double latency);
+		void AddFailed(double latency);
+		inline void AddRelocalized() { _relocalizedCount++; }
+		inline void SetDropped(int dropped) { _droppedCount = dropped; }
+		void AddStage(const string& name, double milliseconds);
+		inline void AddQuality(double quality) { _qualitySum += quality; }
+		void SetCounters(bool available, const map<string, PerfSample>& counters);
+
+		void Save(const string& path);
+
+		inline int GetFrameCount() { return _frameCount; }
+		inline int GetTrackedCount() { return _trackedCount; }
+		inline int GetFailedCount() { return _failedCount; }
+		inline int GetRelocalizedCount() { return _relocalizedCount; }
+		inline int GetDroppedCount() { return _droppedCount; }
+		inline vector<double>& GetLatencies() { return _latencies; }
+	private:
+		double GetPercentile(vector<double>& sorted, double percentile);
+	};
+}
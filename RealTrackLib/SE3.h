@@ -0,0 +1,303 @@
+//--------------------------------------------------
+// A fixed-size rigid body transform (rotation + translation) that lives on the stack
+//
+// Twists are ordered (w, v): rotation first and translation second, matching the
+// (rvec, tvec) ordering that OpenCV and the refiner use.
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <cmath>
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+namespace NVL_App
+{
+	class SE3
+	{
+	private:
+		double _r[9];
+		double _t[3];
+	public:
+		constexpr SE3() : _r{ 1, 0, 0, 0, 1, 0, 0, 0, 1 }, _t{ 0, 0, 0 } {}
+
+		constexpr SE3(const double * rotation, const double * translation) : _r{}, _t{}
+		{
+			for (auto i = 0; i < 9; i++) _r[i] = rotation[i];
+			for (auto i = 0; i < 3; i++) _t[i] = translation[i];
+		}
+
+		//--------------------------------------------------
+		// Group Operations
+		//--------------------------------------------------
+
+		/**
+		 * @brief The closed form inverse [R^T | -R^T t]
+		 * @return SE3 The inverse transform
+		 */
+		constexpr SE3 Inverse() const
+		{
+			double r[9] = { _r[0], _r[3], _r[6], _r[1], _r[4], _r[7], _r[2], _r[5], _r[8] };
+			double t[3] =
+			{
+				-(r[0] * _t[0] + r[1] * _t[1] + r[2] * _t[2]),
+				-(r[3] * _t[0] + r[4] * _t[1] + r[5] * _t[2]),
+				-(r[6] * _t[0] + r[7] * _t[1] + r[8] * _t[2])
+			};
+			return SE3(r, t);
+		}
+
+		/**
+		 * @brief Composition (this * other), i.e. apply other first and then this
+		 * @param other The transform on the right
+		 * @return SE3 The composed transform
+		 */
+		constexpr SE3 operator*(const SE3& other) const
+		{
+			double r[9] = {}; double t[3] = {};
+			for (auto row = 0; row < 3; row++)
+			{
+				for (auto column = 0; column < 3; column++)
+				{
+					r[row * 3 + column] = _r[row * 3 + 0] * other._r[0 + column] + _r[row * 3 + 1] * other._r[3 + column] + _r[row * 3 + 2] * other._r[6 + column];
+				}
+				t[row] = _r[row * 3 + 0] * other._t[0] + _r[row * 3 + 1] * other._t[1] + _r[row * 3 + 2] * other._t[2] + _t[row];
+			}
+			return SE3(r, t);
+		}
+
+		/**
+		 * @brief Transform a point
+		 * @param point The point that we are transforming
+		 * @return Point3d The transformed point
+		 */
+		inline Point3d Transform(const Point3d& point) const
+		{
+			return Point3d(
+				_r[0] * point.x + _r[1] * point.y + _r[2] * point.z + _t[0],
+				_r[3] * point.x + _r[4] * point.y + _r[5] * point.z + _t[1],
+				_r[6] * point.x + _r[7] * point.y + _r[8] * point.z + _t[2]);
+		}
+
+		/**
+		 * @brief Transform a point given as separate coordinates (the form the per-pixel kernels use)
+		 */
+		constexpr void Transform(double x, double y, double z, double& X, double& Y, double& Z) const
+		{
+			X = _r[0] * x + _r[1] * y + _r[2] * z + _t[0];
+			Y = _r[3] * x + _r[4] * y + _r[5] * z + _t[1];
+			Z = _r[6] * x + _r[7] * y + _r[8] * z + _t[2];
+		}
+
+		/**
+		 * @brief The adjoint, which moves a twist (w, v) across the transform: T * Exp(x) * T^-1 = Exp(Ad * x)
+		 * @param output The 6x6 row-major adjoint [R 0; [t]x R R]
+		 */
+		constexpr void Adjoint(double * output) const
+		{
+			for (auto i = 0; i < 36; i++) output[i] = 0;
+			for (auto row = 0; row < 3; row++)
+			{
+				for (auto column = 0; column < 3; column++)
+				{
+					auto r = _r[row * 3 + column];
+					output[row * 6 + column] = r; output[(row + 3) * 6 + column + 3] = r;
+
+					// [t]x R
+					auto a = (row + 1) % 3, b = (row + 2) % 3;
+					output[(row + 3) * 6 + column] = _t[a] * _r[b * 3 + column] - _t[b] * _r[a * 3 + column];
+				}
+			}
+		}
+
+		//--------------------------------------------------
+		// Exponential and Logarithm Maps
+		//--------------------------------------------------
+
+		/**
+		 * @brief The so(3) exponential map (Rodrigues formula), with a series expansion near zero
+		 * @param w The rotation vector
+		 * @param r The output rotation matrix (row-major 3x3)
+		 */
+		static inline void RotationExp(const double * w, double * r)
+		{
+			auto theta2 = w[0] * w[0] + w[1] * w[1] + w[2] * w[2];
+			auto theta = sqrt(theta2);
+
+			double a, b;
+			if (theta < 1e-8) { a = 1 - theta2 / 6; b = 0.5 - theta2 / 24; }
+			else { a = sin(theta) / theta; b = (1 - cos(theta)) / theta2; }
+
+			auto xx = w[0] * w[0], yy = w[1] * w[1], zz = w[2] * w[2];
+			auto xy = w[0] * w[1], xz = w[0] * w[2], yz = w[1] * w[2];
+
+			r[0] = 1 - b * (yy + zz); r[1] = b * xy - a * w[2];   r[2] = b * xz + a * w[1];
+			r[3] = b * xy + a * w[2];   r[4] = 1 - b * (xx + zz); r[5] = b * yz - a * w[0];
+			r[6] = b * xz - a * w[1];   r[7] = b * yz + a * w[0];   r[8] = 1 - b * (xx + yy);
+		}
+
+		/**
+		 * @brief The SO(3) logarithm map
+		 * @param r The rotation matrix (row-major 3x3)
+		 * @param w The output rotation vector
+		 */
+		static inline void RotationLog(const double * r, double * w)
+		{
+			auto cosTheta = min(max((r[0] + r[4] + r[8] - 1) * 0.5, -1.0), 1.0);
+			auto theta = acos(cosTheta);
+
+			if (theta < 1e-8)
+			{
+				w[0] = 0.5 * (r[7] - r[5]); w[1] = 0.5 * (r[2] - r[6]); w[2] = 0.5 * (r[3] - r[1]);
+			}
+			else if (M_PI - theta < 1e-6)
+			{
+				// Near pi the skew part vanishes, so recover the axis from the diagonal
+				auto i = (r[0] >= r[4] && r[0] >= r[8]) ? 0 : (r[4] >= r[8] ? 1 : 2);
+				double axis[3]; axis[i] = sqrt(max((r[i * 4] + 1) * 0.5, 0.0));
+				for (auto j = 0; j < 3; j++) if (j != i) axis[j] = r[i * 3 + j] / (2 * axis[i]);
+				for (auto j = 0; j < 3; j++) w[j] = axis[j] * theta;
+			}
+			else
+			{
+				auto scale = theta / (2 * sin(theta));
+				w[0] = scale * (r[7] - r[5]); w[1] = scale * (r[2] - r[6]); w[2] = scale * (r[3] - r[1]);
+			}
+		}
+
+		/**
+		 * @brief The se(3) exponential map
+		 * @param twist The twist (w, v)
+		 * @return SE3 The resultant transform
+		 */
+		static inline SE3 Exp(const Vec6d& twist)
+		{
+			double w[3] = { twist[0], twist[1], twist[2] }; double v[3] = { twist[3], twist[4], twist[5] };
+			double r[9]; RotationExp(w, r);
+
+			double t[3]; ApplyV(w, v, t, false);
+			return SE3(r, t);
+		}
+
+		/**
+		 * @brief The SE(3) logarithm map
+		 * @return Vec6d The twist (w, v)
+		 */
+		inline Vec6d Log() const
+		{
+			double w[3]; RotationLog(_r, w);
+			double v[3]; ApplyV(w, _t, v, true);
+			return Vec6d(w[0], w[1], w[2], v[0], v[1], v[2]);
+		}
+
+		//--------------------------------------------------
+		// Conversion (rotation vector / translation and cv::Mat)
+		//--------------------------------------------------
+
+		/**
+		 * @brief Build a transform from a rotation vector and a translation (the OpenCV convention)
+		 * @param rvec The rotation vector
+		 * @param tvec The translation vector
+		 * @return SE3 The resultant transform
+		 */
+		static inline SE3 FromVectors(const Vec3d& rvec, const Vec3d& tvec)
+		{
+			double w[3] = { rvec[0], rvec[1], rvec[2] }; double t[3] = { tvec[0], tvec[1], tvec[2] };
+			double r[9]; RotationExp(w, r);
+			return SE3(r, t);
+		}
+
+		/**
+		 * @brief Convert to a rotation vector and a translation (the OpenCV convention)
+		 * @param rvec The output rotation vector
+		 * @param tvec The output translation vector
+		 */
+		inline void ToVectors(Vec3d& rvec, Vec3d& tvec) const
+		{
+			double w[3]; RotationLog(_r, w);
+			rvec = Vec3d(w[0], w[1], w[2]); tvec = Vec3d(_t[0], _t[1], _t[2]);
+		}
+
+		/**
+		 * @brief Convert from a 4x4 (or 3x4) pose matrix
+		 * @param pose The pose matrix
+		 * @return SE3 The resultant transform
+		 */
+		static inline SE3 FromMat(const Mat& pose)
+		{
+			Mat_<double> input = pose;
+			double r[9]; double t[3];
+			for (auto row = 0; row < 3; row++)
+			{
+				for (auto column = 0; column < 3; column++) r[row * 3 + column] = input(row, column);
+				t[row] = input(row, 3);
+			}
+			return SE3(r, t);
+		}
+
+		/**
+		 * @brief Convert to a 4x4 pose matrix (only needed at the API boundary)
+		 * @return Mat The pose matrix
+		 */
+		inline Mat ToMat() const
+		{
+			Mat result = Mat_<double>::eye(4, 4);
+			auto data = (double *)result.data;
+			for (auto row = 0; row < 3; row++)
+			{
+				for (auto column = 0; column < 3; column++) data[row * 4 + column] = _r[row * 3 + column];
+				data[row * 4 + 3] = _t[row];
+			}
+			return result;
+		}
+
+		//--------------------------------------------------
+		// Accessors
+		//--------------------------------------------------
+
+		constexpr double R(int row, int column) const { return _r[row * 3 + column]; }
+		constexpr double T(int index) const { return _t[index]; }
+		constexpr const double * GetRotation() const { return _r; }
+		constexpr const double * GetTranslation() const { return _t; }
+		inline Vec3d GetTranslationVector() const { return Vec3d(_t[0], _t[1], _t[2]); }
+	private:
+		/**
+		 * @brief Multiply by the left Jacobian V of SO(3) (or by its inverse)
+		 * @param w The rotation vector
+		 * @param input The vector that we are multiplying
+		 * @param output The result
+		 * @param inverse Whether we want V^-1 rather than V
+		 */
+		static inline void ApplyV(const double * w, const double * input, double * output, bool inverse)
+		{
+			auto theta2 = w[0] * w[0] + w[1] * w[1] + w[2] * w[2];
+			auto theta = sqrt(theta2);
+
+			double a, b;
+			if (!inverse)
+			{
+				if (theta < 1e-8) { a = 0.5 - theta2 / 24; b = 1.0 / 6 - theta2 / 120; }
+				else { a = (1 - cos(theta)) / theta2; b = (theta - sin(theta)) / (theta2 * theta); }
+			}
+			else
+			{
+				a = -0.5;
+				if (theta < 1e-8) b = 1.0 / 12 + theta2 / 720;
+				else b = (1 - (theta * sin(theta)) / (2 * (1 - cos(theta)))) / theta2;
+			}
+
+			// w x input and w x (w x input)
+			double c1[3] = { w[1] * input[2] - w[2] * input[1], w[2] * input[0] - w[0] * input[2], w[0] * input[1] - w[1] * input[0] };
+			double c2[3] = { w[1] * c1[2] - w[2] * c1[1], w[2] * c1[0] - w[0] * c1[2], w[0] * c1[1] - w[1] * c1[0] };
+
+			for (auto i = 0; i < 3; i++) output[i] = input[i] + a * c1[i] + b * c2[i];
+		}
+	};
+}
@@ -15,7 +15,7 @@ using namespace NVL_App;
 //--------------------------------------------------
 
 /**
- * @brief Save the frame to disk
+ * @brief Save the frame to disk (the depth keeps its native format, so 16-bit millimetre maps become 16-bit TIFFs)
  * @param folder The folder that we are writing to
  * @param depth The depth map that we are writing to disk
  * @param index The index of the depth we are saving
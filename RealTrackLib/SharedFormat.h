@@ -0,0 +1,149 @@
+//--------------------------------------------------
+// Describes the layout of the shared memory ring that a capture process uses to hand frames to the tracker
+//
+// The ring is a POSIX shared memory object holding a SharedHeader (padded to a cache line), followed by SlotCount
+// slots of SlotSize bytes. Each slot is a SharedSlot (one cache line) followed by the raw color pixels
+// (Width x Height x 3 bytes) and then the raw depth pixels.
+//
+// There is a single producer and a single consumer. The producer fills slot (Written % SlotCount) and then
+// increments Written, while the consumer increments Released once it has finished with the oldest slot that it
+// holds. The producer never writes to a slot while Written - Released == SlotCount, so the consumer can use the
+// slot memory in place. Both counters are futex words, so either side can sleep on the other one, and the producer
+// stores the magic number last (with release ordering, and the consumer loads it with acquire ordering before it 
+// reads anything else) so that a consumer never sees a half-built header
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <ctime>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <iostream>
+using namespace std;
+
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+namespace NVL_App
+{
+	struct SharedHeader
+	{
+		atomic<uint32_t> Magic;
+		uint32_t Version;
+		uint32_t Width;
+		uint32_t Height;
+		uint32_t ColorType;
+		uint32_t DepthType;
+		uint32_t SlotCount;
+		uint32_t FrameCount;
+		uint64_t SlotSize;
+		double FrameRate;
+		alignas(64) atomic<uint32_t> Written;
+		alignas(64) atomic<uint32_t> Released;
+		atomic<uint32_t> Dropped;
+		atomic<uint32_t> Closed;
+	};
+
+	struct alignas(64) SharedSlot
+	{
+		int64_t Index;
+		double Timestamp;
+		int64_t Published;
+	};
+
+	class SharedFormat
+	{
+	public:
+		static constexpr uint32_t MAGIC = 'R' | 'T' << 8 | 'S' << 16 | 'M' << 24;
+		static constexpr uint32_t VERSION = 1;
+		static constexpr size_t ALIGNMENT = 64;
+
+		static_assert(sizeof(atomic<uint32_t>) == sizeof(uint32_t) && atomic<uint32_t>::is_always_lock_free, "The ring counters must be plain futex words");
+
+		/**
+		 * @brief Determine whether the header is one that we know how to read. The magic number is loaded first (with 
+		 * acquire ordering), so the rest of the header is only read once the producer has finished writing it
+		 * @param header The header that we are validating
+		 * @return true If the header is valid
+		 */
+		static inline bool IsValid(const SharedHeader& header)
+		{
+			return header.Magic.load(memory_order_acquire) == MAGIC && header.Version == VERSION;
+		}
+
+		/**
+		 * @brief Determine the number of bytes occupied by a single slot (including its header)
+		 * @param size The resolution of the frames
+		 * @param depthType The OpenCV type of the depth maps
+		 * @return size_t The size of the slot in bytes
+		 */
+		static inline size_t GetSlotSize(const Size& size, int depthType)
+		{
+			auto pixels = (size_t)size.width * size.height;
+			return Align(sizeof(SharedSlot) + pixels * CV_ELEM_SIZE(CV_8UC3) + pixels * CV_ELEM_SIZE(depthType));
+		}
+
+		/**
+		 * @brief Determine the total size of the shared memory object
+		 * @param slotCount The number of slots within the ring
+		 * @param slotSize The size of each slot in bytes
+		 * @return size_t The size in bytes
+		 */
+		static inline size_t GetRingSize(uint32_t slotCount, size_t slotSize)
+		{
+			return Align(sizeof(SharedHeader)) + slotCount * slotSize;
+		}
+
+		/**
+		 * @brief Find the start of a slot within the mapped ring
+		 * @param memory The start of the mapping
+		 * @param slot The index of the slot
+		 * @return SharedSlot * The slot header (the pixels follow it)
+		 */
+		static inline SharedSlot * GetSlot(uchar * memory, uint32_t slot)
+		{
+			auto header = (SharedHeader *)memory;
+			return (SharedSlot *)(memory + Align(sizeof(SharedHeader)) + slot * header->SlotSize);
+		}
+
+		/**
+		 * @brief Sleep until a counter moves away from the value we last saw (or the timeout expires)
+		 * @param counter The counter that we are waiting on
+		 * @param seen The value that we last saw
+		 * @param timeout The longest that we will sleep for (in milliseconds)
+		 */
+		static inline void Wait(atomic<uint32_t>& counter, uint32_t seen, int timeout)
+		{
+			auto time = timespec(); time.tv_sec = timeout / 1000; time.tv_nsec = (timeout % 1000) * 1000000L;
+			syscall(SYS_futex, (uint32_t *)&counter, FUTEX_WAIT, seen, &time, nullptr, 0);
+		}
+
+		/**
+		 * @brief Wake anything sleeping on a counter (in either process)
+		 * @param counter The counter that has changed
+		 */
+		static inline void Wake(atomic<uint32_t>& counter)
+		{
+			syscall(SYS_futex, (uint32_t *)&counter, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+		}
+
+		/**
+		 * @brief Round a size up to a whole number of cache lines
+		 * @param bytes The size that we are rounding
+		 * @return size_t The rounded size
+		 */
+		static inline size_t Align(size_t bytes)
+		{
+			return (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+		}
+	};
+}
@@ -0,0 +1,176 @@
+//--------------------------------------------------
+// Implementation of class SharedSource
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "SharedSource.h"
+using namespace NVL_App;
+
+// The longest that we wait for the producer to create the ring (milliseconds)
+#define OPEN_TIMEOUT 5000
+
+// The longest that we sleep on the producer before checking the ring again (milliseconds)
+#define WAIT_TIMEOUT 100
+
+// The number of times that we poll for a frame before going to sleep
+#define SPIN_COUNT 2000
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor
+ * @param name The name of the shared memory object (e.g. "/realtrack")
+ * @param poolSize The number of frames that the caller may hold at once (the ring must have at least this many slots)
+ * @param depthType The depth type that the frames hold (rings holding another format are converted, at the cost of a copy)
+ */
+SharedSource::SharedSource(const string& name, int poolSize, int depthType) : _next(0), _pool(nullptr)
+{
+	Open(name);
+
+	if (_header->ColorType != CV_8UC3) throw runtime_error("Shared rings are expected to hold 8-bit BGR color images");
+	if ((int)_header->SlotCount < poolSize) throw runtime_error("The shared ring needs at least " + to_string(poolSize) + " slots");
+
+	_next = _header->Released.load(memory_order_acquire);
+	_direct = (int)_header->DepthType == depthType;
+	if (!_direct) _pool = new FramePool(GetSize(), poolSize, depthType);
+
+	// Wrap each slot once, so that handing out a frame is just a pointer
+	for (auto i = 0u; i < _header->SlotCount && _direct; i++)
+	{
+		auto pixels = (uchar *)(SharedFormat::GetSlot(_memory, i) + 1);
+		auto color = Mat(GetSize(), CV_8UC3, pixels);
+		auto depth = Mat(GetSize(), _header->DepthType, pixels + color.total() * color.elemSize());
+		auto frame = new NVLib::DepthFrame(color, depth);
+		_frames.push_back(frame); _slots[frame] = i;
+	}
+	_busy.resize(_header->SlotCount, false);
+}
+
+/**
+ * @brief Main Terminator
+ */
+SharedSource::~SharedSource()
+{
+	for (auto frame : _frames) delete frame;
+	delete _pool;
+	munmap(_memory, _bytes);
+}
+
+/**
+ * @brief Attach to the ring, waiting for the producer to create it if it is not there yet
+ * @param name The name of the shared memory object
+ */
+void SharedSource::Open(const string& name)
+{
+	auto deadline = chrono::steady_clock::now() + chrono::milliseconds(OPEN_TIMEOUT);
+
+	while (true)
+	{
+		auto handle = shm_open(name.c_str(), O_RDWR, 0);
+		if (handle >= 0)
+		{
+			struct stat details; auto valid = fstat(handle, &details) == 0 && details.st_size >= (off_t)sizeof(SharedHeader);
+			auto memory = valid ? mmap(nullptr, details.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, handle, 0) : MAP_FAILED;
+			close(handle);
+
+			if (memory != MAP_FAILED)
+			{
+				auto header = (SharedHeader *)memory;
+				if (SharedFormat::IsValid(*header) && details.st_size >= (off_t)SharedFormat::GetRingSize(header->SlotCount, header->SlotSize))
+				{
+					_memory = (uchar *)memory; _bytes = details.st_size; _header = header;
+					return;
+				}
+				munmap(memory, details.st_size);
+			}
+		}
+
+		if (chrono::steady_clock::now() > deadline) throw runtime_error("Unable to attach to shared memory: " + name);
+		this_thread::sleep_for(chrono::milliseconds(10));
+	}
+}
+
+//--------------------------------------------------
+// Frame Retrieval
+//--------------------------------------------------
+
+/**
+ * @brief Wait for the producer to publish the next frame, and hand it out
+ * @param output The frame that was retrieved
+ * @return true If a frame was retrieved
+ * @return false If the producer has closed the ring and there are no frames left
+ */
+bool SharedSource::Next(SourceFrame& output)
+{
+	// Poll for a short while (a handoff is usually a few microseconds away), and then sleep on the counter
+	for (auto attempt = 0; ; attempt++)
+	{
+		auto written = _header->Written.load(memory_order_acquire);
+		if (written != _next) break;
+		if (_header->Closed.load(memory_order_acquire) && _header->Written.load(memory_order_acquire) == _next) return false;
+		if (attempt < SPIN_COUNT) continue;
+		SharedFormat::Wait(_header->Written, written, WAIT_TIMEOUT);
+	}
+
+	auto slotIndex = _next % _header->SlotCount;
+	auto slot = SharedFormat::GetSlot(_memory, slotIndex);
+	NVLib::DepthFrame * frame = nullptr;
+
+	if (_direct)
+	{
+		lock_guard<mutex> guard(_lock);
+		frame = _frames[slotIndex]; _busy[slotIndex] = true; _next++;
+	}
+	else
+	{
+		auto pixels = (uchar *)(slot + 1); auto size = GetSize();
+		auto color = Mat(size, CV_8UC3, pixels);
+		auto depth = Mat(size, _header->DepthType, pixels + color.total() * color.elemSize());
+
+		frame = _pool->Acquire();
+		color.copyTo(frame->GetColor()); depth.convertTo(frame->GetDepth(), _pool->GetDepthType());
+
+		lock_guard<mutex> guard(_lock);
+		_next++; ReleaseSlot(slotIndex);
+	}
+
+	output = SourceFrame((int)slot->Index, slot->Timestamp, frame);
+	output.GetArrival() = chrono::steady_clock::time_point(chrono::duration_cast<chrono::steady_clock::duration>(chrono::nanoseconds(slot->Published)));
+
+	return true;
+}
+
+/**
+ * @brief Hand the frame back (slots are returned to the producer in order, once every earlier one is free)
+ * @param frame The frame that we are releasing
+ */
+void SharedSource::Release(NVLib::DepthFrame * frame)
+{
+	if (!_direct) { _pool->Release(frame); return; }
+
+	lock_guard<mutex> guard(_lock);
+	auto slot = _slots.find(frame);
+	if (slot == _slots.end()) throw runtime_error("The frame does not belong to the shared ring");
+	ReleaseSlot(slot->second);
+}
+
+/**
+ * @brief Mark a slot as free and move the release counter past every free slot at the front of the ring
+ * @param slot The index of the slot (the caller must hold the lock)
+ */
+void SharedSource::ReleaseSlot(uint32_t slot)
+{
+	_busy[slot] = false;
+
+	auto released = _header->Released.load(memory_order_relaxed); auto start = released;
+	while (released != _next && !_busy[released % _header->SlotCount]) released++;
+	if (released == start) return;
+
+	_header->Released.store(released, memory_order_release);
+	SharedFormat::Wake(_header->Released);
+}
@@ -0,0 +1,64 @@
+//--------------------------------------------------
+// A frame source that reads frames from a shared memory ring filled by a separate capture process (see
+// SharedFormat.h for the layout).
+//
+// When the ring holds depth in the format that we want, the frames that are handed out wrap the slot memory
+// directly, so that nothing is copied, and the slot is only given back to the producer once the frame is released
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <iostream>
+using namespace std;
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include "FramePool.h"
+#include "FrameSource.h"
+#include "SharedFormat.h"
+
+namespace NVL_App
+{
+	class SharedSource : public FrameSource
+	{
+	private:
+		uchar * _memory;
+		size_t _bytes;
+		SharedHeader * _header;
+		uint32_t _next;
+		bool _direct;
+		FramePool * _pool;
+		vector<NVLib::DepthFrame *> _frames;
+		vector<bool> _busy;
+		map<NVLib::DepthFrame *, uint32_t> _slots;
+		mutex _lock;
+	public:
+		SharedSource(const string& name, int poolSize, int depthType);
+		~SharedSource();
+
+		bool Next(SourceFrame& output) override;
+		void Release(NVLib::DepthFrame * frame) override;
+
+		inline Size GetSize() override { return Size(_header->Width, _header->Height); }
+		inline int GetFrameCount() override { return (int)_header->FrameCount; }
+		inline int GetDropped() override { return (int)_header->Dropped.load(); }
+		inline double GetFrameRate() { return _header->FrameRate; }
+	private:
+		void Open(const string& name);
+		void ReleaseSlot(uint32_t slot);
+	};
+}
@@ -0,0 +1,157 @@
+//--------------------------------------------------
+// Implementation of class SharedWriter
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "SharedWriter.h"
+using namespace NVL_App;
+
+// The longest that we sleep on the consumer before checking the ring again (milliseconds)
+#define WAIT_TIMEOUT 100
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor (any existing ring with the same name is replaced)
+ * @param name The name of the shared memory object (e.g. "/realtrack")
+ * @param size The resolution of the frames
+ * @param depthType The OpenCV type of the depth maps
+ * @param frameRate The rate at which the frames are captured
+ * @param slotCount The number of slots within the ring
+ * @param frameCount The number of frames that will be written (or 0 if this is not known up front)
+ * @param block Indicates that a full ring should block the writer, rather than dropping the frame
+ */
+SharedWriter::SharedWriter(const string& name, const Size& size, int depthType, double frameRate, int slotCount, int frameCount, bool block) : _name(name), _block(block), _reserved(false)
+{
+	if (slotCount < 1) throw runtime_error("The shared ring needs at least one slot");
+
+	auto slotSize = SharedFormat::GetSlotSize(size, depthType);
+	_bytes = SharedFormat::GetRingSize(slotCount, slotSize);
+
+	shm_unlink(name.c_str());
+	auto handle = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (handle < 0) throw runtime_error("Unable to create shared memory: " + name);
+	if (ftruncate(handle, (off_t)_bytes) != 0) { close(handle); shm_unlink(name.c_str()); throw runtime_error("Unable to size shared memory: " + name); }
+
+	auto memory = mmap(nullptr, _bytes, PROT_READ | PROT_WRITE, MAP_SHARED, handle, 0); close(handle);
+	if (memory == MAP_FAILED) { shm_unlink(name.c_str()); throw runtime_error("Unable to map shared memory: " + name); }
+	_memory = (uchar *)memory; _header = (SharedHeader *)memory;
+
+	_header->Version = SharedFormat::VERSION;
+	_header->Width = size.width; _header->Height = size.height;
+	_header->ColorType = CV_8UC3; _header->DepthType = depthType;
+	_header->SlotCount = slotCount; _header->FrameCount = frameCount;
+	_header->SlotSize = slotSize; _header->FrameRate = frameRate;
+
+	// The magic number goes in last, so that the consumer only ever sees a complete header
+	_header->Magic.store(SharedFormat::MAGIC, memory_order_release);
+}
+
+/**
+ * @brief Main Terminator
+ */
+SharedWriter::~SharedWriter()
+{
+	Close();
+	munmap(_memory, _bytes);
+}
+
+//--------------------------------------------------
+// Write
+//--------------------------------------------------
+
+/**
+ * @brief Reserve the next slot, so that the caller can fill it in place
+ * @param color A header over the color pixels of the slot
+ * @param depth A header over the depth pixels of the slot
+ * @return true If a slot was reserved
+ * @return false If the ring was full and the writer is dropping frames (or the ring has been closed)
+ */
+bool SharedWriter::Reserve(Mat& color, Mat& depth)
+{
+	if (_reserved) throw runtime_error("A shared slot has already been reserved");
+	if (_header->Closed.load()) return false;
+
+	auto written = _header->Written.load(memory_order_relaxed);
+	while (true)
+	{
+		auto released = _header->Released.load(memory_order_acquire);
+		if (written - released < _header->SlotCount) break;
+		if (!_block) { _header->Dropped.fetch_add(1); return false; }
+		SharedFormat::Wait(_header->Released, released, WAIT_TIMEOUT);
+	}
+
+	auto size = Size(_header->Width, _header->Height);
+	auto pixels = (uchar *)(SharedFormat::GetSlot(_memory, written % _header->SlotCount) + 1);
+	color = Mat(size, CV_8UC3, pixels);
+	depth = Mat(size, _header->DepthType, pixels + color.total() * color.elemSize());
+
+	_reserved = true; return true;
+}
+
+/**
+ * @brief Hand the reserved slot over to the consumer
+ * @param index The index of the frame within the sequence
+ * @param timestamp The time (in seconds) at which the frame was captured
+ */
+void SharedWriter::Publish(int index, double timestamp)
+{
+	if (!_reserved) throw runtime_error("There is no reserved shared slot to publish");
+
+	auto written = _header->Written.load(memory_order_relaxed);
+	auto slot = SharedFormat::GetSlot(_memory, written % _header->SlotCount);
+	slot->Index = index; slot->Timestamp = timestamp;
+	slot->Published = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+
+	_header->Written.store(written + 1, memory_order_release);
+	SharedFormat::Wake(_header->Written);
+	_reserved = false;
+}
+
+/**
+ * @brief Copy a frame into the next slot and publish it
+ * @param frame The frame that we are writing
+ * @param index The index of the frame within the sequence
+ * @param timestamp The time (in seconds) at which the frame was captured
+ * @return true If the frame was written
+ * @return false If the frame was dropped because the ring was full
+ */
+bool SharedWriter::Write(NVLib::DepthFrame * frame, int index, double timestamp)
+{
+	auto& color = frame->GetColor(); auto& depth = frame->GetDepth();
+
+	if (color.cols != (int)_header->Width || color.rows != (int)_header->Height || color.type() != (int)_header->ColorType) throw runtime_error("The color image does not match the shared ring layout");
+	if (depth.cols != (int)_header->Width || depth.rows != (int)_header->Height || depth.type() != (int)_header->DepthType) throw runtime_error("The depth map does not match the shared ring layout");
+
+	Mat slotColor, slotDepth; if (!Reserve(slotColor, slotDepth)) return false;
+	color.copyTo(slotColor); depth.copyTo(slotDepth);
+	Publish(index, timestamp);
+
+	return true;
+}
+
+/**
+ * @brief Tell the consumer that no more frames are coming and remove the name of the ring (a blocking writer first
+ * waits for the consumer to finish with the frames that are still in the ring)
+ */
+void SharedWriter::Close()
+{
+	if (_header->Closed.load()) return;
+
+	_header->Closed.store(1, memory_order_release);
+	SharedFormat::Wake(_header->Written);
+
+	while (_block)
+	{
+		auto released = _header->Released.load(memory_order_acquire);
+		if (released == _header->Written.load(memory_order_relaxed)) break;
+		SharedFormat::Wait(_header->Released, released, WAIT_TIMEOUT);
+	}
+
+	shm_unlink(_name.c_str());
+}
@@ -0,0 +1,52 @@
+//--------------------------------------------------
+// The producer side of a shared memory frame ring (see SharedFormat.h for the layout)
+//
+// A capture process can either write frames that it already holds (Write), or reserve the next slot and fill it
+// in place (Reserve followed by Publish), which avoids any copy on the producer side as well
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <chrono>
+#include <iostream>
+using namespace std;
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include <NVLib/Model/DepthFrame.h>
+
+#include "SharedFormat.h"
+
+namespace NVL_App
+{
+	class SharedWriter
+	{
+	private:
+		string _name;
+		bool _block;
+		uchar * _memory;
+		size_t _bytes;
+		SharedHeader * _header;
+		bool _reserved;
+	public:
+		SharedWriter(const string& name, const Size& size, int depthType, double frameRate, int slotCount, int frameCount, bool block);
+		~SharedWriter();
+
+		bool Reserve(Mat& color, Mat& depth);
+		void Publish(int index, double timestamp);
+		bool Write(NVLib::DepthFrame * frame, int index, double timestamp);
+		void Close();
+
+		inline int GetFrameCount() { return (int)_header->Written.load(); }
+		inline int GetDropped() { return (int)_header->Dropped.load(); }
+	};
+}
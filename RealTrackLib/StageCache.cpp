@@ -0,0 +1,208 @@
+//--------------------------------------------------
+// Implementation of class StageCache
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "StageCache.h"
+using namespace NVL_App;
+
+// The FNV-1a prime
+#define HASH_PRIME 1099511628211ULL
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor
+ * @param folder The root folder of the cache
+ * @param sequence A description of the sequence (e.g. its source, path and calibration), which selects the sub-folder that the
+ * records are kept in, so that several sequences can share the same cache
+ */
+StageCache::StageCache(const string& folder, const string& sequence) : _frame(-1), _reference(-1), _dirty(false), _hits(0), _misses(0)
+{
+	_sequenceKey = Hash(sequence.data(), sequence.size());
+
+	auto name = stringstream(); name << hex << setw(16) << setfill('0') << _sequenceKey;
+	_folder = NVLib::FileUtils::PathCombine(folder, name.str());
+	filesystem::create_directories(_folder);
+}
+
+/**
+ * @brief Main Terminator
+ */
+StageCache::~StageCache()
+{
+	End();
+}
+
+//--------------------------------------------------
+// Frame Handling
+//--------------------------------------------------
+
+/**
+ * @brief Start working with the record of a frame
+ * @param frame The index of the frame
+ * @param reference The index of the frame that it is being tracked against
+ */
+void StageCache::Begin(int frame, int reference)
+{
+	End();
+	_frame = frame; _reference = reference;
+	Load();
+}
+
+/**
+ * @brief Finish with the current frame, writing its record if any stage was updated
+ */
+void StageCache::End()
+{
+	if (_frame < 0 || !_dirty) { _frame = -1; return; }
+
+	auto path = GetPath(_frame);
+	auto writer = ofstream(path, ios::binary | ios::trunc);
+	if (!writer.is_open()) throw runtime_error("Unable to open file: " + path);
+
+	_header.KeypointCount = (uint32_t)_keypoints.size(); _header.MatchCount = (uint32_t)_matches.size();
+	writer.write((char *)&_header, sizeof(StageRecordHeader));
+	writer.write((char *)_keypoints.data(), _keypoints.size() * sizeof(KeyPoint));
+	writer.write((char *)_matches.data(), _matches.size() * sizeof(FeatureMatch));
+
+	_frame = -1; _dirty = false;
+}
+
+/**
+ * @brief Load the record of the current frame (an empty record is used if there is none, or it is out of date)
+ */
+void StageCache::Load()
+{
+	_header = StageRecordHeader();
+	_header.Magic[0] = 'R'; _header.Magic[1] = 'T'; _header.Magic[2] = 'S'; _header.Magic[3] = 'C';
+	_header.Version = VERSION;
+	_keypoints.clear(); _matches.clear();
+
+	auto reader = ifstream(GetPath(_frame), ios::binary);
+	if (!reader.is_open()) return;
+
+	auto header = StageRecordHeader(); reader.read((char *)&header, sizeof(StageRecordHeader));
+	if (!reader || header.Magic[0] != 'R' || header.Magic[1] != 'T' || header.Magic[2] != 'S' || header.Magic[3] != 'C' || header.Version != VERSION) return;
+
+	_keypoints.resize(header.KeypointCount); _matches.resize(header.MatchCount, FeatureMatch(0, 0, 0));
+	reader.read((char *)_keypoints.data(), _keypoints.size() * sizeof(KeyPoint));
+	reader.read((char *)_matches.data(), _matches.size() * sizeof(FeatureMatch));
+	if (!reader) { _keypoints.clear(); _matches.clear(); return; }
+
+	_header = header;
+}
+
+//--------------------------------------------------
+// Stages
+//--------------------------------------------------
+
+/**
+ * @brief Retrieve the cached keypoints and matches of the current frame
+ * @param key The hash of the parameters that affect detection and matching
+ * @param keypoints The keypoints of the frame
+ * @param matches The matches against the reference frame
+ * @return true If the cached stage was valid (the outputs are only written if it was)
+ */
+bool StageCache::GetMatches(uint64_t key, vector<KeyPoint>& keypoints, vector<FeatureMatch>& matches)
+{
+	if (_frame < 0 || _header.MatchKey != GetMatchKey(key)) { _misses++; return false; }
+
+	keypoints.assign(_keypoints.begin(), _keypoints.end());
+	matches.assign(_matches.begin(), _matches.end());
+	_hits++; return true;
+}
+
+/**
+ * @brief Store the keypoints and matches of the current frame (which invalidates the pose stage)
+ * @param key The hash of the parameters that affect detection and matching
+ * @param keypoints The keypoints of the frame
+ * @param matches The matches against the reference frame
+ */
+void StageCache::SetMatches(uint64_t key, vector<KeyPoint>& keypoints, vector<FeatureMatch>& matches)
+{
+	if (_frame < 0) return;
+
+	_header.MatchKey = GetMatchKey(key); _header.PoseKey = 0;
+	_keypoints.assign(keypoints.begin(), keypoints.end());
+	_matches.assign(matches.begin(), matches.end());
+	_dirty = true;
+}
+
+/**
+ * @brief Retrieve the cached PnP pose of the current frame
+ * @param key The hash of the correspondences and the parameters that were given to the estimator
+ * @param pose The estimated pose
+ * @param error The reprojection error of the estimate
+ * @return true If the cached stage was valid
+ */
+bool StageCache::GetPose(uint64_t key, SE3& pose, Vec2d& error)
+{
+	if (_frame < 0 || key == 0 || _header.PoseKey != key) { _misses++; return false; }
+
+	pose = SE3(_header.Rotation, _header.Translation);
+	error = Vec2d(_header.Error[0], _header.Error[1]);
+	_hits++; return true;
+}
+
+/**
+ * @brief Store the PnP pose of the current frame
+ * @param key The hash of the correspondences and the parameters that were given to the estimator
+ * @param pose The estimated pose
+ * @param error The reprojection error of the estimate
+ */
+void StageCache::SetPose(uint64_t key, const SE3& pose, const Vec2d& error)
+{
+	if (_frame < 0) return;
+
+	_header.PoseKey = key;
+	for (auto i = 0; i < 9; i++) _header.Rotation[i] = pose.GetRotation()[i];
+	for (auto i = 0; i < 3; i++) _header.Translation[i] = pose.GetTranslation()[i];
+	_header.Error[0] = error[0]; _header.Error[1] = error[1];
+	_dirty = true;
+}
+
+//--------------------------------------------------
+// Helpers
+//--------------------------------------------------
+
+/**
+ * @brief Hash a block of memory (64-bit FNV-1a), chaining from a previous hash if a seed is given
+ * @param data The data that we are hashing
+ * @param bytes The number of bytes
+ * @param seed The starting value
+ * @return uint64_t The resultant hash
+ */
+uint64_t StageCache::Hash(const void * data, size_t bytes, uint64_t seed)
+{
+	auto result = seed; auto input = (const uchar *)data;
+	for (size_t i = 0; i < bytes; i++) { result ^= input[i]; result *= HASH_PRIME; }
+	return result;
+}
+
+/**
+ * @brief Combine the parameter key of the matching stage with the identity of the sequence and the reference frame
+ * @param key The hash of the parameters
+ * @return uint64_t The full key
+ */
+uint64_t StageCache::GetMatchKey(uint64_t key)
+{
+	auto result = Hash(&_sequenceKey, sizeof(uint64_t), key);
+	return Hash(&_reference, sizeof(int), result);
+}
+
+/**
+ * @brief Build the path to the record of a frame
+ * @param frame The index of the frame
+ * @return string The path to the record
+ */
+string StageCache::GetPath(int frame)
+{
+	auto name = stringstream(); name << "stage_" << setw(6) << setfill('0') << frame << ".bin";
+	return NVLib::FileUtils::PathCombine(_folder, name.str());
+}
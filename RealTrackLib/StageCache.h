@@ -0,0 +1,83 @@
+//--------------------------------------------------
+// An on-disk cache of the per-frame tracking results (keypoints, matches and the PnP pose), so that re-runs that
+// only change downstream parameters can skip the detection, matching and RANSAC work.
+//
+// Each frame has a record file within a folder that is specific to the sequence. A stage is only reused when its
+// key (a hash of the parameters and inputs that affect it) matches the one that was stored with it
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <filesystem>
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include <NVLib/FileUtils.h>
+
+#include "SE3.h"
+#include "FeatureMatch.h"
+
+namespace NVL_App
+{
+	struct StageRecordHeader
+	{
+		char Magic[4];
+		uint32_t Version;
+		uint64_t MatchKey;
+		uint64_t PoseKey;
+		uint32_t KeypointCount;
+		uint32_t MatchCount;
+		double Rotation[9];
+		double Translation[3];
+		double Error[2];
+	};
+
+	class StageCache
+	{
+	private:
+		string _folder;
+		uint64_t _sequenceKey;
+		int _frame;
+		int _reference;
+		bool _dirty;
+
+		StageRecordHeader _header;
+		vector<KeyPoint> _keypoints;
+		vector<FeatureMatch> _matches;
+
+		int _hits;
+		int _misses;
+	public:
+		static constexpr uint32_t VERSION = 1;
+
+		StageCache(const string& folder, const string& sequence);
+		~StageCache();
+
+		void Begin(int frame, int reference);
+		void End();
+
+		bool GetMatches(uint64_t key, vector<KeyPoint>& keypoints, vector<FeatureMatch>& matches);
+		void SetMatches(uint64_t key, vector<KeyPoint>& keypoints, vector<FeatureMatch>& matches);
+		bool GetPose(uint64_t key, SE3& pose, Vec2d& error);
+		void SetPose(uint64_t key, const SE3& pose, const Vec2d& error);
+
+		inline int GetHits() { return _hits; }
+		inline int GetMisses() { return _misses; }
+
+		static uint64_t Hash(const void * data, size_t bytes, uint64_t seed = 14695981039346656037ULL);
+	private:
+		string GetPath(int frame);
+		void Load();
+		uint64_t GetMatchKey(uint64_t key);
+	};
+}
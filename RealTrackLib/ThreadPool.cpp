@@ -0,0 +1,160 @@
+//--------------------------------------------------
+// Implementation of class ThreadPool
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "ThreadPool.h"
+using namespace NVL_App;
+
+//--------------------------------------------------
+// WorkQueue
+//--------------------------------------------------
+
+/**
+ * @brief Add a task to the back of the queue
+ * @param task The task that we are adding
+ */
+void WorkQueue::Push(function<void()>& task)
+{
+	lock_guard<mutex> guard(_lock);
+	_tasks.push_back(move(task));
+}
+
+/**
+ * @brief Take the most recently added task (used by the owning worker)
+ * @param task The task that was taken
+ * @return true If a task was available
+ */
+bool WorkQueue::PopBack(function<void()>& task)
+{
+	lock_guard<mutex> guard(_lock);
+	if (_tasks.empty()) return false;
+	task = move(_tasks.back()); _tasks.pop_back();
+	return true;
+}
+
+/**
+ * @brief Take the oldest task (used by workers that are stealing)
+ * @param task The task that was taken
+ * @return true If a task was available
+ */
+bool WorkQueue::PopFront(function<void()>& task)
+{
+	lock_guard<mutex> guard(_lock);
+	if (_tasks.empty()) return false;
+	task = move(_tasks.front()); _tasks.pop_front();
+	return true;
+}
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor
+ * @param threadCount The number of workers (0 to use one per hardware thread)
+ */
+ThreadPool::ThreadPool(int threadCount) : _queued(0), _next(0), _pending(0), _stop(false)
+{
+	if (threadCount <= 0) threadCount = max((int)thread::hardware_concurrency(), 1);
+
+	for (auto i = 0; i < threadCount; i++) _queues.push_back(new WorkQueue());
+	for (auto i = 0; i < threadCount; i++) _workers.push_back(thread(&ThreadPool::Work, this, i, PerfCounters::GetSession()));
+}
+
+/**
+ * @brief Main Terminator (finishes the outstanding work first)
+ */
+ThreadPool::~ThreadPool()
+{
+	Wait();
+
+	{ lock_guard<mutex> guard(_lock); _stop = true; }
+	_wake.notify_all();
+
+	for (auto& worker : _workers) worker.join();
+	for (auto queue : _queues) delete queue;
+}
+
+//--------------------------------------------------
+// Submission
+//--------------------------------------------------
+
+/**
+ * @brief Submit a task (tasks submitted from a worker go onto that worker's own queue)
+ * @param task The task that we are submitting
+ */
+void ThreadPool::Submit(function<void()> task)
+{
+	auto id = _workerPool == this ? _workerId : (_next++ % (int)_queues.size());
+
+	{ lock_guard<mutex> guard(_lock); _pending++; }
+	_queues[id]->Push(task);
+
+	{ lock_guard<mutex> guard(_lock); _queued++; }
+	_wake.notify_one();
+}
+
+/**
+ * @brief Block until every submitted task has finished
+ */
+void ThreadPool::Wait()
+{
+	unique_lock<mutex> lock(_lock);
+	_idle.wait(lock, [this] { return _pending == 0; });
+}
+
+//--------------------------------------------------
+// Workers
+//--------------------------------------------------
+
+/**
+ * @brief The main loop of a worker
+ * @param id The identifier of the worker
+ * @param session The perf session of the thread that started the worker (see PerfCounters)
+ */
+void ThreadPool::Work(int id, PerfSession * session)
+{
+	_workerId = id; _workerPool = this; PerfCounters::SetSession(session); PerfCounters::SetThreadName("pool");
+
+	while (true)
+	{
+		auto task = function<void()>();
+
+		if (Take(id, task))
+		{
+			try { auto perf = PerfScope("task"); task(); }
+			catch (...) { cerr << "ThreadPool: a task threw an exception that it did not handle" << endl; }
+
+			lock_guard<mutex> guard(_lock);
+			if (--_pending == 0) _idle.notify_all();
+			continue;
+		}
+
+		unique_lock<mutex> lock(_lock);
+		_wake.wait(lock, [this] { return _stop || _queued > 0; });
+		if (_stop && _queued == 0) return;
+	}
+}
+
+/**
+ * @brief Take a task from our own queue, or steal one from another worker
+ * @param id The identifier of the worker
+ * @param task The task that was taken
+ * @return true If a task was found
+ */
+bool ThreadPool::Take(int id, function<void()>& task)
+{
+	auto found = _queues[id]->PopBack(task);
+
+	for (auto i = 1; !found && i < (int)_queues.size(); i++) 
+	{
+		found = _queues[(id + i) % _queues.size()]->PopFront(task);
+	}
+
+	if (found) _queued--;
+	return found;
+}
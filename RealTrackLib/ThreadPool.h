@@ -0,0 +1,61 @@
+//--------------------------------------------------
+// A work-stealing thread pool (each worker owns a queue and steals from the others when idle)
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#include <iostream>
+using namespace std;
+
+#include "PerfCounters.h"
+
+namespace NVL_App
+{
+	class WorkQueue
+	{
+	private:
+		mutex _lock;
+		deque< function<void()> > _tasks;
+	public:
+		void Push(function<void()>& task);
+		bool PopBack(function<void()>& task);
+		bool PopFront(function<void()>& task);
+	};
+
+	class ThreadPool
+	{
+	private:
+		vector<thread> _workers;
+		vector<WorkQueue *> _queues;
+		atomic<int> _queued;
+		atomic<int> _next;
+		int _pending;
+		bool _stop;
+		mutex _lock;
+		condition_variable _wake;
+		condition_variable _idle;
+		inline static thread_local int _workerId = -1;
+		inline static thread_local ThreadPool * _workerPool = nullptr;
+	public:
+		ThreadPool(int threadCount);
+		~ThreadPool();
+
+		void Submit(function<void()> task);
+		void Wait();
+
+		inline int GetThreadCount() { return (int)_workers.size(); }
+	private:
+		void Work(int id, PerfSession * session);
+		bool Take(int id, function<void()>& task);
+	};
+}
@@ -18,7 +18,7 @@ using namespace NVL_App;
  */
 Trajectory::Trajectory()
 {
-	_currentPose = Mat_<double>::eye(4,4);
+	// The current pose starts out as the identity (the SE3 default)
 }
 
 //--------------------------------------------------
@@ -26,15 +26,43 @@ Trajectory::Trajectory()
 //--------------------------------------------------
 
 /**
- * @brief Add a pose to the system
+ * @brief Add a pose to the system. The raw odometry is kept alongside the corrected pose, so that corrections
+ * arriving later can be applied without compounding
  * @param pose Add a new pose to the collection
  */
-void Trajectory::AddPose(Mat& pose)
+void Trajectory::AddPose(const SE3& pose)
 {
-	Mat invPose = pose.inv();
-	_currentPose = _currentPose * invPose;
-	auto tvec = NVLib::PoseUtils::GetPoseTranslation(_currentPose);
-	_trajectory.push_back(Point3d(tvec[0], tvec[1], tvec[2]));
+	_odometryPose = _odometryPose * pose.Inverse();
+	_currentPose = _correction * _odometryPose;
+
+	_odometry.push_back(_odometryPose); _poses.push_back(_currentPose);
+	_trajectory.push_back(Point3d(_currentPose.T(0), _currentPose.T(1), _currentPose.T(2)));
+}
+
+//--------------------------------------------------
+// Correct
+//--------------------------------------------------
+
+/**
+ * @brief Apply optimized poses for earlier entries in a single sweep. Each entry between two optimized ids takes
+ * the correction of the optimized id before it, and the last correction is carried forward to every later entry
+ * @param poses The optimized camera to world poses, by entry id
+ */
+void Trajectory::Correct(map<int, SE3>& poses)
+{
+	for (auto entry = poses.begin(); entry != poses.end(); entry++) 
+	{
+		auto id = entry->first; if (id < 0 || id >= (int)_poses.size()) continue;
+		auto next = std::next(entry); auto end = next == poses.end() ? (int)_poses.size() : min(next->first, (int)_poses.size());
+
+		_correction = entry->second * _odometry[id].Inverse();
+		for (auto i = id; i < end; i++) 
+		{
+			_poses[i] = _correction * _odometry[i];
+			_trajectory[i] = Point3d(_poses[i].T(0), _poses[i].T(1), _poses[i].T(2));
+		}
+	}
+	if (!_poses.empty()) _currentPose = _poses.back();
 }
 
 //--------------------------------------------------
@@ -8,29 +8,37 @@
 
 #pragma once
 
+#include <map>
 #include <fstream>
 #include <iostream>
 using namespace std;
 
-#include <NVLib/PoseUtils.h>
-
 #include <opencv2/opencv.hpp>
 using namespace cv;
 
+#include "SE3.h"
+
 namespace NVL_App
 {
 	class Trajectory
 	{
 		private:
-			Mat _currentPose;
+			SE3 _currentPose;
+			SE3 _odometryPose;
+			SE3 _correction;
+			vector<SE3> _odometry;
+			vector<SE3> _poses;
 			vector<Point3d> _trajectory;
 		public:
 			Trajectory();
 
-			void AddPose(Mat& pose);
+			void AddPose(const SE3& pose);
+			void Correct(map<int, SE3>& poses);
 			void Save(const string& path);
 
-			inline Mat& GetCurrentPose() { return _currentPose; }
+			inline SE3& GetCurrentPose() { return _currentPose; }
+			inline SE3& GetOdometryPose() { return _odometryPose; }
+			inline int GetPoseCount() { return (int)_poses.size(); }
 			inline vector<Point3d>& GetTrajectory() { return _trajectory; }
 	};
 }
@@ -0,0 +1,65 @@
+//--------------------------------------------------
+// Startup code module: Packs a folder of frames into a single packed sequence file
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include <iostream>
+using namespace std;
+
+#include <NVLib/Logger.h>
+#include <NVLib/Formatter.h>
+#include <NVLib/StringUtils.h>
+
+#include <RealTrackLib/FolderSource.h>
+#include <RealTrackLib/PackedWriter.h>
+
+//--------------------------------------------------
+// Execution entry point
+//--------------------------------------------------
+
+/**
+ * Main Method
+ * @param argc The count of the incomming arguments
+ * @param argv The number of incomming arguments
+ */
+int main(int argc, char ** argv) 
+{
+    auto logger = NVLib::Logger(2);
+    logger.StartApplication();
+
+    try
+    {
+        if (argc != 5 && argc != 6) throw runtime_error(NVLib::Formatter() << "Usage: RealTrackPack <input_folder> <image_count> <frame_rate> <output_file> [float|mm16]");
+
+        auto imageCount = NVLib::StringUtils::String2Int(argv[2]);
+        auto frameRate = NVLib::StringUtils::String2Double(argv[3]);
+        auto depthType = NVL_App::LoadUtils::GetDepthType(argc == 6 ? argv[5] : "float");
+
+        auto source = NVL_App::FolderSource(argv[1], imageCount, frameRate, 1, depthType);
+        auto frame = NVL_App::SourceFrame(); source.Next(frame);
+        auto writer = NVL_App::PackedWriter(argv[4], source.GetSize(), frame.GetFrame()->GetDepth().type(), frameRate);
+
+        do
+        {
+            logger.Log(1, "Packing frame: %i", frame.GetIndex());
+            writer.Write(frame.GetFrame(), frame.GetTimestamp());
+            source.Release(frame.GetFrame());
+        } 
+        while (source.Next(frame));
+
+        writer.Close();
+        logger.Log(1, "Packed %i frames", writer.GetFrameCount());
+    }
+    catch (runtime_error exception)
+    {
+        logger.Log(1, "Error: %s", exception.what());
+        exit(EXIT_FAILURE);
+    }
+
+    logger.StopApplication();
+
+    return EXIT_SUCCESS;
+}
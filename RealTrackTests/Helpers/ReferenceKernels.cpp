@@ -0,0 +1,141 @@
+//--------------------------------------------------
+// Implementation of class ReferenceKernels
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "ReferenceKernels.h"
+using namespace NVL_App;
+
+//--------------------------------------------------
+// Scoring
+//--------------------------------------------------
+
+/**
+ * @brief The joint photometric and geometric score of a reference frame against a match frame (see 
+ * PoseImage::GetLumaScore), with the projection and the bilinear sampling done in double precision
+ * @param camera The camera matrix
+ * @param luma The 8-bit luma image of the reference frame
+ * @param depth The depth map of the reference frame
+ * @param pose The pose of the match frame relative to the reference
+ * @param matchLuma The 8-bit luma image of the match frame
+ * @param matchDepth The depth map of the match frame (empty for a purely photometric score)
+ * @param depthWeight The weight of the depth residual relative to the photometric residual
+ * @param stride The sampling stride over the reference pixels
+ * @return double The average score
+ */
+double ReferenceKernels::GetLumaScore(Mat& camera, Mat& luma, Mat& depth, const SE3& pose, Mat& matchLuma, Mat& matchDepth, double depthWeight, int stride)
+{
+	auto K = (double *)camera.data;
+	auto fx = K[0]; auto fy = K[4]; auto cx = K[2]; auto cy = K[5];
+	auto useDepth = depthWeight > 0 && !matchDepth.empty();
+
+	auto total = 0.0; auto count = 0;
+	for (auto row = 0; row < depth.rows; row += stride)
+	{
+		for (auto column = 0; column < depth.cols; column += stride)
+		{
+			auto index = column + row * depth.cols;
+			auto z = GetDepth(depth, index); if (z <= 0) continue;
+
+			double X, Y, Z; pose.Transform((column - cx) / fx * z, (row - cy) / fy * z, z, X, Y, Z);
+			if (Z <= 0) continue;
+
+			auto u = fx * X / Z + cx; auto v = fy * Y / Z + cy;
+			if (u < 0 || u >= matchLuma.cols - 1 || v < 0 || v >= matchLuma.rows - 1) continue;
+
+			auto u0 = (int)u; auto v0 = (int)v; auto a = u - u0; auto b = v - v0;
+			auto sample = [&](int x, int y) { return (double)matchLuma.at<uchar>(y, x); };
+			auto value = (1 - a) * (1 - b) * sample(u0, v0) + a * (1 - b) * sample(u0 + 1, v0) + (1 - a) * b * sample(u0, v0 + 1) + a * b * sample(u0 + 1, v0 + 1);
+			total += abs(value - luma.at<uchar>(row, column)); count++;
+
+			if (!useDepth) continue;
+			auto D = GetDepth(matchDepth, (int)(u + 0.5) + (int)(v + 0.5) * matchDepth.cols);
+			if (D > 0) total += depthWeight * min(abs(1.0 / D - 1.0 / Z) * 1e6, 50.0);
+		}
+	}
+
+	return count == 0 ? 0 : total / count;
+}
+
+//--------------------------------------------------
+// Merging
+//--------------------------------------------------
+
+/**
+ * @brief Merge a new depth map into a running average (see MapMerger::Merge), one case at a time
+ * @param map1 The running average
+ * @param map2 The new depth map
+ * @param counters The number of samples behind each pixel of the average (updated)
+ * @param output The merged map
+ */
+void ReferenceKernels::Merge(Mat& map1, Mat& map2, Mat& counters, Mat& output)
+{
+	output = Mat(map1.size(), map1.type());
+
+	for (auto index = 0; index < (int)map1.total(); index++)
+	{
+		auto Z1 = GetDepth(map1, index); auto Z2 = GetDepth(map2, index);
+		auto valid1 = Z1 > 300; auto valid2 = Z2 > 300;
+		auto count = (int)counters.data[index];
+
+		auto Z = 0.0;
+		if (valid1 && valid2) { Z = (Z1 * count + Z2) / (count + 1); count++; }
+		else if (valid1) { Z = Z1; count = 1; }
+		else if (valid2) { Z = Z2; count = 1; }
+
+		if (map1.depth() == CV_16U) ((ushort *)output.data)[index] = saturate_cast<ushort>(Z);
+		else ((float *)output.data)[index] = (float)Z;
+		if (valid1 || valid2) counters.data[index] = (uchar)min(count, 20);
+	}
+}
+
+//--------------------------------------------------
+// Detection
+//--------------------------------------------------
+
+/**
+ * @brief Detect FAST keypoints, keeping the strongest within each block (the first one found wins a tie) and then 
+ * the strongest overall (see FastDetector::Extract)
+ * @param image The image that we are detecting within
+ * @param blockSize The size of the blocks
+ * @param keypointTarget The number of keypoints to keep (0 keeps them all)
+ * @param keypoints The keypoints, in block order (or by decreasing response if the target cut some)
+ */
+void ReferenceKernels::Extract(Mat& image, int blockSize, int keypointTarget, vector<KeyPoint>& keypoints)
+{
+	auto detected = vector<KeyPoint>(); FastFeatureDetector::create()->detect(image, detected);
+
+	auto blocks = map<int, KeyPoint>();
+	for (auto& keypoint : detected)
+	{
+		auto key = (int)floor(keypoint.pt.x / blockSize) + (int)floor(keypoint.pt.y / blockSize) * (image.cols / blockSize + 1);
+		auto block = blocks.find(key);
+		if (block == blocks.end() || block->second.response < keypoint.response) blocks[key] = keypoint;
+	}
+
+	keypoints.clear();
+	for (auto& block : blocks) keypoints.push_back(block.second);
+	if (keypointTarget <= 0 || (int)keypoints.size() <= keypointTarget) return;
+
+	stable_sort(keypoints.begin(), keypoints.end(), [](const KeyPoint& a, const KeyPoint& b) { return a.response > b.response; });
+	keypoints.resize(keypointTarget);
+}
+
+//--------------------------------------------------
+// Helpers
+//--------------------------------------------------
+
+/**
+ * @brief Read a depth value (from either a float or a 16-bit millimetre map)
+ * @param depth The depth map
+ * @param index The index of the pixel
+ * @return double The depth
+ */
+double ReferenceKernels::GetDepth(Mat& depth, int index)
+{
+	if (depth.depth() == CV_16U) return ((ushort *)depth.data)[index];
+	return ((float *)depth.data)[index];
+}
@@ -0,0 +1,34 @@
+//--------------------------------------------------
+// Straightforward (double precision, single threaded, no sub-sampling tricks) versions of the kernels that have 
+// optimized implementations within RealTrackLib. They are written for clarity rather than speed, and are what the 
+// optimized variants are checked against within the differential tests
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <map>
+#include <algorithm>
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include <RealTrackLib/SE3.h>
+
+namespace NVL_App
+{
+	class ReferenceKernels
+	{
+	public:
+		static double GetLumaScore(Mat& camera, Mat& luma, Mat& depth, const SE3& pose, Mat& matchLuma, Mat& matchDepth, double depthWeight, int stride);
+		static void Merge(Mat& map1, Mat& map2, Mat& counters, Mat& output);
+		static void Extract(Mat& image, int blockSize, int keypointTarget, vector<KeyPoint>& keypoints);
+	private:
+		static double GetDepth(Mat& depth, int index);
+	};
+}
@@ -0,0 +1,121 @@
+//--------------------------------------------------
+// Implementation of class SyntheticScene
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include "SyntheticScene.h"
+using namespace NVL_App;
+
+// The number of sinusoids that make up the texture
+#define WAVE_COUNT 6
+
+//--------------------------------------------------
+// Constructors and Terminators
+//--------------------------------------------------
+
+/**
+ * @brief Main Constructor: builds a random plane and texture
+ * @param seed The seed of the scene (and of the poses that it hands out)
+ * @param size The resolution of the rendered frames
+ */
+SyntheticScene::SyntheticScene(int seed, const Size& size) : _size(size), _random(seed)
+{
+	auto focal = 0.82 * size.width;
+	_camera = Mat_<double>(Size(3, 3)); auto camera = (double *)_camera.data;
+	double values[9] = { focal, 0, (size.width - 1) * 0.5, 0, focal, (size.height - 1) * 0.5, 0, 0, 1 };
+	for (auto i = 0; i < 9; i++) camera[i] = values[i];
+
+	_distance = GetUniform(900, 1300); _slopeX = GetUniform(-0.3, 0.3); _slopeY = GetUniform(-0.3, 0.3);
+
+	// Wavelengths of 15 to 60 mm, which are several pixels across at these distances
+	for (auto i = 0; i < WAVE_COUNT; i++)
+	{
+		auto angle = GetUniform(0, 2 * M_PI); auto frequency = 2 * M_PI / GetUniform(15, 60);
+		_waves.push_back(Vec4d(frequency * cos(angle), frequency * sin(angle), GetUniform(0, 2 * M_PI), GetUniform(10, 25)));
+	}
+}
+
+//--------------------------------------------------
+// Render
+//--------------------------------------------------
+
+/**
+ * @brief Ray cast a frame of the scene
+ * @param pose The pose of the camera (mapping the first camera into this one)
+ * @param color The rendered color image (BGR)
+ * @param depth The rendered depth map (in millimetres)
+ * @param depthType The depth format (CV_32FC1 or CV_16UC1)
+ */
+void SyntheticScene::Render(const SE3& pose, Mat& color, Mat& depth, int depthType)
+{
+	color.create(_size, CV_8UC3); depth.create(_size, depthType);
+
+	auto camera = (double *)_camera.data;
+	auto fx = camera[0]; auto fy = camera[4]; auto cx = camera[2]; auto cy = camera[5];
+	auto inverse = pose.Inverse(); auto R = inverse.GetRotation();
+	double ox, oy, oz; inverse.Transform(0, 0, 0, ox, oy, oz);
+
+	for (auto row = 0; row < _size.height; row++)
+	{
+		for (auto column = 0; column < _size.width; column++)
+		{
+			// The ray through the pixel (with a unit z within the camera, so that the distance along it is the depth)
+			auto rx = (column - cx) / fx; auto ry = (row - cy) / fy;
+			auto dx = R[0] * rx + R[1] * ry + R[2]; auto dy = R[3] * rx + R[4] * ry + R[5]; auto dz = R[6] * rx + R[7] * ry + R[8];
+
+			// Intersect with the plane Z = distance + slopeX * X + slopeY * Y
+			auto Z = (_distance + _slopeX * ox + _slopeY * oy - oz) / (dz - _slopeX * dx - _slopeY * dy);
+			auto value = GetTexture(ox + Z * dx, oy + Z * dy);
+
+			auto index = column + row * _size.width; auto pixel = color.data + index * 3;
+			pixel[0] = saturate_cast<uchar>(value); pixel[1] = saturate_cast<uchar>(0.9 * value + 10); pixel[2] = saturate_cast<uchar>(0.8 * value + 20);
+			if (depthType == CV_16UC1) ((ushort *)depth.data)[index] = saturate_cast<ushort>(Z);
+			else ((float *)depth.data)[index] = (float)Z;
+		}
+	}
+}
+
+/**
+ * @brief The intensity of the texture at a point of the plane
+ * @param X The X coordinate (within the first camera)
+ * @param Y The Y coordinate (within the first camera)
+ * @return double The intensity
+ */
+double SyntheticScene::GetTexture(double X, double Y)
+{
+	auto result = 128.0;
+	for (auto& wave : _waves) result += wave[3] * sin(wave[0] * X + wave[1] * Y + wave[2]);
+	return result;
+}
+
+//--------------------------------------------------
+// Random Values
+//--------------------------------------------------
+
+/**
+ * @brief Draw a random pose, with each rotation and translation component uniform within the given bounds
+ * @param rotation The largest rotation about each axis (radians)
+ * @param translation The largest translation along each axis (millimetres)
+ * @return SE3 The pose
+ */
+SE3 SyntheticScene::GetRandomPose(double rotation, double translation)
+{
+	auto twist = Vec6d();
+	for (auto i = 0; i < 3; i++) twist[i] = GetUniform(-rotation, rotation);
+	for (auto i = 3; i < 6; i++) twist[i] = GetUniform(-translation, translation);
+	return SE3::Exp(twist);
+}
+
+/**
+ * @brief Draw a uniform random value
+ * @param low The lower bound
+ * @param high The upper bound
+ * @return double The value
+ */
+double SyntheticScene::GetUniform(double low, double high)
+{
+	return uniform_real_distribution<double>(low, high)(_random);
+}
@@ -0,0 +1,49 @@
+//--------------------------------------------------
+// A generator of randomized synthetic RGB-D frames with known poses, used to drive the differential tests.
+//
+// The scene is a tilted plane in front of the first camera, painted with a sum of random sinusoids (so it has 
+// gradients everywhere, but no aliasing at the frame resolution). Frames are ray cast at any pose, so the ground 
+// truth of both the pose and the depth is exact. A given seed always produces the same scene and poses
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#pragma once
+
+#include <random>
+#include <iostream>
+using namespace std;
+
+#include <opencv2/opencv.hpp>
+using namespace cv;
+
+#include <RealTrackLib/SE3.h>
+
+namespace NVL_App
+{
+	class SyntheticScene
+	{
+	private:
+		Mat _camera;
+		Size _size;
+		mt19937 _random;
+
+		double _distance;
+		double _slopeX;
+		double _slopeY;
+		vector<Vec4d> _waves;
+	public:
+		SyntheticScene(int seed, const Size& size);
+
+		void Render(const SE3& pose, Mat& color, Mat& depth, int depthType = CV_32FC1);
+		SE3 GetRandomPose(double rotation, double translation);
+		double GetUniform(double low, double high);
+
+		inline Mat& GetCamera() { return _camera; }
+		inline Size& GetSize() { return _size; }
+	private:
+		double GetTexture(double X, double Y);
+	};
+}
@@ -0,0 +1,111 @@
+//--------------------------------------------------
+// Differential tests for the block based FAST extraction: the block table and partial sort of the detector are 
+// checked against the ordered map and stable sort of the reference, on random synthetic frames
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <RealTrackLib/FastDetector.h>
+#include <RealTrackTests/Helpers/SyntheticScene.h>
+#include <RealTrackTests/Helpers/ReferenceKernels.h>
+using namespace NVL_App;
+
+// The number of random scenes that each test runs over
+#define SCENE_COUNT 5
+
+// The block size of the detector (as used by the tracker)
+#define BLOCK_SIZE 5
+
+//--------------------------------------------------
+// Helpers
+//--------------------------------------------------
+
+/**
+ * @brief Render the luma image of a random scene
+ * @param seed The seed of the scene
+ * @param output The luma image
+ */
+static void RenderLuma(int seed, Mat& output)
+{
+	auto scene = SyntheticScene(seed, Size(320, 240));
+	Mat color, depth; scene.Render(scene.GetRandomPose(0.05, 50), color, depth);
+	cvtColor(color, output, COLOR_BGR2GRAY);
+}
+
+/**
+ * @brief Retrieve the responses of a set of keypoints from the strongest down
+ * @param keypoints The keypoints
+ * @return vector<float> The sorted responses
+ */
+static vector<float> GetResponses(const vector<KeyPoint>& keypoints)
+{
+	auto result = vector<float>(); for (auto& keypoint : keypoints) result.push_back(keypoint.response);
+	sort(result.begin(), result.end(), greater<float>());
+	return result;
+}
+
+//--------------------------------------------------
+// Test Methods
+//--------------------------------------------------
+
+/**
+ * @brief Confirm that without a keypoint target the detector keeps the same keypoints as the reference, in block order
+ */
+TEST(FastDetector_Test, test_extract_blocks)
+{
+	for (auto seed = 0; seed < SCENE_COUNT; seed++)
+	{
+		Mat image; RenderLuma(seed, image);
+
+		auto expected = vector<KeyPoint>(); ReferenceKernels::Extract(image, BLOCK_SIZE, 0, expected);
+		auto actual = vector<KeyPoint>(); auto detector = FastDetector(BLOCK_SIZE); detector.Extract(image, actual);
+
+		ASSERT_GT(expected.size(), 0) << "seed " << seed;
+		ASSERT_EQ(expected.size(), actual.size()) << "seed " << seed;
+		for (auto i = 0; i < (int)expected.size(); i++)
+		{
+			ASSERT_EQ(expected[i].pt, actual[i].pt) << "seed " << seed << ", keypoint " << i;
+			ASSERT_EQ(expected[i].response, actual[i].response) << "seed " << seed << ", keypoint " << i;
+		}
+	}
+}
+
+/**
+ * @brief Confirm that with a keypoint target the detector keeps the strongest responses (the order within the kept 
+ * set, and which of a tie is kept at the cut, are left to the partial sort)
+ */
+TEST(FastDetector_Test, test_extract_target)
+{
+	for (auto seed = 0; seed < SCENE_COUNT; seed++)
+	{
+		Mat image; RenderLuma(seed, image);
+
+		for (auto target : { 50, 200 })
+		{
+			auto settings = QualitySettings(target, 21, 3, 10000, 1, 1, 1400);
+			auto expected = vector<KeyPoint>(); ReferenceKernels::Extract(image, BLOCK_SIZE, target, expected);
+			auto actual = vector<KeyPoint>(); auto detector = FastDetector(BLOCK_SIZE); detector.SetQuality(settings); detector.Extract(image, actual);
+
+			ASSERT_EQ(expected.size(), actual.size()) << "seed " << seed << ", target " << target;
+			ASSERT_EQ(GetResponses(expected), GetResponses(actual)) << "seed " << seed << ", target " << target;
+		}
+	}
+}
+
+/**
+ * @brief Confirm that the detector appends to the keypoints that are already in the list
+ */
+TEST(FastDetector_Test, test_extract_append)
+{
+	Mat image; RenderLuma(0, image);
+
+	auto expected = vector<KeyPoint>(); ReferenceKernels::Extract(image, BLOCK_SIZE, 0, expected);
+	auto actual = vector<KeyPoint>(1, KeyPoint(1, 1, 1)); auto detector = FastDetector(BLOCK_SIZE); detector.Extract(image, actual);
+
+	ASSERT_EQ(expected.size() + 1, actual.size());
+	ASSERT_EQ(Point2f(1, 1), actual[0].pt);
+}
@@ -0,0 +1,158 @@
+//--------------------------------------------------
+// Tests for the frame rectification: a distorted render is undistorted and checked against the pinhole render, and 
+// depth from a separate camera is registered to the color camera and checked against the depth that is ray cast from 
+// the color camera
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <RealTrackLib/FrameRectifier.h>
+#include <RealTrackTests/Helpers/SyntheticScene.h>
+using namespace NVL_App;
+
+// The number of random scenes that each test runs over
+#define SCENE_COUNT 5
+
+// The largest mean relative error of the registered depth, and the smallest fraction of the frame that it must cover
+#define REGISTER_TOLERANCE 1e-3
+#define REGISTER_COVERAGE 0.9
+
+// The radial distortion of the undistortion test, the largest mean intensity error of the undistorted image, and the
+// border that is left out of the comparison (where the distorted image has no content to undistort)
+#define DISTORTION_K1 -0.2
+#define DISTORTION_K2 0.05
+#define UNDISTORT_TOLERANCE 5.0
+#define UNDISTORT_MARGIN 16
+
+//--------------------------------------------------
+// Helpers
+//--------------------------------------------------
+
+/**
+ * @brief Apply a radial distortion to a pinhole image (each distorted pixel samples the pinhole image along its 
+ * undistorted ray, which is found by fixed point iteration)
+ * @param camera The camera matrix
+ * @param k1 The second order radial coefficient
+ * @param k2 The fourth order radial coefficient
+ * @param image The pinhole image
+ * @return Mat The distorted image
+ */
+static Mat Distort(Mat& camera, double k1, double k2, Mat& image)
+{
+	auto fx = camera.at<double>(0, 0); auto fy = camera.at<double>(1, 1); auto cx = camera.at<double>(0, 2); auto cy = camera.at<double>(1, 2);
+
+	auto result = Mat(image.size(), image.type(), Scalar::all(0));
+	for (auto row = 0; row < image.rows; row++)
+	{
+		for (auto column = 0; column < image.cols; column++)
+		{
+			auto xd = (column - cx) / fx; auto yd = (row - cy) / fy; auto x = xd; auto y = yd;
+			for (auto i = 0; i < 20; i++) { auto r2 = x * x + y * y; auto factor = 1 + k1 * r2 + k2 * r2 * r2; x = xd / factor; y = yd / factor; }
+
+			auto u = fx * x + cx; auto v = fy * y + cy;
+			if (u < 0 || v < 0 || u >= image.cols - 1 || v >= image.rows - 1) continue;
+
+			auto u0 = (int)u; auto v0 = (int)v; auto a = u - u0; auto b = v - v0;
+			for (auto channel = 0; channel < 3; channel++)
+			{
+				auto sample = [&](int x, int y) { return (double)image.at<Vec3b>(y, x)[channel]; };
+				auto value = (1 - a) * (1 - b) * sample(u0, v0) + a * (1 - b) * sample(u0 + 1, v0) + (1 - a) * b * sample(u0, v0 + 1) + a * b * sample(u0 + 1, v0 + 1);
+				result.at<Vec3b>(row, column)[channel] = saturate_cast<uchar>(value);
+			}
+		}
+	}
+
+	return result;
+}
+
+//--------------------------------------------------
+// Test Methods
+//--------------------------------------------------
+
+/**
+ * @brief Confirm that a render distorted with known coefficients is undistorted back to the pinhole render
+ */
+TEST(FrameRectifier_Test, test_undistort)
+{
+	for (auto seed = 0; seed < SCENE_COUNT; seed++)
+	{
+		auto scene = SyntheticScene(seed, Size(320, 240));
+		Mat expected, depth; scene.Render(SE3(), expected, depth);
+
+		auto K = scene.GetCamera(); auto calibration = Calibration(Vec2d(K.at<double>(0, 0), K.at<double>(1, 1)), Point2d(K.at<double>(0, 2), K.at<double>(1, 2)));
+		calibration.GetDistortion() = Mat(1, 5, CV_64FC1, Scalar::all(0));
+		calibration.GetDistortion().at<double>(0, 0) = DISTORTION_K1; calibration.GetDistortion().at<double>(0, 1) = DISTORTION_K2;
+		ASSERT_TRUE(FrameRectifier::IsNeeded(&calibration));
+
+		auto color = Distort(K, DISTORTION_K1, DISTORTION_K2, expected);
+		auto rectifier = FrameRectifier(&calibration, color.size());
+		auto frame = NVLib::DepthFrame(color, depth); rectifier.Apply(&frame);
+		auto& actual = frame.GetColor();
+
+		ASSERT_EQ(expected.size(), actual.size());
+		auto error = 0.0; auto count = 0;
+		for (auto row = UNDISTORT_MARGIN; row < actual.rows - UNDISTORT_MARGIN; row++)
+		{
+			for (auto column = UNDISTORT_MARGIN; column < actual.cols - UNDISTORT_MARGIN; column++)
+			{
+				for (auto channel = 0; channel < 3; channel++) error += abs(actual.at<Vec3b>(row, column)[channel] - expected.at<Vec3b>(row, column)[channel]);
+				count += 3;
+			}
+		}
+
+		ASSERT_LT(error / count, UNDISTORT_TOLERANCE) << "seed " << seed;
+	}
+}
+
+/**
+ * @brief Confirm that depth from a camera that is offset from the color camera is registered onto the color pixels
+ */
+TEST(FrameRectifier_Test, test_register_depth)
+{
+	for (auto seed = 0; seed < SCENE_COUNT; seed++)
+	{
+		for (auto depthType : { CV_32FC1, CV_16UC1 })
+		{
+			auto scene = SyntheticScene(seed, Size(320, 240)); auto depthPose = scene.GetRandomPose(0.01, 25);
+			Mat color, expected; scene.Render(SE3(), color, expected, depthType);
+			Mat depthColor, depth; scene.Render(depthPose, depthColor, depth, depthType);
+
+			auto K = scene.GetCamera(); auto calibration = Calibration(Vec2d(K.at<double>(0, 0), K.at<double>(1, 1)), Point2d(K.at<double>(0, 2), K.at<double>(1, 2)));
+			calibration.GetDepthCamera() = K.clone(); calibration.GetDepthPose() = depthPose.Inverse().ToMat();
+			ASSERT_TRUE(FrameRectifier::IsNeeded(&calibration));
+
+			auto rectifier = FrameRectifier(&calibration, color.size());
+			auto frame = NVLib::DepthFrame(color, depth); rectifier.Apply(&frame);
+			auto& actual = frame.GetDepth();
+
+			ASSERT_EQ(expected.type(), actual.type());
+			auto error = 0.0; auto count = 0;
+			for (auto i = 0; i < (int)actual.total(); i++)
+			{
+				auto Z = depthType == CV_16UC1 ? (double)((ushort *)actual.data)[i] : (double)((float *)actual.data)[i];
+				auto truth = depthType == CV_16UC1 ? (double)((ushort *)expected.data)[i] : (double)((float *)expected.data)[i];
+				if (Z <= 0 || truth <= 0) continue;
+				error += abs(Z - truth) / truth; count++;
+			}
+
+			ASSERT_GT(count, REGISTER_COVERAGE * actual.total()) << "seed " << seed;
+			ASSERT_LT(error / count, REGISTER_TOLERANCE) << "seed " << seed;
+		}
+	}
+}
+
+/**
+ * @brief Confirm that a calibration without a distortion model or a depth camera leaves the frames alone
+ */
+TEST(FrameRectifier_Test, test_not_needed)
+{
+	auto calibration = Calibration(Vec2d(500, 500), Point2d(160, 120));
+	ASSERT_FALSE(FrameRectifier::IsNeeded(&calibration));
+
+	calibration.GetDistortion() = Mat_<double>::zeros(1, 5);
+	ASSERT_FALSE(FrameRectifier::IsNeeded(&calibration));
+}
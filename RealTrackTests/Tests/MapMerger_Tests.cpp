@@ -0,0 +1,113 @@
+//--------------------------------------------------
+// Differential tests for the depth map merge: both native formats are checked against the double precision 
+// reference, over random maps with invalid regions and random merge counters
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include <RealTrackLib/MapMerger.h>
+#include <RealTrackTests/Helpers/ReferenceKernels.h>
+using namespace NVL_App;
+
+// The number of random map pairs that each test runs over
+#define MAP_COUNT 10
+
+// The largest difference between a merged depth and the reference (in mm)
+#define FLOAT_TOLERANCE 1e-3
+#define MM16_TOLERANCE 1
+
+//--------------------------------------------------
+// Helpers
+//--------------------------------------------------
+
+/**
+ * @brief Fill a depth map with random depths, about a quarter of which are invalid (zero or below the merge cut off)
+ * @param random The random generator
+ * @param depthType The format of the map
+ * @param size The size of the map
+ * @param output The map
+ */
+static void FillMap(mt19937& random, int depthType, const Size& size, Mat& output)
+{
+	auto depth = uniform_real_distribution<double>(300, 2500); auto invalid = uniform_int_distribution<int>(0, 7);
+	output = Mat(size, depthType);
+
+	for (auto i = 0; i < (int)output.total(); i++)
+	{
+		auto flag = invalid(random); auto Z = flag == 0 ? 0.0 : flag == 1 ? 150.0 : depth(random);
+		if (depthType == CV_16UC1) ((ushort *)output.data)[i] = (ushort)round(Z);
+		else ((float *)output.data)[i] = (float)Z;
+	}
+}
+
+/**
+ * @brief Merge a random map pair with both the optimized and the reference kernels, and compare the results
+ * @param depthType The format of the maps
+ * @param tolerance The largest allowed difference between the merged depths
+ */
+static void CheckMerge(int depthType, double tolerance)
+{
+	for (auto seed = 0; seed < MAP_COUNT; seed++)
+	{
+		auto random = mt19937(seed); auto size = Size(160, 120);
+		Mat map1, map2; FillMap(random, depthType, size, map1); FillMap(random, depthType, size, map2);
+
+		auto counters = Mat(size, CV_8UC1); auto count = uniform_int_distribution<int>(1, 20);
+		for (auto i = 0; i < (int)counters.total(); i++) counters.data[i] = (uchar)count(random);
+		auto expectedCounters = counters.clone();
+
+		Mat expected; ReferenceKernels::Merge(map1, map2, expectedCounters, expected);
+		Mat actual; MapMerger::Merge(map1, map2, counters, actual);
+
+		ASSERT_EQ(expected.type(), actual.type());
+		for (auto i = 0; i < (int)actual.total(); i++)
+		{
+			auto Z1 = depthType == CV_16UC1 ? (double)((ushort *)expected.data)[i] : (double)((float *)expected.data)[i];
+			auto Z2 = depthType == CV_16UC1 ? (double)((ushort *)actual.data)[i] : (double)((float *)actual.data)[i];
+			ASSERT_NEAR(Z1, Z2, tolerance) << "seed " << seed << ", pixel " << i;
+			ASSERT_EQ(expectedCounters.data[i], counters.data[i]) << "seed " << seed << ", pixel " << i;
+		}
+	}
+}
+
+//--------------------------------------------------
+// Test Methods
+//--------------------------------------------------
+
+/**
+ * @brief Confirm that merging float maps matches the reference
+ */
+TEST(MapMerger_Test, test_merge_float)
+{
+	CheckMerge(CV_32FC1, FLOAT_TOLERANCE);
+}
+
+/**
+ * @brief Confirm that merging 16-bit millimetre maps matches the reference (up to the rounding of the average)
+ */
+TEST(MapMerger_Test, test_merge_mm16)
+{
+	CheckMerge(CV_16UC1, MM16_TOLERANCE);
+}
+
+/**
+ * @brief Confirm that the merge can write over its second input (which the per-pixel merge allows)
+ */
+TEST(MapMerger_Test, test_merge_in_place)
+{
+	auto random = mt19937(7); auto size = Size(160, 120);
+	Mat map1, map2; FillMap(random, CV_32FC1, size, map1); FillMap(random, CV_32FC1, size, map2);
+	auto counters = Mat(size, CV_8UC1); for (auto i = 0; i < (int)counters.total(); i++) counters.data[i] = (uchar)(1 + i % 20);
+	auto expectedCounters = counters.clone();
+
+	Mat expected; ReferenceKernels::Merge(map1, map2, expectedCounters, expected);
+	MapMerger::Merge(map1, map2, counters, map2);
+
+	for (auto i = 0; i < (int)map2.total(); i++) ASSERT_NEAR(((float *)expected.data)[i], ((float *)map2.data)[i], FLOAT_TOLERANCE) << "pixel " << i;
+}
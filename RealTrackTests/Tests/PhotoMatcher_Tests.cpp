@@ -0,0 +1,135 @@
+//--------------------------------------------------
+// Differential tests for the pose refiners: the inverse compositional alignment and the Levenberg-Marquardt 
+// refinement are checked against the ray cast ground truth, and the batched candidate selection against the
+// reference score
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <RealTrackLib/PhotoMatcher.h>
+#include <RealTrackTests/Helpers/SyntheticScene.h>
+#include <RealTrackTests/Helpers/ReferenceKernels.h>
+using namespace NVL_App;
+
+// The number of random scenes that each test runs over
+#define SCENE_COUNT 5
+
+// The largest rotation (radians) and translation (mm) error of an alignment from a nearby start
+#define ALIGN_ROTATION 2e-3
+#define ALIGN_TRANSLATION 2.0
+
+// The largest rotation (radians) and translation (mm) error of a refinement. The descent only sees the score (through
+// a forward difference Jacobian), so it is started closer than the alignment and held to staying within the basin
+#define REFINE_START_ROTATION 2e-3
+#define REFINE_START_TRANSLATION 2.0
+#define REFINE_ROTATION 5e-3
+#define REFINE_TRANSLATION 5.0
+
+// The number of candidates that the selection picks from
+#define CANDIDATE_COUNT 12
+
+// The weight of the depth residual within the joint scores
+#define DEPTH_WEIGHT 2.0
+
+//--------------------------------------------------
+// Helpers
+//--------------------------------------------------
+
+/**
+ * @brief Find the rotation and translation errors of an estimated pose
+ * @param truth The ground truth pose
+ * @param estimate The estimated pose
+ * @param rotation The rotation error (radians)
+ * @param translation The translation error (mm)
+ */
+static void GetErrors(const SE3& truth, const SE3& estimate, double& rotation, double& translation)
+{
+	auto delta = (truth.Inverse() * estimate).Log();
+	rotation = sqrt(delta[0] * delta[0] + delta[1] * delta[1] + delta[2] * delta[2]);
+	translation = sqrt(delta[3] * delta[3] + delta[4] * delta[4] + delta[5] * delta[5]);
+}
+
+//--------------------------------------------------
+// Test Methods
+//--------------------------------------------------
+
+/**
+ * @brief Confirm that the inverse compositional alignment recovers the true pose from a nearby start
+ */
+TEST(PhotoMatcher_Test, test_align)
+{
+	for (auto seed = 0; seed < SCENE_COUNT; seed++)
+	{
+		auto scene = SyntheticScene(seed, Size(320, 240)); auto truth = scene.GetRandomPose(0.02, 30);
+		Mat color[2], depth[2]; scene.Render(SE3(), color[0], depth[0]); scene.Render(truth, color[1], depth[1]);
+
+		auto frame = NVLib::DepthFrame(color[0], depth[0]); auto image = PoseImage(scene.GetCamera(), &frame);
+		auto settings = QualitySettings(0, 21, 3, 10000, 1, 1, 50);
+		auto matcher = PhotoMatcher(&image); matcher.SetQuality(settings);
+
+		auto start = truth * scene.GetRandomPose(0.01, 8);
+		auto result = matcher.Align(start, color[1]);
+
+		auto rotation = 0.0, translation = 0.0; GetErrors(truth, result, rotation, translation);
+		ASSERT_LT(rotation, ALIGN_ROTATION) << "seed " << seed;
+		ASSERT_LT(translation, ALIGN_TRANSLATION) << "seed " << seed;
+	}
+}
+
+/**
+ * @brief Confirm that the Levenberg-Marquardt refinement stays close to the true pose from a nearby start
+ */
+TEST(PhotoMatcher_Test, test_refine)
+{
+	for (auto seed = 0; seed < SCENE_COUNT; seed++)
+	{
+		auto scene = SyntheticScene(seed, Size(320, 240)); auto truth = scene.GetRandomPose(0.02, 30);
+		Mat color[2], depth[2]; scene.Render(SE3(), color[0], depth[0]); scene.Render(truth, color[1], depth[1]);
+
+		auto frame = NVLib::DepthFrame(color[0], depth[0]); auto image = PoseImage(scene.GetCamera(), &frame);
+		auto settings = QualitySettings(0, 21, 3, 10000, 1, 1, 300);
+		auto matcher = PhotoMatcher(&image); matcher.SetQuality(settings); matcher.SetDepthWeight(DEPTH_WEIGHT);
+
+		auto start = truth * scene.GetRandomPose(REFINE_START_ROTATION, REFINE_START_TRANSLATION);
+		auto result = matcher.Refine(start, color[1], depth[1]);
+
+		auto rotation = 0.0, translation = 0.0; GetErrors(truth, result, rotation, translation);
+		ASSERT_LT(rotation, REFINE_ROTATION) << "seed " << seed;
+		ASSERT_LT(translation, REFINE_TRANSLATION) << "seed " << seed;
+	}
+}
+
+/**
+ * @brief Confirm that the batched selection picks the same candidate as the reference score (the true pose, hidden 
+ * at a random position among perturbed candidates)
+ */
+TEST(PhotoMatcher_Test, test_select)
+{
+	for (auto seed = 0; seed < SCENE_COUNT; seed++)
+	{
+		auto scene = SyntheticScene(seed, Size(320, 240)); auto truth = scene.GetRandomPose(0.02, 30);
+		Mat color[2], depth[2], luma[2]; scene.Render(SE3(), color[0], depth[0]); scene.Render(truth, color[1], depth[1]);
+		for (auto i = 0; i < 2; i++) cvtColor(color[i], luma[i], COLOR_BGR2GRAY);
+
+		auto frame = NVLib::DepthFrame(color[0], depth[0]); auto image = PoseImage(scene.GetCamera(), &frame);
+		auto matcher = PhotoMatcher(&image); matcher.SetDepthWeight(DEPTH_WEIGHT);
+
+		auto position = (int)scene.GetUniform(0, CANDIDATE_COUNT);
+		auto candidates = vector<SE3>();
+		for (auto i = 0; i < CANDIDATE_COUNT; i++) candidates.push_back(i == position ? truth : truth * scene.GetRandomPose(0.02, 20));
+
+		auto expected = 0; auto best = DBL_MAX;
+		for (auto i = 0; i < CANDIDATE_COUNT; i++)
+		{
+			auto score = ReferenceKernels::GetLumaScore(scene.GetCamera(), luma[0], depth[0], candidates[i], luma[1], depth[1], DEPTH_WEIGHT, 1);
+			if (score < best) { best = score; expected = i; }
+		}
+
+		ASSERT_EQ(position, expected) << "seed " << seed;
+		ASSERT_EQ(expected, matcher.Select(candidates, color[1], depth[1])) << "seed " << seed;
+	}
+}
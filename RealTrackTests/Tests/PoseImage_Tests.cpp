@@ -0,0 +1,210 @@
+//--------------------------------------------------
+// Differential tests for the PoseImage kernels: the fixed point, batched and sub-sampled scores are checked against
+// the double precision reference, and the depth splat against the ray cast ground truth
+//
+// @author: Wild Boar
+//
+// @date: 2026-10-19
+//--------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <RealTrackLib/PoseImage.h>
+#include <RealTrackTests/Helpers/SyntheticScene.h>
+#include <RealTrackTests/Helpers/ReferenceKernels.h>
+using namespace NVL_App;
+
+// The number of random scenes that each test runs over
+#define SCENE_COUNT 5
+
+// The largest difference between the fixed point score and the reference (in luma levels per pixel)
+#define LUMA_TOLERANCE 0.05
+
+// The largest difference between a batched score and the matching single score
+#define BATCH_TOLERANCE 1e-3
+
+// The largest relative difference between a sub-sampled score and the full reference score
+#define STRIDE_TOLERANCE 0.01
+
+// The largest mean relative error of the warped depth, and the smallest fraction of the frame that it must cover
+#define WARP_TOLERANCE 1e-4
+#define WARP_COVERAGE 0.9
+
+// The weight of the depth residual within the joint scores
+#define DEPTH_WEIGHT 2.0
+
+//--------------------------------------------------
+// Helpers
+//--------------------------------------------------
+
+/**
+ * @brief A pair of frames of a random scene, along with the pose between them
+ */
+struct FramePair
+{
+	Mat Color[2];
+	Mat Depth[2];
+	Mat Luma[2];
+	SE3 Pose;
+};
+
+/**
+ * @brief Render a reference frame and a match frame at a random pose
+ * @param scene The scene that we are rendering
+ * @param depthType The depth format of the frames
+ * @param pair The frames and the pose between them
+ */
+static void RenderPair(SyntheticScene& scene, int depthType, FramePair& pair)
+{
+	pair.Pose = scene.GetRandomPose(0.02, 30);
+	scene.Render(SE3(), pair.Color[0], pair.Depth[0], depthType);
+	scene.Render(pair.Pose, pair.Color[1], pair.Depth[1], depthType);
+	for (auto i = 0; i < 2; i++) cvtColor(pair.Color[i], pair.Luma[i], COLOR_BGR2GRAY);
+}
+
+//--------------------------------------------------
+// Test Methods
+//--------------------------------------------------
+
+/**
+ * @brief Confirm that the fixed point luma score matches the double precision reference (for both depth formats)
+ */
+TEST(PoseImage_Test, test_luma_score)
+{
+	for (auto seed = 0; seed < SCENE_COUNT; seed++)
+	{
+		for (auto depthType : { CV_32FC1, CV_16UC1 })
+		{
+			auto scene = SyntheticScene(seed, Size(320, 240)); auto pair = FramePair(); RenderPair(scene, depthType, pair);
+			auto frame = NVLib::DepthFrame(pair.Color[0], pair.Depth[0]); auto image = PoseImage(scene.GetCamera(), &frame);
+
+			for (auto i = 0; i < 4; i++)
+			{
+				auto pose = pair.Pose * scene.GetRandomPose(0.005 * i, 5.0 * i);
+				auto expected = ReferenceKernels::GetLumaScore(scene.GetCamera(), pair.Luma[0], pair.Depth[0], pose, pair.Luma[1], pair.Depth[1], DEPTH_WEIGHT, 1);
+				auto actual = image.GetLumaScore(pose, pair.Luma[1], pair.Depth[1], DEPTH_WEIGHT);
+				ASSERT_NEAR(expected, actual, LUMA_TOLERANCE) << "seed " << seed << ", hypothesis " << i;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Confirm that the batched scores match the single pose scores (including poses that project off the image)
+ */
+TEST(PoseImage_Test, test_batch_scores)
+{
+	for (auto seed = 0; seed < SCENE_COUNT; seed++)
+	{
+		auto scene = SyntheticScene(seed, Size(320, 240)); auto pair = FramePair(); RenderPair(scene, CV_32FC1, pair);
+		auto frame = NVLib::DepthFrame(pair.Color[0], pair.Depth[0]); auto image = PoseImage(scene.GetCamera(), &frame);
+
+		auto poses = vector<SE3>();
+		for (auto i = 0; i < 40; i++) poses.push_back(pair.Pose * scene.GetRandomPose(0.002 * i, 4.0 * i));
+
+		for (auto stride : { 1, 3 })
+		{
+			auto scores = vector<double>(); image.GetScores(poses, pair.Luma[1], pair.Depth[1], DEPTH_WEIGHT, stride, scores);
+			ASSERT_EQ(poses.size(), scores.size());
+
+			for (auto i = 0; i < (int)poses.size(); i++)
+			{
+				auto expected = image.GetLumaScore(poses[i], pair.Luma[1], pair.Depth[1], DEPTH_WEIGHT, stride);
+				ASSERT_NEAR(expected, scores[i], BATCH_TOLERANCE) << "seed " << seed << ", stride " << stride << ", pose " << i;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Confirm that sub-sampling the reference pixels leaves the score close to the full reference score
+ */
+TEST(PoseImage_Test, test_subsampled_score)
+{
+	for (auto seed = 0; seed < SCENE_COUNT; seed++)
+	{
+		auto scene = SyntheticScene(seed, Size(320, 240)); auto pair = FramePair(); RenderPair(scene, CV_32FC1, pair);
+		auto frame = NVLib::DepthFrame(pair.Color[0], pair.Depth[0]); auto image = PoseImage(scene.GetCamera(), &frame);
+
+		auto pose = pair.Pose * scene.GetRandomPose(0.01, 10);
+		auto expected = ReferenceKernels::GetLumaScore(scene.GetCamera(), pair.Luma[0], pair.Depth[0], pose, pair.Luma[1], pair.Depth[1], DEPTH_WEIGHT, 1);
+		auto actual = image.GetLumaScore(pose, pair.Luma[1], pair.Depth[1], DEPTH_WEIGHT, 2);
+		ASSERT_NEAR(1.0, actual / expected, STRIDE_TOLERANCE) << "seed " << seed;
+	}
+}
+
+/**
+ * @brief Confirm that the splatted depth matches the depth that is ray cast at the target pose
+ */
+TEST(PoseImage_Test, test_warped_depth)
+{
+	for (auto seed = 0; seed < SCENE_COUNT; seed++)
+	{
+		auto scene = SyntheticScene(seed, Size(320, 240)); auto pair = FramePair(); RenderPair(scene, CV_32FC1, pair);
+		auto frame = NVLib::DepthFrame(pair.Color[0], pair.Depth[0]); auto image = PoseImage(scene.GetCamera(), &frame);
+
+		Mat warped; image.GetDepth(pair.Pose, warped);
+
+		auto error = 0.0; auto count = 0;
+		for (auto i = 0; i < (int)warped.total(); i++)
+		{
+			auto actual = ((float *)warped.data)[i]; if (actual <= 0) continue;
+			auto expected = ((float *)pair.Depth[1].data)[i];
+			error += abs(actual - expected) / expected; count++;
+		}
+
+		ASSERT_GT(count, WARP_COVERAGE * warped.total()) << "seed " << seed;
+		ASSERT_LT(error / count, WARP_TOLERANCE) << "seed " << seed;
+	}
+}
+
+/**
+ * @brief Confirm that the single splat warp gives the same depth and counter as the separate warps
+ */
+TEST(PoseImage_Test, test_joint_warp)
+{
+	for (auto seed = 0; seed < SCENE_COUNT; seed++)
+	{
+		auto scene = SyntheticScene(seed, Size(320, 240)); auto pair = FramePair(); RenderPair(scene, CV_32FC1, pair);
+		auto frame = NVLib::DepthFrame(pair.Color[0], pair.Depth[0]); auto image = PoseImage(scene.GetCamera(), &frame);
+
+		auto counter = Mat(scene.GetSize(), CV_8UC1);
+		for (auto i = 0; i < (int)counter.total(); i++) counter.data[i] = (uchar)(1 + (i * 7 + seed) % 20);
+
+		Mat expectedDepth; image.GetDepth(pair.Pose, expectedDepth);
+		Mat expectedCounter; image.WarpCounter(pair.Pose, counter, expectedCounter);
+		Mat depth, warpedCounter; image.Warp(pair.Pose, counter, depth, warpedCounter);
+
+		for (auto i = 0; i < (int)depth.total(); i++)
+		{
+			ASSERT_EQ(((float *)expectedDepth.data)[i], ((float *)depth.data)[i]) << "seed " << seed << ", pixel " << i;
+			ASSERT_EQ(expectedCounter.data[i], warpedCounter.data[i]) << "seed " << seed << ", pixel " << i;
+		}
+	}
+}
+
+/**
+ * @brief Confirm that the gray frame kernels agree with the color frame kernels (on a color frame that has the gray 
+ * value in every channel, the color distance is the gray difference scaled by the root of three)
+ */
+TEST(PoseImage_Test, test_gray_frames)
+{
+	for (auto seed = 0; seed < SCENE_COUNT; seed++)
+	{
+		auto scene = SyntheticScene(seed, Size(320, 240)); auto pair = FramePair(); RenderPair(scene, CV_16UC1, pair);
+
+		Mat gray[2]; for (auto i = 0; i < 2; i++) merge(vector<Mat> { pair.Luma[i], pair.Luma[i], pair.Luma[i] }, gray[i]);
+		auto colorFrame = NVLib::DepthFrame(gray[0], pair.Depth[0]); auto colorImage = PoseImage(scene.GetCamera(), &colorFrame);
+		auto grayFrame = NVLib::DepthFrame(pair.Luma[0], pair.Depth[0]); auto grayImage = PoseImage(scene.GetCamera(), &grayFrame);
+
+		auto colorErrors = vector<double>(); colorImage.GetScore(pair.Pose, gray[1], colorErrors);
+		auto grayErrors = vector<double>(); grayImage.GetScore(pair.Pose, pair.Luma[1], grayErrors);
+
+		ASSERT_GT(grayErrors.size(), 0) << "seed " << seed;
+		ASSERT_EQ(colorErrors.size(), grayErrors.size()) << "seed " << seed;
+		for (auto i = 0; i < (int)grayErrors.size(); i++) ASSERT_NEAR(colorErrors[i], sqrt(3.0) * grayErrors[i], BATCH_TOLERANCE) << "seed " << seed << ", pixel " << i;
+
+		auto expected = colorImage.GetLumaScore(pair.Pose, pair.Luma[1], pair.Depth[1], DEPTH_WEIGHT);
+		ASSERT_EQ(expected, grayImage.GetLumaScore(pair.Pose, pair.Luma[1], pair.Depth[1], DEPTH_WEIGHT)) << "seed " << seed;
+	}
+}